@@ -360,7 +360,7 @@
     }
     
     if (imageData) {
-        [(AWKGalleryAnimatedImageContentView *)self.contentView setAnimatedImage:[AWKAnimatedImage animatedImageWithGIFData:imageData]];
+        [(AWKGalleryAnimatedImageContentView *)self.contentView setAnimatedImage:[AWKAnimatedImage animatedImageWithGIFData:imageData scanningFramesLazily:YES]];
     }
 }
 
@@ -53,8 +53,12 @@ extern const NSTimeInterval kAWKAnimatedImageDelayTimeIntervalMinimum;
 // On success, the initializers return an `AWKAnimatedImage` with all fields initialized, on failure they return `nil` and an error will be logged.
 - (instancetype)initWithAnimatedGIFData:(NSData *)data;
 // Pass 0 for optimalFrameCacheSize to get the default, predrawing is enabled by default.
-- (instancetype)initWithAnimatedGIFData:(NSData *)data optimalFrameCacheSize:(NSUInteger)optimalFrameCacheSize predrawingEnabled:(BOOL)isPredrawingEnabled NS_DESIGNATED_INITIALIZER;
+- (instancetype)initWithAnimatedGIFData:(NSData *)data optimalFrameCacheSize:(NSUInteger)optimalFrameCacheSize predrawingEnabled:(BOOL)isPredrawingEnabled;
+// When scanning frames lazily, only the frame properties are read and just the poster image is decoded up front; the other frames are decoded on demand by the frame cache.
+// Frames are not validated up front in that case, a frame that turns out to be corrupt shows the poster image instead.
+- (instancetype)initWithAnimatedGIFData:(NSData *)data optimalFrameCacheSize:(NSUInteger)optimalFrameCacheSize predrawingEnabled:(BOOL)isPredrawingEnabled scanningFramesLazily:(BOOL)isScanningFramesLazily NS_DESIGNATED_INITIALIZER;
 + (instancetype)animatedImageWithGIFData:(NSData *)data;
++ (instancetype)animatedImageWithGIFData:(NSData *)data scanningFramesLazily:(BOOL)isScanningFramesLazily;
 
 @property (nonatomic, strong, readonly) NSData *data; // The data the receiver was initialized with; read-only
 
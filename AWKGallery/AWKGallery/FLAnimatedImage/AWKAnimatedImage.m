@@ -54,6 +54,7 @@ typedef NS_ENUM(NSUInteger, AWKAnimatedImageFrameCacheSize) {
 
 @property (nonatomic, assign, readonly) NSUInteger frameCacheSizeOptimal; // The optimal number of frames to cache based on image size & number of frames; never changes
 @property (nonatomic, assign, readonly, getter=isPredrawingEnabled) BOOL predrawingEnabled; // Enables predrawing of images to improve performance.
+@property (nonatomic, assign, readonly, getter=isScanningFramesLazily) BOOL scanningFramesLazily; // Only the poster image was decoded while initializing; never changes
 @property (nonatomic, assign) NSUInteger frameCacheSizeMaxInternal; // Allow to cap the cache size e.g. when memory warnings occur; 0 means no specific limit (default)
 @property (nonatomic, assign) NSUInteger requestedFrameIndex; // Most recently requested frame index
 @property (nonatomic, assign, readonly) NSUInteger posterImageFrameIndex; // Index of non-purgable poster image; never changes
@@ -179,6 +180,11 @@ static NSHashTable *allAnimatedImagesWeak;
 }
 
 - (instancetype)initWithAnimatedGIFData:(NSData *)data optimalFrameCacheSize:(NSUInteger)optimalFrameCacheSize predrawingEnabled:(BOOL)isPredrawingEnabled
+{
+    return [self initWithAnimatedGIFData:data optimalFrameCacheSize:optimalFrameCacheSize predrawingEnabled:isPredrawingEnabled scanningFramesLazily:NO];
+}
+
+- (instancetype)initWithAnimatedGIFData:(NSData *)data optimalFrameCacheSize:(NSUInteger)optimalFrameCacheSize predrawingEnabled:(BOOL)isPredrawingEnabled scanningFramesLazily:(BOOL)isScanningFramesLazily
 {
     // Early return if no data supplied!
     BOOL hasData = ([data length] > 0);
@@ -195,6 +201,7 @@ static NSHashTable *allAnimatedImagesWeak;
         // However, we will use the `_imageSource` as handler to the image data throughout our life cycle.
         _data = data;
         _predrawingEnabled = isPredrawingEnabled;
+        _scanningFramesLazily = isScanningFramesLazily;
         
         // Initialize internal data structures
         _cachedFramesForIndexes = [[NSMutableDictionary alloc] init];
@@ -237,6 +244,12 @@ static NSHashTable *allAnimatedImagesWeak;
         NSMutableDictionary *delayTimesForIndexesMutable = [NSMutableDictionary dictionaryWithCapacity:imageCount];
         for (size_t i = 0; i < imageCount; i++) {
             @autoreleasepool {
+                // Once there is a poster image, lazily scanned frames only need their delay time; they get decoded when the frame cache requests them.
+                if (self.isScanningFramesLazily && self.posterImage) {
+                    delayTimesForIndexesMutable[@(i)] = [self delayTimeAtIndex:i delayTimesForIndexes:delayTimesForIndexesMutable];
+                    continue;
+                }
+                
                 CGImageRef frameImageRef = CGImageSourceCreateImageAtIndex(_imageSource, i, NULL);
                 if (frameImageRef) {
                     UIImage *frameImage = [UIImage imageWithCGImage:frameImageRef];
@@ -253,46 +266,7 @@ static NSHashTable *allAnimatedImagesWeak;
                             [self.cachedFrameIndexes addIndex:self.posterImageFrameIndex];
                         }
                         
-                        // Get `DelayTime`
-                        // Note: It's not in (1/100) of a second like still falsely described in the documentation as per iOS 8 (rdar://19507384) but in seconds stored as `kCFNumberFloat32Type`.
-                        // Frame properties example:
-                        // {
-                        //     ColorModel = RGB;
-                        //     Depth = 8;
-                        //     PixelHeight = 960;
-                        //     PixelWidth = 640;
-                        //     "{GIF}" = {
-                        //         DelayTime = "0.4";
-                        //         UnclampedDelayTime = "0.4";
-                        //     };
-                        // }
-                        
-                        NSDictionary *frameProperties = (__bridge_transfer NSDictionary *)CGImageSourceCopyPropertiesAtIndex(_imageSource, i, NULL);
-                        NSDictionary *framePropertiesGIF = [frameProperties objectForKey:(id)kCGImagePropertyGIFDictionary];
-                        
-                        // Try to use the unclamped delay time; fall back to the normal delay time.
-                        NSNumber *delayTime = [framePropertiesGIF objectForKey:(id)kCGImagePropertyGIFUnclampedDelayTime];
-                        if (!delayTime) {
-                            delayTime = [framePropertiesGIF objectForKey:(id)kCGImagePropertyGIFDelayTime];
-                        }
-                        // If we don't get a delay time from the properties, fall back to `kDelayTimeIntervalDefault` or carry over the preceding frame's value.
-                        const NSTimeInterval kDelayTimeIntervalDefault = 0.1;
-                        if (!delayTime) {
-                            if (i == 0) {
-                                FLLog(FLLogLevelInfo, @"Falling back to default delay time for first frame %@ because none found in GIF properties %@", frameImage, frameProperties);
-                                delayTime = @(kDelayTimeIntervalDefault);
-                            } else {
-                                FLLog(FLLogLevelInfo, @"Falling back to preceding delay time for frame %zu %@ because none found in GIF properties %@", i, frameImage, frameProperties);
-                                delayTime = delayTimesForIndexesMutable[@(i - 1)];
-                            }
-                        }
-                        // Support frame delays as low as `kAWKAnimatedImageDelayTimeIntervalMinimum`, with anything below being rounded up to `kDelayTimeIntervalDefault` for legacy compatibility.
-                        // To support the minimum even when rounding errors occur, use an epsilon when comparing. We downcast to float because that's what we get for delayTime from ImageIO.
-                        if ([delayTime floatValue] < ((float)kAWKAnimatedImageDelayTimeIntervalMinimum - FLT_EPSILON)) {
-                            FLLog(FLLogLevelInfo, @"Rounding frame %zu's `delayTime` from %f up to default %f (minimum supported: %f).", i, [delayTime floatValue], kDelayTimeIntervalDefault, kAWKAnimatedImageDelayTimeIntervalMinimum);
-                            delayTime = @(kDelayTimeIntervalDefault);
-                        }
-                        delayTimesForIndexesMutable[@(i)] = delayTime;
+                        delayTimesForIndexesMutable[@(i)] = [self delayTimeAtIndex:i delayTimesForIndexes:delayTimesForIndexesMutable];
                     } else {
                         skippedFrameCount++;
                         FLLog(FLLogLevelInfo, @"Dropping frame %zu because valid `CGImageRef` %@ did result in `nil`-`UIImage`.", i, frameImageRef);
@@ -361,6 +335,13 @@ static NSHashTable *allAnimatedImagesWeak;
 }
 
 
++ (instancetype)animatedImageWithGIFData:(NSData *)data scanningFramesLazily:(BOOL)isScanningFramesLazily
+{
+    AWKAnimatedImage *animatedImage = [[AWKAnimatedImage alloc] initWithAnimatedGIFData:data optimalFrameCacheSize:0 predrawingEnabled:YES scanningFramesLazily:isScanningFramesLazily];
+    return animatedImage;
+}
+
+
 - (void)dealloc
 {
     if (_weakProxy) {
@@ -509,6 +490,54 @@ static NSHashTable *allAnimatedImagesWeak;
 
 
 #pragma mark - Private Methods
+#pragma mark Frame Properties
+
+// Only reads the frame properties, the frame itself is not decoded.
+- (NSNumber *)delayTimeAtIndex:(size_t)index delayTimesForIndexes:(NSDictionary *)delayTimesForIndexes
+{
+    // Get `DelayTime`
+    // Note: It's not in (1/100) of a second like still falsely described in the documentation as per iOS 8 (rdar://19507384) but in seconds stored as `kCFNumberFloat32Type`.
+    // Frame properties example:
+    // {
+    //     ColorModel = RGB;
+    //     Depth = 8;
+    //     PixelHeight = 960;
+    //     PixelWidth = 640;
+    //     "{GIF}" = {
+    //         DelayTime = "0.4";
+    //         UnclampedDelayTime = "0.4";
+    //     };
+    // }
+    
+    NSDictionary *frameProperties = (__bridge_transfer NSDictionary *)CGImageSourceCopyPropertiesAtIndex(_imageSource, index, NULL);
+    NSDictionary *framePropertiesGIF = [frameProperties objectForKey:(id)kCGImagePropertyGIFDictionary];
+    
+    // Try to use the unclamped delay time; fall back to the normal delay time.
+    NSNumber *delayTime = [framePropertiesGIF objectForKey:(id)kCGImagePropertyGIFUnclampedDelayTime];
+    if (!delayTime) {
+        delayTime = [framePropertiesGIF objectForKey:(id)kCGImagePropertyGIFDelayTime];
+    }
+    // If we don't get a delay time from the properties, fall back to `kDelayTimeIntervalDefault` or carry over the preceding frame's value.
+    const NSTimeInterval kDelayTimeIntervalDefault = 0.1;
+    if (!delayTime) {
+        if (index == 0) {
+            FLLog(FLLogLevelInfo, @"Falling back to default delay time for first frame because none found in GIF properties %@", frameProperties);
+            delayTime = @(kDelayTimeIntervalDefault);
+        } else {
+            FLLog(FLLogLevelInfo, @"Falling back to preceding delay time for frame %zu because none found in GIF properties %@", index, frameProperties);
+            delayTime = delayTimesForIndexes[@(index - 1)];
+        }
+    }
+    // Support frame delays as low as `kAWKAnimatedImageDelayTimeIntervalMinimum`, with anything below being rounded up to `kDelayTimeIntervalDefault` for legacy compatibility.
+    // To support the minimum even when rounding errors occur, use an epsilon when comparing. We downcast to float because that's what we get for delayTime from ImageIO.
+    if ([delayTime floatValue] < ((float)kAWKAnimatedImageDelayTimeIntervalMinimum - FLT_EPSILON)) {
+        FLLog(FLLogLevelInfo, @"Rounding frame %zu's `delayTime` from %f up to default %f (minimum supported: %f).", index, [delayTime floatValue], kDelayTimeIntervalDefault, kAWKAnimatedImageDelayTimeIntervalMinimum);
+        delayTime = @(kDelayTimeIntervalDefault);
+    }
+    return delayTime;
+}
+
+
 #pragma mark Frame Loading
 
 - (UIImage *)imageAtIndex:(NSUInteger)index
@@ -518,6 +547,11 @@ static NSHashTable *allAnimatedImagesWeak;
 
     // Early return for nil
     if (!imageRef) {
+        if (self.isScanningFramesLazily) {
+            // The frame wasn't validated up front; show the poster image instead of waiting for this frame forever.
+            FLLog(FLLogLevelInfo, @"Showing poster image for frame %lu because failed to `CGImageSourceCreateImageAtIndex` with image source %@", (unsigned long)index, self.imageSource);
+            return self.posterImage;
+        }
         return nil;
     }
 
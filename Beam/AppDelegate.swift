@@ -141,6 +141,7 @@ final class AppDelegate: UIResponder, UIApplicationDelegate {
         NotificationCenter.default.addObserver(self, selector: #selector(AppDelegate.applicationWindowDidBecomeVisible(_:)), name: UIWindow.didBecomeVisibleNotification, object: self.window)
         NotificationCenter.default.addObserver(self, selector: #selector(AppDelegate.contentSizeCategoryDidChange(_:)), name: UIContentSizeCategory.didChangeNotification, object: nil)
         NotificationCenter.default.addObserver(self, selector: #selector(AppDelegate.userSettingDidChange(_:)), name: .SettingsDidChangeSetting, object: nil)
+        NotificationCenter.default.addObserver(self, selector: #selector(AppDelegate.userActivityActionDidFail(_:)), name: .UserActivityActionDidFail, object: nil)
         
         if let launchOptions = launchOptions, let launchUrl = launchOptions[UIApplication.LaunchOptionsKey.url] as? URL {
             do {
@@ -188,6 +189,23 @@ final class AppDelegate: UIResponder, UIApplicationDelegate {
     
     func applicationDidEnterBackground(_ application: UIApplication) {
         self.passcodeController.applicationDidEnterBackground(application)
+        self.scheduleBackgroundRefresh()
+        
+        //Store which collections were shown, the eviction at the next launch uses them
+        var backgroundTask = UIBackgroundTaskIdentifier.invalid
+        backgroundTask = application.beginBackgroundTask(withName: "Collection access dates") {
+            application.endBackgroundTask(backgroundTask)
+            backgroundTask = .invalid
+        }
+        DataController.shared.executeOperations([DataController.shared.storeCacheController.accessDatesOperation()]) { (_) in
+            DispatchQueue.main.async {
+                guard backgroundTask != .invalid else {
+                    return
+                }
+                application.endBackgroundTask(backgroundTask)
+                backgroundTask = .invalid
+            }
+        }
     }
     
     func applicationWillEnterForeground(_ application: UIApplication) {
@@ -438,14 +456,15 @@ final class AppDelegate: UIResponder, UIApplicationDelegate {
         UIApplication.shared.shortcutItems = shortcuts?.reversed()
     }
     
-    private func favoriteSubreddits() throws -> [Subreddit]? {
+    /// The front page followed by the first bookmarked subreddits, in the order of the subscriptions list.
+    func favoriteSubreddits(bookmarkLimit: Int = 3) throws -> [Subreddit]? {
         var subreddits = [try Subreddit.frontpageSubreddit()]
         
         subreddits += try DataController.shared.performBackgroundTaskAndWait { context in
             let fetchRequest = NSFetchRequest<Subreddit>(entityName: Subreddit.entityName())
             fetchRequest.sortDescriptors = [NSSortDescriptor(key: "order", ascending: true), NSSortDescriptor(key: "displayName", ascending: true, selector: #selector(NSString.localizedStandardCompare(_:))), NSSortDescriptor(key: "identifier", ascending: true)]
             fetchRequest.predicate = NSPredicate(format: "isBookmarked == YES && NOT (identifier IN %@)", [Subreddit.frontpageIdentifier, Subreddit.allIdentifier])
-            fetchRequest.fetchLimit = 3
+            fetchRequest.fetchLimit = bookmarkLimit
             return try context.fetch(fetchRequest)
         }
         
@@ -515,20 +534,58 @@ final class AppDelegate: UIResponder, UIApplicationDelegate {
     }
     
     private func performBackgroundRefresh(_ task: BGAppRefreshTask) {
-        guard authenticationController.userSessionAvailable,
-            UserSettings[.redditMessageNotificationsEnabled],
-            authenticationController.isAuthenticated else {
-                task.setTaskCompleted(success: false)
-                return
+        let notifiesMessages = authenticationController.userSessionAvailable && UserSettings[.redditMessageNotificationsEnabled] && authenticationController.isAuthenticated
+        // Warming up downloads a few megabytes, so it only runs on Wi-Fi
+        let warmsUp = DataController.shared.redditReachability?.isReachableViaWiFi == true
+        guard notifiesMessages || warmsUp else {
+            task.setTaskCompleted(success: false)
+            return
         }
         
         // Now we satisfy local prerequisities for app refresh,
         // schedule the next app refresh before it's too late.
         scheduleBackgroundRefresh()
         
-        MessageCollectionQuery.fetchUnreadMessages { result, _ in
+        let group = DispatchGroup()
+        var success = true
+        
+        if notifiesMessages {
+            group.enter()
+            self.notifyUnreadMessages { (messagesSuccess) in
+                DispatchQueue.main.async {
+                    success = success && messagesSuccess
+                    group.leave()
+                }
+            }
+        }
+        
+        if warmsUp {
+            let warmUpController = BackgroundWarmUpController(authenticationController: self.authenticationController)
+            task.expirationHandler = {
+                DispatchQueue.main.async {
+                    warmUpController.cancel()
+                }
+            }
+            group.enter()
+            DispatchQueue.main.async {
+                warmUpController.start { (report) in
+                    AWKDebugLog("Background warm-up: %@", report.description)
+                    success = success && !report.isCancelled
+                    group.leave()
+                }
+            }
+        }
+        
+        group.notify(queue: DispatchQueue.main) {
+            task.setTaskCompleted(success: success)
+        }
+    }
+    
+    /// Posts a notification for every unread message the user hasn't been notified of yet.
+    private func notifyUnreadMessages(completionHandler: @escaping (_ success: Bool) -> Void) {
+        MessageCollectionQuery.fetchUnreadMessages(priority: .background) { result, _ in
             guard let messages = result else {
-                task.setTaskCompleted(success: false)
+                completionHandler(false)
                 return
             }
             
@@ -544,7 +601,7 @@ final class AppDelegate: UIResponder, UIApplicationDelegate {
             }
             
             UserSettings[.notificationsBadgeCount] = badgeCount
-            task.setTaskCompleted(success: true)
+            completionHandler(true)
         }
     }
     
@@ -675,6 +732,41 @@ final class AppDelegate: UIResponder, UIApplicationDelegate {
         }
     }
     
+    /// Votes, saves and hides are sent to reddit after a while, when the screen they were made on might be gone. If reddit rejects them, for example because the post is archived, the error is shown on the screen that is visible now.
+    @objc private func userActivityActionDidFail(_ notification: Notification) {
+        guard let kind = notification.userInfo?[UserActivityController.FailedActionKindKey] as? JournalAction.Kind, let topViewController = AppDelegate.topViewController() else {
+            return
+        }
+        // A flush can reject multiple actions, one alert is enough
+        guard !(topViewController is BeamAlertController) else {
+            return
+        }
+        
+        let title: String
+        let message: String?
+        switch kind {
+        case .vote:
+            if let noticeHandler = topViewController as? NoticeHandling {
+                noticeHandler.presentErrorMessage(AWKLocalizedString("error-vote"))
+                return
+            }
+            title = AWKLocalizedString("error-vote")
+            message = nil
+        case .save:
+            let isPost = notification.object is Post
+            title = isPost ? AWKLocalizedString("post-save-error") : AWKLocalizedString("comment-save-error")
+            message = isPost ? AWKLocalizedString("post-save-error-message") : AWKLocalizedString("comment-save-error-message")
+        case .hide:
+            title = AWKLocalizedString("post-hide-error")
+            message = AWKLocalizedString("post-hide-error-message")
+        case .visit:
+            return
+        }
+        let alertController = BeamAlertController(title: title, message: message, preferredStyle: .alert)
+        alertController.addCloseAction()
+        topViewController.present(alertController, animated: true, completion: nil)
+    }
+    
     /// The action to take if the window wasn't usable on app open, due to passcode or something else. See `scheduleAppAction(:)`
     private var scheduledAppAction: DelayedAppAction?
     
@@ -736,7 +828,10 @@ final class AppDelegate: UIResponder, UIApplicationDelegate {
     
     private func clearExpiredContent() {
         let clearOperation = DataController.clearExpiredContentOperation()
-        DataController.shared.executeAndSaveOperations([clearOperation], handler: nil)
+        // Evict the least recently used collections if the store is still over its budget
+        let evictionOperation = DataController.shared.storeCacheController.evictionOperation()
+        evictionOperation.addDependency(clearOperation)
+        DataController.shared.executeAndSaveOperations([clearOperation, evictionOperation], handler: nil)
     }
     
     // MARK: - Authentication
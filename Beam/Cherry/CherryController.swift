@@ -70,7 +70,17 @@ final class CherryController: NSObject {
             
         }
     }
-    var features: CherryFeatures?
+    var features: CherryFeatures? {
+        didSet {
+            self.compileImageURLMatchers()
+        }
+    }
+    
+    /// Matches the image URLs Cherry has metadata for. Compiled once every time the features change.
+    fileprivate(set) var imageURLMatcher: ImageURLMatcher?
+    
+    /// Matches the image URLs Cherry has metadata for, except for reddit media which is handled locally.
+    fileprivate(set) var remoteImageURLMatcher: ImageURLMatcher?
 
     override init() {
         super.init()
@@ -210,6 +220,18 @@ final class CherryController: NSObject {
         
     }
     
+    fileprivate func compileImageURLMatchers() {
+        guard let patterns = self.features?.imageURLPatterns else {
+            self.imageURLMatcher = nil
+            self.remoteImageURLMatcher = nil
+            return
+        }
+        self.imageURLMatcher = ImageURLMatcher(patterns: patterns)
+        self.remoteImageURLMatcher = ImageURLMatcher(patterns: patterns.filter({ (pattern) -> Bool in
+            return !pattern.contains("redditmedia") && !pattern.contains("reddituploads") && !pattern.contains("redd.it")
+        }))
+    }
+    
     fileprivate func loadFeatures() {
         var features = CherryFeatures()
         
@@ -75,39 +75,20 @@ class StreamImagesOperation: CherryPostParsingOperation {
     }
     
     fileprivate func imageMetadataRequestsForPosts(_ posts: [Post]) -> [CherryKit.ImageRequest] {
+        //Reddit media is handled locally, so the matcher doesn't include those patterns
+        guard let matcher = self.cherryController?.remoteImageURLMatcher else {
+            return [CherryKit.ImageRequest]()
+        }
         
         let imagePosts = posts.filter { (post: Post) -> Bool in
-            let imageURLPatterns: [String]? = self.cherryController?.features?.imageURLPatterns.filter({
-                let pattern: String = $0
-                //Filter reddit media patterns that we handle locally
-                if pattern.contains("redditmedia") || pattern.contains("reddituploads") || pattern.contains("redd.it") {
-                    return false
-                }
-                return true
-            })
-            if let patterns: [String] = imageURLPatterns {
-                guard post.urlString != nil && post.identifier != nil else {
-                    return false
-                }
-                //Skip posts that already have media objects and are not imgur, imgur links might have an updated album or text
-                if let mediaObjects = post.mediaObjects, mediaObjects.count > 0 && post.urlString?.lowercased().contains("imgur.com") == false {
-                    return false
-                }
-                
-                for pattern in patterns {
-                    do {
-                        let regex = try NSRegularExpression(pattern: pattern, options: [NSRegularExpression.Options.caseInsensitive])
-                        if let match = regex.firstMatch(in: post.urlString!, options: [], range: NSRange(location: 0, length: (post.urlString! as NSString).length)) {
-                            if match.numberOfRanges > 0 {
-                                return true
-                            }
-                        }
-                    } catch {
-                        NSLog("Error while checking post URL for regex: \(error)")
-                    }
-                }
+            guard let urlString = post.urlString, post.identifier != nil else {
+                return false
+            }
+            //Skip posts that already have media objects and are not imgur, imgur links might have an updated album or text
+            if let mediaObjects = post.mediaObjects, mediaObjects.count > 0 && urlString.lowercased().contains("imgur.com") == false {
+                return false
             }
-            return false
+            return matcher.matches(urlString)
         }
         
         return imagePosts.map { (post: Post) -> CherryKit.ImageRequest in
@@ -116,12 +97,15 @@ class StreamImagesOperation: CherryPostParsingOperation {
     }
     
     fileprivate func insertMediaObjectsArray(_ responses: [ImageResponse], posts: [Post]) {
+        var postsByIdentifier = [String: Post](minimumCapacity: posts.count)
+        for post in posts {
+            if let identifier = post.identifier, postsByIdentifier[identifier] == nil {
+                postsByIdentifier[identifier] = post
+            }
+        }
         for postImageResponse in responses {
-            if let post = posts.first(where: { (post) -> Bool in
-                return post.identifier == postImageResponse.request.postID
-            }) {
+            if let post = postsByIdentifier[postImageResponse.request.postID] {
                 post.insertMediaObjects(with: postImageResponse)
-                
             }
         }
     }
@@ -0,0 +1,211 @@
+//
+//  BackgroundWarmUpController.swift
+//  Beam
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import UIKit
+import CoreData
+import Snoo
+import SDWebImage
+
+/// Loads the front page and the bookmarked subreddits during a background refresh, so the first screen after launch is shown from the store instead of the network.
+///
+/// The streams are fetched through a CollectionController with the same query and post-processing as the stream itself, which also parses the markdown of self posts. Streams that haven't expired yet are not fetched again. Afterwards the thumbnails the stream will show are downloaded, at the size the cells look up in the variant cache.
+///
+/// The controller should only be used on the main thread. When the background task expires, `cancel()` stops the requests and reports what was done until then.
+final class BackgroundWarmUpController {
+    
+    struct Report: CustomStringConvertible {
+        /// The number of bytes received for the streams and the thumbnails.
+        var byteCount = 0
+        /// The number of posts that were fetched.
+        var objectCount = 0
+        var collectionCount = 0
+        var thumbnailCount = 0
+        var duration: TimeInterval = 0
+        /// Whether the warm-up was cancelled before everything was loaded.
+        var isCancelled = false
+        
+        var description: String {
+            let formatter = ByteCountFormatter()
+            return "\(formatter.string(fromByteCount: Int64(self.byteCount))), \(self.objectCount) posts in \(self.collectionCount) streams and \(self.thumbnailCount) thumbnails in \(String(format: "%.1f", self.duration))s\(self.isCancelled ? ", cancelled" : "")"
+        }
+    }
+    
+    /// The number of bookmarked subreddits that are warmed up after the front page.
+    var maximumBookmarkCount = 4
+    
+    /// The number of thumbnails that are downloaded at the same time.
+    var maximumConcurrentThumbnailCount = 4
+    
+    fileprivate let authenticationController: AuthenticationController
+    
+    fileprivate var completionHandler: ((Report) -> Void)?
+    
+    fileprivate var report = Report()
+    
+    fileprivate var startDate = Date()
+    
+    fileprivate var startDownloadedByteCount = 0
+    
+    fileprivate var waitingSubreddits = [Subreddit]()
+    
+    fileprivate var collectionController: CollectionController?
+    
+    fileprivate var waitingThumbnailURLs = [URL]()
+    
+    fileprivate var thumbnailOperations = [SDWebImageOperation]()
+    
+    fileprivate var runningThumbnailCount = 0
+    
+    fileprivate var isCancelled = false
+    
+    init(authenticationController: AuthenticationController) {
+        self.authenticationController = authenticationController
+    }
+    
+    // MARK: - Warming up
+    
+    /// Starts warming up. The completion handler is called on the main thread when everything is loaded, or when the warm-up is cancelled.
+    func start(completionHandler: @escaping (_ report: Report) -> Void) {
+        assert(Thread.isMainThread, "The warm-up should be started on the main thread")
+        self.completionHandler = completionHandler
+        self.startDate = Date()
+        self.startDownloadedByteCount = AppDelegate.shared.imageLoader.downloadedByteCount
+        
+        do {
+            // The favorite subreddits live in the private context, the streams and their settings are read on the main thread
+            let context: NSManagedObjectContext = AppDelegate.shared.managedObjectContext
+            let subreddits = try AppDelegate.shared.favoriteSubreddits(bookmarkLimit: self.maximumBookmarkCount) ?? []
+            self.waitingSubreddits = subreddits.compactMap { context.object(with: $0.objectID) as? Subreddit }
+        } catch {
+            AWKDebugLog("Failed to get the subreddits to warm up: %@", (error as NSError))
+        }
+        self.warmUpNextSubreddit()
+    }
+    
+    /// Stops the requests of the warm-up and calls the completion handler. The content that was loaded so far stays in the store.
+    func cancel() {
+        guard self.completionHandler != nil else {
+            return
+        }
+        self.isCancelled = true
+        self.collectionController?.cancelFetching()
+        for operation in self.thumbnailOperations {
+            operation.cancel()
+        }
+        self.thumbnailOperations.removeAll()
+        self.finish()
+    }
+    
+    fileprivate func warmUpNextSubreddit() {
+        guard !self.isCancelled else {
+            return
+        }
+        guard !self.waitingSubreddits.isEmpty else {
+            self.collectionController = nil
+            self.startThumbnailDownloads()
+            return
+        }
+        let subreddit = self.waitingSubreddits.removeFirst()
+        
+        let collectionController = CollectionController(authentication: self.authenticationController, context: AppDelegate.shared.managedObjectContext)
+        collectionController.priority = .background
+        collectionController.postProcessOperations = StreamViewController.postProcessOperations
+        collectionController.query = SubredditStreamViewController.streamQuery(for: subreddit, sortType: subreddit.streamSortType, timeFrame: subreddit.streamTimeFrame)
+        self.collectionController = collectionController
+        
+        if collectionController.collectionID != nil && collectionController.isCollectionExpired == false {
+            // The stream will be shown from the store anyway, only its thumbnails might be missing
+            self.collectionDidWarmUp(collectionController, subreddit: subreddit, didFetch: false)
+            return
+        }
+        collectionController.startInitialFetching { [weak self] (_, error) in
+            DispatchQueue.main.async {
+                if let error = error {
+                    AWKDebugLog("Failed to warm up a stream: %@", (error as NSError))
+                }
+                self?.collectionDidWarmUp(collectionController, subreddit: subreddit, didFetch: error == nil)
+            }
+        }
+    }
+    
+    fileprivate func collectionDidWarmUp(_ collectionController: CollectionController, subreddit: Subreddit, didFetch: Bool) {
+        guard !self.isCancelled, collectionController === self.collectionController else {
+            return
+        }
+        self.report.byteCount += collectionController.receivedByteCount
+        
+        if let collectionID = collectionController.collectionID, let collection = AppDelegate.shared.managedObjectContext.object(with: collectionID) as? ObjectCollection, let posts = collection.objects?.array as? [Post] {
+            if didFetch {
+                self.report.collectionCount += 1
+                self.report.objectCount += posts.count
+            }
+            self.waitingThumbnailURLs.append(contentsOf: posts.compactMap { self.thumbnailURL(for: $0, in: subreddit) })
+        }
+        self.warmUpNextSubreddit()
+    }
+    
+    // MARK: - Thumbnails
+    
+    /// The thumbnail the stream of the subreddit shows for the post, if it shows one.
+    fileprivate func thumbnailURL(for post: Post, in subreddit: Subreddit) -> URL? {
+        guard !post.isSelfText.boolValue, post.mediaObjects?.count == 1, let mediaObject = post.mediaObjects?.firstObject as? MediaObject, !(mediaObject is MediaDirectVideo) else {
+            return nil
+        }
+        // Like the stream: a small thumbnail next to the title, a large image, or no thumbnail at all
+        switch subreddit.thumbnailViewType ?? UserSettings[.thumbnailsViewType] {
+        case ThumbnailsViewType.none:
+            return nil
+        case ThumbnailsViewType.small:
+            return StreamViewController.thumbnailURL(for: mediaObject, small: true)
+        default:
+            return StreamViewController.thumbnailURL(for: mediaObject, small: false)
+        }
+    }
+    
+    fileprivate func startThumbnailDownloads() {
+        while !self.isCancelled && self.runningThumbnailCount < self.maximumConcurrentThumbnailCount && !self.waitingThumbnailURLs.isEmpty {
+            let url = self.waitingThumbnailURLs.removeFirst()
+            self.runningThumbnailCount += 1
+            let operation = AppDelegate.shared.imageLoader.startDownloadingImageWithURL(url, completionHandler: { [weak self] (image) in
+                self?.thumbnailDidLoad(image)
+            })
+            if let operation = operation {
+                self.thumbnailOperations.append(operation)
+            }
+        }
+        if self.runningThumbnailCount == 0 {
+            self.finish()
+        }
+    }
+    
+    fileprivate func thumbnailDidLoad(_ image: UIImage?) {
+        guard !self.isCancelled else {
+            return
+        }
+        self.runningThumbnailCount -= 1
+        if image != nil {
+            self.report.thumbnailCount += 1
+        }
+        self.startThumbnailDownloads()
+    }
+    
+    fileprivate func finish() {
+        guard let completionHandler = self.completionHandler else {
+            return
+        }
+        self.completionHandler = nil
+        self.collectionController = nil
+        self.thumbnailOperations.removeAll()
+        
+        self.report.byteCount += AppDelegate.shared.imageLoader.downloadedByteCount - self.startDownloadedByteCount
+        self.report.duration = Date().timeIntervalSince(self.startDate)
+        self.report.isCancelled = self.isCancelled
+        completionHandler(self.report)
+    }
+    
+}
@@ -11,31 +11,127 @@ import SDWebImage
 
 class BeamImageLoader: NSObject {
     
-    func startDownloadingImageWithURL(_ url: URL, downscalingOptions: DownscaledImageOptions? = nil, progressHandler: ((_ totalBytesWritten: Int, _ totalBytesExpectedToWrite: Int) -> Void)? = nil, completionHandler:  ((_ image: UIImage?) -> Void)?) -> SDWebImageOperation? {
-        let operation = SDWebImageManager.shared.loadImage(with: url, options: [], progress: { (receivedSize, expectedSize, _) in
+    /// Reads variants from disk and downscales the original images, off the main thread.
+    fileprivate let variantQueue = DispatchQueue(label: "com.madeawkward.beam.image-loader", qos: .userInitiated, attributes: .concurrent)
+    
+    fileprivate var currentDownloadedByteCount = 0
+    
+    fileprivate let lock = NSLock()
+    
+    /// The number of bytes of the images that were downloaded since launch, images from the disk cache are not counted.
+    var downloadedByteCount: Int {
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        return self.currentDownloadedByteCount
+    }
+    
+    /**
+     Loads the image at the URL downscaled to the options. The downscaled image is looked up in the variant cache first, the original image is only downloaded or decoded if the variant is not cached yet.
+     
+     - parameter lowPriority: Whether the download should wait for the other downloads, for images that are loaded before they are shown.
+     - returns: The operation loading the image, nil if the downscaled image was in memory.
+     */
+    func startDownloadingImageWithURL(_ url: URL, downscalingOptions: DownscaledImageOptions? = nil, lowPriority: Bool = false, progressHandler: ((_ totalBytesWritten: Int, _ totalBytesExpectedToWrite: Int) -> Void)? = nil, completionHandler:  ((_ image: UIImage?) -> Void)?) -> SDWebImageOperation? {
+        let options = downscalingOptions ?? DownscaledImageOptions()
+        let variantKey = ImageVariantKey(urlString: url.absoluteString, options: options)
+        if let cachedImage = ImageVariantCache.shared.memoryImage(for: variantKey) {
             DispatchQueue.main.async { () -> Void in
-                progressHandler?(receivedSize, expectedSize)
+                completionHandler?(cachedImage)
             }
-        }, completed: { (image, _, _, _, _, url) in
-            guard let image = image else {
+            return nil
+        }
+        
+        let operation = ImageLoadingOperation()
+        self.variantQueue.async {
+            if let cachedImage = ImageVariantCache.shared.image(for: variantKey) {
                 DispatchQueue.main.async { () -> Void in
-                    completionHandler?(nil)
+                    if !operation.isCancelled {
+                        completionHandler?(cachedImage)
+                    }
                 }
                 return
             }
-            let options = downscalingOptions ?? DownscaledImageOptions()
-            let scaledImage = UIImage.downscaledImageWithImage(image, options: options)
-            
-            if let cacheKey = url?.absoluteString, downscalingOptions == nil {
-                SDImageCache.shared.store(scaledImage, forKey: cacheKey + "_scaled", toDisk: true)
-            }
-            
-            DispatchQueue.main.async { () -> Void in
-                completionHandler?(scaledImage)
+            guard !operation.isCancelled else {
+                return
             }
-
-        })
+            operation.imageOperation = SDWebImageManager.shared.loadImage(with: url, options: lowPriority ? [.lowPriority] : [], progress: { (receivedSize, expectedSize, _) in
+                DispatchQueue.main.async { () -> Void in
+                    progressHandler?(receivedSize, expectedSize)
+                }
+            }, completed: { (image, data, _, cacheType, _, _) in
+                if cacheType == .none, let data = data {
+                    self.lock.lock()
+                    self.currentDownloadedByteCount += data.count
+                    self.lock.unlock()
+                }
+                guard let image = image else {
+                    DispatchQueue.main.async { () -> Void in
+                        completionHandler?(nil)
+                    }
+                    return
+                }
+                self.variantQueue.async {
+                    let scaledImage = UIImage.downscaledImageWithImage(image, options: options)
+                    if let scaledImage = scaledImage {
+                        ImageVariantCache.shared.store(scaledImage, for: variantKey)
+                    }
+                    
+                    DispatchQueue.main.async { () -> Void in
+                        completionHandler?(scaledImage)
+                    }
+                }
+            })
+        }
         return operation
     }
 
 }
+
+/// Wraps the operation of SDWebImage, which is only started when the downscaled image is not found on disk.
+private final class ImageLoadingOperation: NSObject, SDWebImageOperation {
+    
+    fileprivate let lock = NSLock()
+    
+    fileprivate var cancelled = false
+    
+    fileprivate var loadOperation: SDWebImageOperation?
+    
+    var isCancelled: Bool {
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        return self.cancelled
+    }
+    
+    /// Setting the operation after the loading has been cancelled cancels it directly.
+    var imageOperation: SDWebImageOperation? {
+        get {
+            self.lock.lock()
+            defer {
+                self.lock.unlock()
+            }
+            return self.loadOperation
+        }
+        set {
+            self.lock.lock()
+            self.loadOperation = newValue
+            let cancelled = self.cancelled
+            self.lock.unlock()
+            if cancelled {
+                newValue?.cancel()
+            }
+        }
+    }
+    
+    func cancel() {
+        self.lock.lock()
+        self.cancelled = true
+        let loadOperation = self.loadOperation
+        self.lock.unlock()
+        loadOperation?.cancel()
+    }
+    
+}
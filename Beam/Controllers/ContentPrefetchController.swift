@@ -0,0 +1,234 @@
+//
+//  ContentPrefetchController.swift
+//  Beam
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import UIKit
+import Ocarina
+import SDWebImage
+
+/// Link metadata or a thumbnail that can be loaded before it is shown.
+struct PrefetchItem: Hashable {
+    
+    let url: URL
+    
+    /// The variant of the thumbnail the cell will look up, nil for link metadata.
+    fileprivate let variantKey: ImageVariantKey?
+    
+    fileprivate let downscalingOptions: DownscaledImageOptions?
+    
+    /// The metadata Ocarina shows in the link preview of a post.
+    static func linkMetadata(_ url: URL) -> PrefetchItem {
+        return PrefetchItem(url: url, variantKey: nil, downscalingOptions: nil)
+    }
+    
+    /// The thumbnail downscaled with the same options as the cell that shows it, so the cell finds it in the variant cache.
+    static func thumbnail(_ url: URL, options: DownscaledImageOptions = DownscaledImageOptions()) -> PrefetchItem {
+        return PrefetchItem(url: url, variantKey: ImageVariantKey(urlString: url.absoluteString, options: options), downscalingOptions: options)
+    }
+    
+    static func == (lhs: PrefetchItem, rhs: PrefetchItem) -> Bool {
+        return lhs.url == rhs.url && lhs.variantKey == rhs.variantKey
+    }
+    
+    func hash(into hasher: inout Hasher) {
+        hasher.combine(self.url)
+        hasher.combine(self.variantKey)
+    }
+    
+}
+
+/// Tracks the scroll velocity of a scroll view, in points per second. Positive when scrolling towards the end of the content.
+struct ScrollVelocityTracker {
+    
+    private var lastOffset: CGFloat?
+    private var lastTimestamp: CFTimeInterval = 0
+    
+    private(set) var velocity: CGFloat = 0
+    
+    mutating func update(with scrollView: UIScrollView) {
+        let offset = scrollView.contentOffset.y
+        let timestamp = CACurrentMediaTime()
+        if let lastOffset = self.lastOffset, timestamp > self.lastTimestamp {
+            self.velocity = (offset - lastOffset) / CGFloat(timestamp - self.lastTimestamp)
+        }
+        self.lastOffset = offset
+        self.lastTimestamp = timestamp
+    }
+    
+}
+
+/// Loads the link metadata and thumbnails of the posts that are about to scroll on screen.
+///
+/// Every screen tells the controller which items are in its prefetch window. Items are loaded once, even if multiple screens or pages ask for them, and not at all while they are in the memory cache of the variant cache or Ocarina. Items that left the window of every screen are cancelled. The items of the window that was updated last are loaded first.
+///
+/// The controller should only be used on the main thread.
+final class ContentPrefetchController {
+    
+    static let shared = ContentPrefetchController()
+    
+    /// The number of sections or items ahead of the visible ones that are prefetched when not scrolling.
+    static let minimumLookahead = 4
+    
+    /// The number of sections or items ahead of the visible ones that are prefetched when scrolling fast.
+    static let maximumLookahead = 20
+    
+    /// The number of items that are loaded at the same time, so prefetching doesn't take all connections from the content on screen.
+    var maximumConcurrentRequestCount = 4
+    
+    /// The items in the window of every screen, in order of priority.
+    fileprivate var windows = [ObjectIdentifier: [PrefetchItem]]()
+    
+    /// The screens that want an item, for every item that is waiting or loading.
+    fileprivate var owners = [PrefetchItem: Set<ObjectIdentifier>]()
+    
+    fileprivate var waitingItems = [PrefetchItem]()
+    
+    fileprivate var runningRequests = [PrefetchItem: PrefetchRequest]()
+    
+    // MARK: - Windows
+    
+    /// Returns the indexes to prefetch for the visible indexes: the indexes ahead in the direction of scrolling, more of them when scrolling faster.
+    class func prefetchRange(visibleRange: ClosedRange<Int>, count: Int, velocity: CGFloat) -> CountableRange<Int> {
+        let speedFactor = min(abs(velocity) / 3000, 1)
+        let lookahead = ContentPrefetchController.minimumLookahead + Int(CGFloat(ContentPrefetchController.maximumLookahead - ContentPrefetchController.minimumLookahead) * speedFactor)
+        if velocity < 0 {
+            return max(visibleRange.lowerBound - lookahead, 0)..<max(min(visibleRange.lowerBound, count), 0)
+        }
+        return min(visibleRange.upperBound + 1, count)..<min(visibleRange.upperBound + 1 + lookahead, count)
+    }
+    
+    /// Replaces the prefetch window of the owner. Items that are no longer in the window of any owner are cancelled.
+    func setPrefetchItems(_ items: [PrefetchItem], for owner: AnyObject) {
+        let ownerID = ObjectIdentifier(owner)
+        let previousItems = self.windows[ownerID] ?? []
+        self.windows[ownerID] = items.isEmpty ? nil : items
+        
+        let itemSet = Set(items)
+        for item in previousItems where !itemSet.contains(item) {
+            self.release(item, by: ownerID)
+        }
+        self.retain(items, by: ownerID)
+    }
+    
+    /// Adds the items to the prefetch window of the owner, for example the rows the table view is about to show.
+    func prefetch(_ items: [PrefetchItem], for owner: AnyObject) {
+        let ownerID = ObjectIdentifier(owner)
+        var window = self.windows[ownerID] ?? []
+        let windowSet = Set(window)
+        window.append(contentsOf: items.filter { !windowSet.contains($0) })
+        self.windows[ownerID] = window.isEmpty ? nil : window
+        self.retain(items, by: ownerID)
+    }
+    
+    /// Removes the items from the prefetch window of the owner.
+    func cancelPrefetching(_ items: [PrefetchItem], for owner: AnyObject) {
+        let ownerID = ObjectIdentifier(owner)
+        let itemSet = Set(items)
+        let window = (self.windows[ownerID] ?? []).filter { !itemSet.contains($0) }
+        self.windows[ownerID] = window.isEmpty ? nil : window
+        for item in itemSet {
+            self.release(item, by: ownerID)
+        }
+    }
+    
+    /// Cancels all prefetching for the owner, call this when the screen goes away.
+    func cancelAllPrefetching(for owner: AnyObject) {
+        self.setPrefetchItems([], for: owner)
+    }
+    
+    // MARK: - Loading
+    
+    fileprivate func retain(_ items: [PrefetchItem], by ownerID: ObjectIdentifier) {
+        var newItems = [PrefetchItem]()
+        for item in items where !self.isLoaded(item) {
+            let isWaiting = self.owners[item] != nil && self.runningRequests[item] == nil
+            self.owners[item, default: Set<ObjectIdentifier>()].insert(ownerID)
+            if isWaiting {
+                // Move the item forward, the latest window is the most urgent
+                self.waitingItems.removeAll(where: { $0 == item })
+                newItems.append(item)
+            } else if self.runningRequests[item] == nil {
+                newItems.append(item)
+            }
+        }
+        self.waitingItems.insert(contentsOf: newItems, at: 0)
+        self.startWaitingItems()
+    }
+    
+    fileprivate func release(_ item: PrefetchItem, by ownerID: ObjectIdentifier) {
+        guard var itemOwners = self.owners[item] else {
+            return
+        }
+        itemOwners.remove(ownerID)
+        guard itemOwners.isEmpty else {
+            self.owners[item] = itemOwners
+            return
+        }
+        self.owners.removeValue(forKey: item)
+        self.waitingItems.removeAll(where: { $0 == item })
+        self.runningRequests.removeValue(forKey: item)?.cancel()
+        self.startWaitingItems()
+    }
+    
+    /// An item is loaded as long as it is in memory. An item that has been removed from the cache is loaded again, from disk if it is still there.
+    fileprivate func isLoaded(_ item: PrefetchItem) -> Bool {
+        if let variantKey = item.variantKey {
+            return ImageVariantCache.shared.memoryImage(for: variantKey) != nil
+        }
+        return OcarinaManager.shared.cache[item.url] != nil
+    }
+    
+    fileprivate func startWaitingItems() {
+        while self.runningRequests.count < self.maximumConcurrentRequestCount && !self.waitingItems.isEmpty {
+            let item = self.waitingItems.removeFirst()
+            self.runningRequests[item] = self.startRequest(for: item)
+        }
+    }
+    
+    fileprivate func startRequest(for item: PrefetchItem) -> PrefetchRequest {
+        let completionHandler = { [weak self] in
+            DispatchQueue.main.async {
+                self?.requestDidFinish(for: item)
+            }
+        }
+        if let options = item.downscalingOptions {
+            let operation = AppDelegate.shared.imageLoader.startDownloadingImageWithURL(item.url, downscalingOptions: options, lowPriority: true, completionHandler: { (_) in
+                completionHandler()
+            })
+            return .image(operation)
+        } else {
+            let request = item.url.oca.fetchInformation(completionHandler: { (_, _) in
+                completionHandler()
+            })
+            return .linkMetadata(request)
+        }
+    }
+    
+    fileprivate func requestDidFinish(for item: PrefetchItem) {
+        guard self.runningRequests.removeValue(forKey: item) != nil else {
+            // The request has been cancelled
+            return
+        }
+        self.owners.removeValue(forKey: item)
+        self.startWaitingItems()
+    }
+    
+}
+
+private enum PrefetchRequest {
+    case image(SDWebImageOperation?)
+    case linkMetadata(OcarinaInformationRequest?)
+    
+    func cancel() {
+        switch self {
+        case .image(let operation):
+            operation?.cancel()
+        case .linkMetadata(let request):
+            request?.cancel()
+        }
+    }
+}
@@ -0,0 +1,246 @@
+//
+//  ImageVariantCache.swift
+//  Beam
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import UIKit
+import SDWebImage
+
+/// Identifies a downscaled version of an image: the URL of the original image, the size in pixels it was scaled to and the content mode used for scaling.
+struct ImageVariantKey: Hashable {
+    
+    let urlString: String
+    let pixelWidth: Int
+    let pixelHeight: Int
+    let contentMode: UIView.ContentMode
+    
+    init(urlString: String, options: DownscaledImageOptions) {
+        // The same scale as UIImage.downscaledImageWithImage uses for the destination size
+        let scale: CGFloat = min(2.0, UIScreen.main.scale)
+        self.urlString = urlString
+        self.pixelWidth = Int(floor(options.constrainingSize.width * scale))
+        self.pixelHeight = Int(floor(options.constrainingSize.height * scale))
+        self.contentMode = options.contentMode
+    }
+    
+    /// The key of the variant in the disk cache, the original image is stored under the URL itself.
+    var diskCacheKey: String {
+        return "\(self.urlString)_variant_\(self.pixelWidth)x\(self.pixelHeight)_\(self.contentMode.rawValue)"
+    }
+    
+}
+
+/// Caches the downscaled versions of images, so a cell that shows an image again doesn't have to download, decode and downscale the original image.
+///
+/// Decoded variants are kept in memory up to a byte budget, the least recently used variants are removed first. All variants are also written to the disk cache, which is only read when the variant is not in memory.
+final class ImageVariantCache {
+    
+    struct Statistics: CustomStringConvertible {
+        var memoryHits = 0
+        var diskHits = 0
+        var misses = 0
+        
+        var hitRate: Double {
+            let lookups = self.memoryHits + self.diskHits + self.misses
+            return lookups > 0 ? Double(self.memoryHits + self.diskHits) / Double(lookups) : 0
+        }
+        
+        var description: String {
+            return "Image variants: \(self.memoryHits) memory hits, \(self.diskHits) disk hits, \(self.misses) misses (\(Int(self.hitRate * 100))% hit rate)"
+        }
+    }
+    
+    static let shared = ImageVariantCache(memoryBudget: 60 * 1024 * 1024, diskCache: SDImageCache.shared)
+    
+    /// The maximum number of bytes the decoded variants in memory can use.
+    let memoryBudget: Int
+    
+    /// The disk cache the variants are written to. Nil to keep the variants in memory only.
+    fileprivate let diskCache: SDImageCache?
+    
+    fileprivate var memoryEntries = [ImageVariantKey: MemoryEntry]()
+    
+    /// The most and least recently used entries, the entries in between are linked through the entries.
+    fileprivate var newestEntry: MemoryEntry?
+    fileprivate var oldestEntry: MemoryEntry?
+    
+    fileprivate(set) var memoryCost = 0
+    
+    fileprivate var currentStatistics = Statistics()
+    
+    fileprivate let lock = NSLock()
+    
+    fileprivate let diskQueue = DispatchQueue(label: "com.madeawkward.beam.image-variant-disk-cache", qos: .utility)
+    
+    init(memoryBudget: Int, diskCache: SDImageCache?) {
+        self.memoryBudget = memoryBudget
+        self.diskCache = diskCache
+        NotificationCenter.default.addObserver(self, selector: #selector(ImageVariantCache.didReceiveMemoryWarning(_:)), name: UIApplication.didReceiveMemoryWarningNotification, object: nil)
+    }
+    
+    var statistics: Statistics {
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        return self.currentStatistics
+    }
+    
+    // MARK: - Lookup
+    
+    /// Returns the variant if it is in memory. This doesn't touch the disk, so it can be used on the main thread.
+    func memoryImage(for key: ImageVariantKey) -> UIImage? {
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        guard let entry = self.memoryEntries[key] else {
+            return nil
+        }
+        self.moveToFront(entry)
+        self.currentStatistics.memoryHits += 1
+        return entry.image
+    }
+    
+    /// Returns the variant from memory, or from disk if it is not in memory. Reading from disk blocks, so this shouldn't be used on the main thread.
+    func image(for key: ImageVariantKey) -> UIImage? {
+        self.lock.lock()
+        if let entry = self.memoryEntries[key] {
+            self.moveToFront(entry)
+            self.currentStatistics.memoryHits += 1
+            self.lock.unlock()
+            return entry.image
+        }
+        self.lock.unlock()
+        
+        guard let data = self.diskCache?.diskImageData(forKey: key.diskCacheKey), let diskImage = UIImage(data: data) else {
+            self.lock.lock()
+            self.currentStatistics.misses += 1
+            self.lock.unlock()
+            return nil
+        }
+        // Decode the image now, instead of on the main thread when it is drawn
+        let image = SDImageCoderHelper.decodedImage(with: diskImage) ?? diskImage
+        self.lock.lock()
+        self.currentStatistics.diskHits += 1
+        self.insert(image, for: key)
+        self.lock.unlock()
+        return image
+    }
+    
+    // MARK: - Storing
+    
+    /// Stores the variant in memory and, if requested, writes it to the disk cache in the background.
+    func store(_ image: UIImage, for key: ImageVariantKey, toDisk: Bool = true) {
+        self.lock.lock()
+        self.insert(image, for: key)
+        self.lock.unlock()
+        
+        guard toDisk, let diskCache = self.diskCache else {
+            return
+        }
+        self.diskQueue.async {
+            let data = SDImageCodersManager.shared.encodedData(with: image, format: .undefined, options: nil)
+            diskCache.storeImageData(toDisk: data, forKey: key.diskCacheKey)
+        }
+    }
+    
+    /// Removes all variants from memory, the disk cache is left alone.
+    func removeAllMemoryImages() {
+        self.lock.lock()
+        self.memoryEntries.removeAll()
+        self.newestEntry = nil
+        self.oldestEntry = nil
+        self.memoryCost = 0
+        self.lock.unlock()
+    }
+    
+    @objc fileprivate func didReceiveMemoryWarning(_ notification: Notification) {
+        self.removeAllMemoryImages()
+    }
+    
+    // MARK: - Memory tier
+    
+    /// The number of bytes the decoded image uses.
+    class func cost(of image: UIImage) -> Int {
+        if let cgImage = image.cgImage {
+            return cgImage.bytesPerRow * cgImage.height
+        }
+        return Int(image.size.width * image.scale * image.size.height * image.scale) * 4
+    }
+    
+    /// Inserts the image as the most recently used entry and removes the least recently used entries that no longer fit the budget. Should be called with the lock held.
+    fileprivate func insert(_ image: UIImage, for key: ImageVariantKey) {
+        if let existingEntry = self.memoryEntries[key] {
+            self.unlink(existingEntry)
+            self.memoryCost -= existingEntry.cost
+        }
+        let cost = ImageVariantCache.cost(of: image)
+        guard cost <= self.memoryBudget else {
+            self.memoryEntries.removeValue(forKey: key)
+            return
+        }
+        let entry = MemoryEntry(key: key, image: image, cost: cost)
+        self.memoryEntries[key] = entry
+        self.linkAtFront(entry)
+        self.memoryCost += cost
+        
+        while self.memoryCost > self.memoryBudget, let oldestEntry = self.oldestEntry {
+            self.unlink(oldestEntry)
+            self.memoryEntries.removeValue(forKey: oldestEntry.key)
+            self.memoryCost -= oldestEntry.cost
+        }
+    }
+    
+    fileprivate func moveToFront(_ entry: MemoryEntry) {
+        guard self.newestEntry !== entry else {
+            return
+        }
+        self.unlink(entry)
+        self.linkAtFront(entry)
+    }
+    
+    fileprivate func linkAtFront(_ entry: MemoryEntry) {
+        entry.newer = nil
+        entry.older = self.newestEntry
+        self.newestEntry?.newer = entry
+        self.newestEntry = entry
+        if self.oldestEntry == nil {
+            self.oldestEntry = entry
+        }
+    }
+    
+    fileprivate func unlink(_ entry: MemoryEntry) {
+        entry.newer?.older = entry.older
+        entry.older?.newer = entry.newer
+        if self.newestEntry === entry {
+            self.newestEntry = entry.older
+        }
+        if self.oldestEntry === entry {
+            self.oldestEntry = entry.newer
+        }
+        entry.newer = nil
+        entry.older = nil
+    }
+    
+}
+
+private final class MemoryEntry {
+    
+    let key: ImageVariantKey
+    let image: UIImage
+    let cost: Int
+    
+    weak var newer: MemoryEntry?
+    var older: MemoryEntry?
+    
+    init(key: ImageVariantKey, image: UIImage, cost: Int) {
+        self.key = key
+        self.image = image
+        self.cost = cost
+    }
+    
+}
@@ -0,0 +1,341 @@
+//
+//  LoopingVideoCache.swift
+//  Beam
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import UIKit
+import AVFoundation
+import MobileCoreServices
+
+/// Keeps the short looping videos of animated gifs on disk, so a gif that scrolls on screen again doesn't have to be downloaded again.
+///
+/// The videos are served to AVFoundation through a resource loader. A video that isn't cached is downloaded once, and the player gets the bytes while they arrive. When the download finishes the video is written to the cache. The least recently played videos are removed when the cache exceeds its byte budget.
+final class LoopingVideoCache: NSObject {
+    
+    struct Statistics: CustomStringConvertible {
+        var hits = 0
+        var misses = 0
+        /// The number of bytes downloaded for videos that were not cached.
+        var downloadedByteCount: Int64 = 0
+        /// The number of bytes the cached videos use.
+        var diskSize: Int64 = 0
+        
+        var description: String {
+            let formatter = ByteCountFormatter()
+            return "Looping videos: \(self.hits) hits, \(self.misses) misses, downloaded \(formatter.string(fromByteCount: self.downloadedByteCount)), cache \(formatter.string(fromByteCount: self.diskSize))"
+        }
+    }
+    
+    static let shared = LoopingVideoCache(directoryURL: FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask)[0].appendingPathComponent("LoopingVideos"), byteBudget: 150 * 1024 * 1024)
+    
+    /// The scheme the assets use instead of https, so AVFoundation asks the cache for the bytes.
+    fileprivate static let scheme = "beam-looping-video"
+    
+    /// The maximum number of bytes the cached videos can use.
+    let byteBudget: Int64
+    
+    /// Videos larger than this are played, but not cached. Looping gifs are a few megabytes at most.
+    var maximumFileSize: Int64 = 20 * 1024 * 1024
+    
+    fileprivate let directoryURL: URL
+    
+    /// The cached videos by the file name of their URL. Only used on the queue.
+    fileprivate var cachedFiles: [String: CachedFile]?
+    
+    /// The downloads by the URL of the video. Only used on the queue.
+    fileprivate var downloads = [URL: VideoDownload]()
+    
+    fileprivate var currentStatistics = Statistics()
+    
+    /// The queue the resource loader, the downloads and the cache use.
+    fileprivate let queue = DispatchQueue(label: "com.madeawkward.beam.looping-video-cache", qos: .userInitiated)
+    
+    fileprivate lazy var urlSession: URLSession = {
+        let delegateQueue = OperationQueue()
+        delegateQueue.underlyingQueue = self.queue
+        delegateQueue.maxConcurrentOperationCount = 1
+        return URLSession(configuration: .default, delegate: self, delegateQueue: delegateQueue)
+    }()
+    
+    init(directoryURL: URL, byteBudget: Int64) {
+        self.directoryURL = directoryURL
+        self.byteBudget = byteBudget
+        super.init()
+    }
+    
+    var statistics: Statistics {
+        return self.queue.sync {
+            return self.currentStatistics
+        }
+    }
+    
+    // MARK: - Assets
+    
+    /// Returns an asset that plays the video from the cache, or downloads it into the cache while it plays.
+    func asset(for url: URL) -> AVURLAsset {
+        guard url.scheme == "https", var components = URLComponents(url: url, resolvingAgainstBaseURL: false) else {
+            return AVURLAsset(url: url)
+        }
+        components.scheme = LoopingVideoCache.scheme
+        let asset = AVURLAsset(url: components.url!)
+        asset.resourceLoader.setDelegate(self, queue: self.queue)
+        return asset
+    }
+    
+    fileprivate class func videoURL(for assetURL: URL) -> URL? {
+        guard assetURL.scheme == LoopingVideoCache.scheme, var components = URLComponents(url: assetURL, resolvingAgainstBaseURL: false) else {
+            return nil
+        }
+        components.scheme = "https"
+        return components.url
+    }
+    
+    // MARK: - Cache
+    
+    /// The name of the file the video is cached in, without the extension.
+    fileprivate class func fileName(for url: URL) -> String {
+        // FNV-1a, the hash value of a String isn't stable between launches
+        var hash: UInt64 = 0xcbf29ce484222325
+        for byte in url.absoluteString.utf8 {
+            hash = (hash ^ UInt64(byte)) &* 0x100000001b3
+        }
+        return String(hash, radix: 16)
+    }
+    
+    /// Reads the cached files from disk the first time. Should be called on the queue.
+    fileprivate func loadCachedFiles() -> [String: CachedFile] {
+        if let cachedFiles = self.cachedFiles {
+            return cachedFiles
+        }
+        var cachedFiles = [String: CachedFile]()
+        let keys: [URLResourceKey] = [.fileSizeKey, .contentModificationDateKey]
+        let fileURLs = (try? FileManager.default.contentsOfDirectory(at: self.directoryURL, includingPropertiesForKeys: keys, options: .skipsHiddenFiles)) ?? []
+        for fileURL in fileURLs {
+            let values = try? fileURL.resourceValues(forKeys: Set(keys))
+            let name = fileURL.deletingPathExtension().lastPathComponent
+            cachedFiles[name] = CachedFile(fileURL: fileURL, size: Int64(values?.fileSize ?? 0), lastAccessDate: values?.contentModificationDate ?? Date.distantPast)
+        }
+        self.cachedFiles = cachedFiles
+        self.currentStatistics.diskSize = cachedFiles.values.reduce(0) { $0 + $1.size }
+        return cachedFiles
+    }
+    
+    /// Returns the cached video and marks it as recently used. Should be called on the queue.
+    fileprivate func cachedFile(for url: URL) -> CachedFile? {
+        let name = LoopingVideoCache.fileName(for: url)
+        guard var cachedFile = self.loadCachedFiles()[name] else {
+            return nil
+        }
+        cachedFile.lastAccessDate = Date()
+        self.cachedFiles?[name] = cachedFile
+        // The modification date keeps the order of use across launches
+        try? FileManager.default.setAttributes([.modificationDate: cachedFile.lastAccessDate], ofItemAtPath: cachedFile.fileURL.path)
+        return cachedFile
+    }
+    
+    /// Writes the downloaded video to the cache and removes the least recently used videos that no longer fit. Should be called on the queue.
+    fileprivate func store(_ data: Data, contentType: String, for url: URL) {
+        guard Int64(data.count) <= self.maximumFileSize else {
+            return
+        }
+        var cachedFiles = self.loadCachedFiles()
+        let name = LoopingVideoCache.fileName(for: url)
+        let pathExtension = UTTypeCopyPreferredTagWithClass(contentType as CFString, kUTTagClassFilenameExtension)?.takeRetainedValue() as String? ?? "mp4"
+        let fileURL = self.directoryURL.appendingPathComponent(name).appendingPathExtension(pathExtension)
+        do {
+            try FileManager.default.createDirectory(at: self.directoryURL, withIntermediateDirectories: true, attributes: nil)
+            try data.write(to: fileURL, options: .atomic)
+        } catch {
+            AWKDebugLog("Failed to cache looping video: %@", (error as NSError))
+            return
+        }
+        cachedFiles[name] = CachedFile(fileURL: fileURL, size: Int64(data.count), lastAccessDate: Date())
+        
+        var diskSize = cachedFiles.values.reduce(0) { $0 + $1.size }
+        for (oldestName, oldestFile) in cachedFiles.sorted(by: { $0.value.lastAccessDate < $1.value.lastAccessDate }) where diskSize > self.byteBudget && oldestName != name {
+            try? FileManager.default.removeItem(at: oldestFile.fileURL)
+            cachedFiles.removeValue(forKey: oldestName)
+            diskSize -= oldestFile.size
+        }
+        self.cachedFiles = cachedFiles
+        self.currentStatistics.diskSize = diskSize
+    }
+    
+    /// Removes all cached videos.
+    func removeAllVideos() {
+        self.queue.async {
+            try? FileManager.default.removeItem(at: self.directoryURL)
+            self.cachedFiles = [:]
+            self.currentStatistics.diskSize = 0
+        }
+    }
+    
+    // MARK: - Loading requests
+    
+    /// Answers the loading requests with the bytes that are available, and finishes the requests that have all their bytes.
+    fileprivate func respond(to loadingRequests: [AVAssetResourceLoadingRequest], data: Data, contentType: String?, contentLength: Int64?, isComplete: Bool) -> [AVAssetResourceLoadingRequest] {
+        var remainingRequests = [AVAssetResourceLoadingRequest]()
+        for loadingRequest in loadingRequests {
+            if let informationRequest = loadingRequest.contentInformationRequest, let contentLength = contentLength {
+                informationRequest.contentType = contentType
+                informationRequest.contentLength = contentLength
+                informationRequest.isByteRangeAccessSupported = true
+            }
+            guard let dataRequest = loadingRequest.dataRequest else {
+                if contentLength != nil {
+                    loadingRequest.finishLoading()
+                } else {
+                    remainingRequests.append(loadingRequest)
+                }
+                continue
+            }
+            
+            let endOffset = dataRequest.requestsAllDataToEndOfResource ? Int64.max : dataRequest.requestedOffset + Int64(dataRequest.requestedLength)
+            let availableEndOffset = min(endOffset, Int64(data.count))
+            if dataRequest.currentOffset < availableEndOffset {
+                dataRequest.respond(with: data.subdata(in: Int(dataRequest.currentOffset)..<Int(availableEndOffset)))
+            }
+            if dataRequest.currentOffset >= endOffset || (isComplete && dataRequest.currentOffset >= Int64(data.count)) {
+                loadingRequest.finishLoading()
+            } else {
+                remainingRequests.append(loadingRequest)
+            }
+        }
+        return remainingRequests
+    }
+    
+    fileprivate class func contentType(for fileURL: URL) -> String {
+        return UTTypeCreatePreferredIdentifierForTag(kUTTagClassFilenameExtension, fileURL.pathExtension as CFString, nil)?.takeRetainedValue() as String? ?? AVFileType.mp4.rawValue
+    }
+    
+}
+
+// MARK: - AVAssetResourceLoaderDelegate
+
+extension LoopingVideoCache: AVAssetResourceLoaderDelegate {
+    
+    func resourceLoader(_ resourceLoader: AVAssetResourceLoader, shouldWaitForLoadingOfRequestedResource loadingRequest: AVAssetResourceLoadingRequest) -> Bool {
+        guard let assetURL = loadingRequest.request.url, let url = LoopingVideoCache.videoURL(for: assetURL) else {
+            return false
+        }
+        if let download = self.downloads[url] {
+            download.loadingRequests.append(loadingRequest)
+            download.loadingRequests = self.respond(to: download.loadingRequests, data: download.data, contentType: download.contentType, contentLength: download.contentLength, isComplete: false)
+            return true
+        }
+        if let cachedFile = self.cachedFile(for: url), let data = try? Data(contentsOf: cachedFile.fileURL, options: .mappedIfSafe) {
+            if loadingRequest.contentInformationRequest != nil {
+                self.currentStatistics.hits += 1
+            }
+            _ = self.respond(to: [loadingRequest], data: data, contentType: LoopingVideoCache.contentType(for: cachedFile.fileURL), contentLength: Int64(data.count), isComplete: true)
+            return true
+        }
+        
+        self.currentStatistics.misses += 1
+        let task = self.urlSession.dataTask(with: url)
+        let download = VideoDownload(url: url, task: task)
+        download.loadingRequests.append(loadingRequest)
+        self.downloads[url] = download
+        task.resume()
+        return true
+    }
+    
+    func resourceLoader(_ resourceLoader: AVAssetResourceLoader, didCancel loadingRequest: AVAssetResourceLoadingRequest) {
+        guard let assetURL = loadingRequest.request.url, let url = LoopingVideoCache.videoURL(for: assetURL), let download = self.downloads[url] else {
+            return
+        }
+        download.loadingRequests.removeAll(where: { $0 === loadingRequest })
+        if download.loadingRequests.isEmpty && download.contentLength.map({ Int64(download.data.count) < $0 / 2 }) ?? true {
+            // Nobody is waiting for the video, and finishing it would cost more than it saves
+            self.downloads.removeValue(forKey: url)
+            download.task.cancel()
+        }
+    }
+    
+}
+
+// MARK: - URLSessionDataDelegate
+
+extension LoopingVideoCache: URLSessionDataDelegate {
+    
+    func urlSession(_ session: URLSession, dataTask: URLSessionDataTask, didReceive response: URLResponse, completionHandler: @escaping (URLSession.ResponseDisposition) -> Void) {
+        guard let download = self.download(for: dataTask), let httpResponse = response as? HTTPURLResponse, httpResponse.statusCode == 200 else {
+            completionHandler(.cancel)
+            return
+        }
+        if let mimeType = httpResponse.mimeType, let contentType = UTTypeCreatePreferredIdentifierForTag(kUTTagClassMIMEType, mimeType as CFString, nil)?.takeRetainedValue() as String? {
+            download.contentType = contentType
+        } else {
+            download.contentType = AVFileType.mp4.rawValue
+        }
+        if httpResponse.expectedContentLength > 0 {
+            download.contentLength = httpResponse.expectedContentLength
+            download.data.reserveCapacity(Int(min(httpResponse.expectedContentLength, self.maximumFileSize)))
+        }
+        completionHandler(.allow)
+    }
+    
+    func urlSession(_ session: URLSession, dataTask: URLSessionDataTask, didReceive data: Data) {
+        guard let download = self.download(for: dataTask) else {
+            return
+        }
+        download.data.append(data)
+        self.currentStatistics.downloadedByteCount += Int64(data.count)
+        download.loadingRequests = self.respond(to: download.loadingRequests, data: download.data, contentType: download.contentType, contentLength: download.contentLength, isComplete: false)
+    }
+    
+    func urlSession(_ session: URLSession, task: URLSessionTask, didCompleteWithError error: Error?) {
+        guard let download = self.download(for: task) else {
+            return
+        }
+        self.downloads.removeValue(forKey: download.url)
+        
+        if let error = error {
+            for loadingRequest in download.loadingRequests {
+                loadingRequest.finishLoading(with: error)
+            }
+            return
+        }
+        let contentType = download.contentType ?? AVFileType.mp4.rawValue
+        _ = self.respond(to: download.loadingRequests, data: download.data, contentType: contentType, contentLength: Int64(download.data.count), isComplete: true)
+        self.store(download.data, contentType: contentType, for: download.url)
+    }
+    
+    fileprivate func download(for task: URLSessionTask) -> VideoDownload? {
+        guard let url = task.originalRequest?.url, let download = self.downloads[url], download.task === task else {
+            return nil
+        }
+        return download
+    }
+    
+}
+
+private struct CachedFile {
+    
+    let fileURL: URL
+    let size: Int64
+    var lastAccessDate: Date
+    
+}
+
+/// A video that is being downloaded, and the loading requests that wait for its bytes.
+private final class VideoDownload {
+    
+    let url: URL
+    let task: URLSessionDataTask
+    
+    var data = Data()
+    var contentType: String?
+    var contentLength: Int64?
+    
+    var loadingRequests = [AVAssetResourceLoadingRequest]()
+    
+    init(url: URL, task: URLSessionDataTask) {
+        self.url = url
+        self.task = task
+    }
+    
+}
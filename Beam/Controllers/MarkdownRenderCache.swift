@@ -0,0 +1,245 @@
+//
+//  MarkdownRenderCache.swift
+//  Beam
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import UIKit
+import Snoo
+import RedditMarkdownKit
+import TTTAttributedLabel
+
+/// The stylesheets markdown is shown with in Beam.
+enum MarkdownRenderStyle: Hashable {
+    /// Comments, also when they are shown in the stream.
+    case comments
+    /// The text of a self post or the description of a subreddit.
+    case selfPost
+    /// Text in one of the styles of MarkdownStylesheet.beamStyleSheet, like messages and the summary of a self post.
+    case textStyle(UIFont.TextStyle)
+    
+    /// Creates the stylesheet of the style. The stylesheets depend on the font size of the app, so this should be called on the main thread.
+    func stylesheet(darkmode: Bool) -> MarkdownStylesheet {
+        switch self {
+        case .comments:
+            return MarkdownStylesheet.beamCommentsStyleSheet(darkmode)
+        case .selfPost:
+            return MarkdownStylesheet.beamSelfPostStyleSheet(darkmode)
+        case .textStyle(let textStyle):
+            return MarkdownStylesheet.beamStyleSheet(textStyle, darkmode: darkmode)
+        }
+    }
+    
+}
+
+/// The width and number of lines text is laid out with.
+struct MarkdownLayout: Hashable {
+    let width: CGFloat
+    let numberOfLines: Int
+}
+
+/// Markdown rendered with a stylesheet, together with the sizes the text has been measured at.
+final class RenderedMarkdown {
+    
+    let attributedString: NSAttributedString
+    
+    let style: MarkdownRenderStyle
+    
+    fileprivate var sizes = [MarkdownLayout: CGSize]()
+    
+    fileprivate let lock = NSLock()
+    
+    init(attributedString: NSAttributedString, style: MarkdownRenderStyle) {
+        self.attributedString = attributedString
+        self.style = style
+    }
+    
+    /// Returns the size of the text when it's laid out in the width, like TTTAttributedLabel would measure it. The text is only measured the first time a width is asked for, this can be called on any thread.
+    func size(fittingWidth width: CGFloat, numberOfLines: Int) -> CGSize {
+        let key = MarkdownLayout(width: width, numberOfLines: numberOfLines)
+        self.lock.lock()
+        if let size = self.sizes[key] {
+            self.lock.unlock()
+            return size
+        }
+        self.lock.unlock()
+        
+        let size = TTTAttributedLabel.sizeThatFitsAttributedString(self.attributedString, withConstraints: CGSize(width: width, height: CGFloat.greatestFiniteMagnitude), limitedToNumberOfLines: UInt(max(numberOfLines, 0)))
+        self.lock.lock()
+        self.sizes[key] = size
+        self.lock.unlock()
+        return size
+    }
+    
+}
+
+/// Caches markdown rendered as attributed strings, together with the size of the text per layout, by the content, the style and the appearance.
+///
+/// Cells take the rendered markdown from this cache instead of applying a stylesheet every time they are configured. The cache is filled in advance by the MarkdownParsingOperation, for the styles and layouts that have been shown before. It is emptied when the font size or the night mode setting changes.
+final class MarkdownRenderCache {
+    
+    static let shared = MarkdownRenderCache()
+    
+    /// The maximum number of layouts that are remembered per style.
+    fileprivate static let maximumLayoutCount = 4
+    
+    /// The stylesheet a style was last shown with and the layouts of its labels, so markdown can be rendered and measured in advance.
+    fileprivate struct StyleState {
+        var darkmode: Bool
+        var stylesheet: MarkdownStylesheet
+        var layouts = [MarkdownLayout]()
+    }
+    
+    fileprivate let renderedMarkdown = NSCache<NSString, RenderedMarkdown>()
+    
+    fileprivate var styleStates = [MarkdownRenderStyle: StyleState]()
+    
+    fileprivate let lock = NSLock()
+    
+    init() {
+        self.renderedMarkdown.countLimit = 2000
+        NotificationCenter.default.addObserver(self, selector: #selector(MarkdownRenderCache.fontSizeCategoryDidChange(_:)), name: .FontSizeCategoryDidChange, object: nil)
+        NotificationCenter.default.addObserver(self, selector: #selector(MarkdownRenderCache.userSettingDidChange(_:)), name: .SettingsDidChangeSetting, object: nil)
+    }
+    
+    deinit {
+        NotificationCenter.default.removeObserver(self)
+    }
+    
+    // MARK: - Rendering
+    
+    /// Returns the markdown of the content rendered in the style. Should be called on the main thread.
+    func renderedMarkdown(for content: Content, style: MarkdownRenderStyle, darkmode: Bool) -> RenderedMarkdown? {
+        guard let text = content.content else {
+            return nil
+        }
+        return self.renderedMarkdown(identity: MarkdownRenderCache.identity(of: content), text: text, style: style, darkmode: darkmode, markdownString: { content.markdownString })
+    }
+    
+    /// Returns the description of the subreddit rendered in the style. Should be called on the main thread.
+    func renderedMarkdown(for subreddit: Subreddit, style: MarkdownRenderStyle, darkmode: Bool) -> RenderedMarkdown? {
+        guard let text = subreddit.descriptionText else {
+            return nil
+        }
+        return self.renderedMarkdown(identity: subreddit.identifier.map { "Subreddit-\($0)" }, text: text, style: style, darkmode: darkmode, markdownString: { subreddit.descriptionTextMarkdownString })
+    }
+    
+    /// Identifies the content in the cache, together with its text. Nil if the content doesn't have an identifier yet.
+    static func identity(of content: Content) -> String? {
+        guard let identifier = content.identifier else {
+            return nil
+        }
+        return "\(content.entity.name ?? "")-\(identifier)"
+    }
+    
+    fileprivate func renderedMarkdown(identity: String?, text: String, style: MarkdownRenderStyle, darkmode: Bool, markdownString: () -> MarkdownString?) -> RenderedMarkdown? {
+        let key = identity.map { self.cacheKey(identity: $0, text: text, style: style, darkmode: darkmode) }
+        if let key = key, let renderedMarkdown = self.renderedMarkdown.object(forKey: key) {
+            return renderedMarkdown
+        }
+        guard let attributedString = markdownString()?.attributedStringWithStylesheet(self.stylesheet(for: style, darkmode: darkmode)) else {
+            return nil
+        }
+        let renderedMarkdown = RenderedMarkdown(attributedString: attributedString, style: style)
+        if let key = key {
+            self.renderedMarkdown.setObject(renderedMarkdown, forKey: key)
+        }
+        return renderedMarkdown
+    }
+    
+    /// Returns the stylesheet of the style and remembers it for rendering in advance.
+    fileprivate func stylesheet(for style: MarkdownRenderStyle, darkmode: Bool) -> MarkdownStylesheet {
+        self.lock.lock()
+        if let state = self.styleStates[style], state.darkmode == darkmode {
+            self.lock.unlock()
+            return state.stylesheet
+        }
+        self.lock.unlock()
+        
+        let stylesheet = style.stylesheet(darkmode: darkmode)
+        self.lock.lock()
+        self.styleStates[style] = StyleState(darkmode: darkmode, stylesheet: stylesheet, layouts: self.styleStates[style]?.layouts ?? [])
+        self.lock.unlock()
+        return stylesheet
+    }
+    
+    fileprivate func cacheKey(identity: String, text: String, style: MarkdownRenderStyle, darkmode: Bool) -> NSString {
+        // The text is part of the key, so edited content is rendered again
+        return "\(style)-\(darkmode ? "dark" : "light")-\(identity)-\(text.hashValue)" as NSString
+    }
+    
+    // MARK: - Layout
+    
+    /// Remembers the layout of a label that shows markdown in the style, rendering in advance measures the text in the same layouts.
+    func didLayout(_ style: MarkdownRenderStyle, layout: MarkdownLayout) {
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        guard var state = self.styleStates[style], state.layouts.first != layout else {
+            return
+        }
+        state.layouts.removeAll(where: { $0 == layout })
+        state.layouts.insert(layout, at: 0)
+        state.layouts = Array(state.layouts.prefix(MarkdownRenderCache.maximumLayoutCount))
+        self.styleStates[style] = state
+    }
+    
+    // MARK: - Rendering in advance
+    
+    /// Renders and measures the markdown in the styles, for the appearance and layouts the styles were last shown with. Styles that have not been shown yet are skipped. This can be called on any thread.
+    ///
+    /// - Parameters:
+    ///   - items: The identity and the text of the content, with the parsed markdown of the text.
+    ///   - styles: The styles to render the markdown in.
+    ///   - isCancelled: Called between items to stop rendering early.
+    func prerender(_ items: [(identity: String, text: String, markdownString: MarkdownString)], styles: [MarkdownRenderStyle], isCancelled: () -> Bool = { false }) {
+        self.lock.lock()
+        let states = styles.compactMap { (style) -> (style: MarkdownRenderStyle, state: StyleState)? in
+            return self.styleStates[style].map { (style, $0) }
+        }
+        self.lock.unlock()
+        
+        for item in items {
+            guard !isCancelled() else {
+                return
+            }
+            for (style, state) in states {
+                let key = self.cacheKey(identity: item.identity, text: item.text, style: style, darkmode: state.darkmode)
+                let renderedMarkdown: RenderedMarkdown
+                if let existingRenderedMarkdown = self.renderedMarkdown.object(forKey: key) {
+                    renderedMarkdown = existingRenderedMarkdown
+                } else {
+                    renderedMarkdown = RenderedMarkdown(attributedString: item.markdownString.attributedStringWithStylesheet(state.stylesheet), style: style)
+                    self.renderedMarkdown.setObject(renderedMarkdown, forKey: key)
+                }
+                for layout in state.layouts {
+                    _ = renderedMarkdown.size(fittingWidth: layout.width, numberOfLines: layout.numberOfLines)
+                }
+            }
+        }
+    }
+    
+    // MARK: - Invalidation
+    
+    func removeAll() {
+        self.lock.lock()
+        self.styleStates.removeAll()
+        self.lock.unlock()
+        self.renderedMarkdown.removeAllObjects()
+    }
+    
+    @objc fileprivate func fontSizeCategoryDidChange(_ notification: Notification) {
+        self.removeAll()
+    }
+    
+    @objc fileprivate func userSettingDidChange(_ notification: Notification) {
+        guard notification.object as? SettingsKey == SettingsKeys.nightModeEnabled || notification.object as? SettingsKey == SettingsKeys.nightModeAutomaticEnabled else {
+            return
+        }
+        self.removeAll()
+    }
+    
+}
@@ -61,6 +61,7 @@ class SubredditMediaCollectionController: NSObject {
         query.sortType = sorting
         query.timeFrame = timeFrame
         query.hideNSFWContent = !AppDelegate.shared.authenticationController.userCanViewNSFWContent
+        query.contentFilter = self.subreddit?.contentFilter
         self.query = query
         self.reloadMedia()
     }
@@ -99,6 +100,7 @@ class SubredditMediaCollectionController: NSObject {
         query.sortType = .hot
         query.timeFrame = .thisMonth
         query.hideNSFWContent = !AppDelegate.shared.authenticationController.userCanViewNSFWContent
+        query.contentFilter = subreddit.contentFilter
         self.collectionController = CollectionController(authentication: AppDelegate.shared.authenticationController, context: AppDelegate.shared.managedObjectContext)
         super.init()
         self.query = query
@@ -0,0 +1,209 @@
+//
+//  VideoPlayerPool.swift
+//  Beam
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import UIKit
+import AVFoundation
+
+/// An object that shows the video of a pooled player, like a `GIFPlayerView`.
+protocol VideoPlayerPoolOwner: AnyObject {
+    
+    /// Called when the pool gives the player of the owner to another owner. The owner should stop showing the player.
+    func videoPlayerPool(_ pool: VideoPlayerPool, didReclaim player: PooledVideoPlayer)
+    
+}
+
+/// A muted player that loops a single video.
+final class PooledVideoPlayer {
+    
+    let player: AVQueuePlayer
+    
+    /// The URL of the video the player loops.
+    fileprivate(set) var url: URL?
+    
+    /// The view that shows the player, nil if the player is idle.
+    fileprivate(set) weak var owner: VideoPlayerPoolOwner?
+    
+    /// The asset of the video, shared by the items the looper plays.
+    fileprivate var asset: AVAsset?
+    
+    /// The looper stops looping when it is released.
+    fileprivate var looper: AVPlayerLooper?
+    
+    fileprivate var lastUseDate = Date()
+    
+    fileprivate init() {
+        self.player = AVQueuePlayer()
+        self.player.isMuted = true
+        // The videos are downloaded by the looping video cache, it doesn't need to wait for a buffer
+        self.player.automaticallyWaitsToMinimizeStalling = false
+    }
+    
+    fileprivate func load(_ url: URL) {
+        guard self.url != url else {
+            return
+        }
+        self.unload()
+        self.url = url
+        let asset = LoopingVideoCache.shared.asset(for: url)
+        self.asset = asset
+        let item = AVPlayerItem(asset: asset)
+        self.looper = AVPlayerLooper(player: self.player, templateItem: item)
+    }
+    
+    fileprivate func unload() {
+        self.player.pause()
+        self.looper?.disableLooping()
+        self.looper = nil
+        self.player.removeAllItems()
+        self.asset = nil
+        self.url = nil
+    }
+    
+}
+
+/// Shares a small number of players between the gif cells.
+///
+/// Creating a player, and an `AVPlayerLayer` for it, for every cell that scrolls on screen makes scrolling stutter. The pool keeps about as many players as there are gifs visible at once. A player that is released keeps its video, so a gif that scrolls back on screen, or a gif that was prerolled before it became visible, starts playing without loading. The videos themselves are kept on disk by the `LoopingVideoCache`.
+final class VideoPlayerPool {
+    
+    static let shared = VideoPlayerPool()
+    
+    /// The number of gifs that can play at the same time. The pool keeps one more player, for the gif that is prerolled.
+    var visibleSlotCount = 2 {
+        didSet {
+            self.trimIdlePlayers()
+        }
+    }
+    
+    var maximumPlayerCount: Int {
+        return max(1, self.visibleSlotCount) + 1
+    }
+    
+    fileprivate var players = [PooledVideoPlayer]()
+    
+    init() {
+        NotificationCenter.default.addObserver(self, selector: #selector(VideoPlayerPool.didReceiveMemoryWarning(_:)), name: UIApplication.didReceiveMemoryWarningNotification, object: nil)
+    }
+    
+    // MARK: - Players
+    
+    /// Returns a player that loops the video for the owner. Should be called on the main thread.
+    ///
+    /// A player that already has the video is used first. If the pool is full, the least recently used idle player is given the video, or the player of another owner if all players are in use.
+    func player(for url: URL, owner: VideoPlayerPoolOwner) -> PooledVideoPlayer {
+        assert(Thread.isMainThread)
+        
+        let pooledPlayer: PooledVideoPlayer
+        if let ownedPlayer = self.players.first(where: { $0.owner === owner }), ownedPlayer.url == url {
+            pooledPlayer = ownedPlayer
+        } else {
+            if let ownedPlayer = self.players.first(where: { $0.owner === owner }) {
+                self.release(ownedPlayer, owner: owner)
+            }
+            pooledPlayer = self.availablePlayer(for: url)
+        }
+        
+        if let previousOwner = pooledPlayer.owner, previousOwner !== owner {
+            pooledPlayer.owner = nil
+            previousOwner.videoPlayerPool(self, didReclaim: pooledPlayer)
+        }
+        pooledPlayer.owner = owner
+        pooledPlayer.lastUseDate = Date()
+        pooledPlayer.load(url)
+        return pooledPlayer
+    }
+    
+    fileprivate func availablePlayer(for url: URL) -> PooledVideoPlayer {
+        let idlePlayers = self.players.filter { $0.owner == nil }
+        if let prerolledPlayer = idlePlayers.first(where: { $0.url == url }) {
+            return prerolledPlayer
+        }
+        if self.players.count < self.maximumPlayerCount {
+            let pooledPlayer = PooledVideoPlayer()
+            self.players.append(pooledPlayer)
+            return pooledPlayer
+        }
+        let candidates = idlePlayers.isEmpty ? self.players : idlePlayers
+        return candidates.min(by: { $0.lastUseDate < $1.lastUseDate })!
+    }
+    
+    /// Gives the player back to the pool. The player is paused, but keeps its video in case the same gif is shown again.
+    func release(_ pooledPlayer: PooledVideoPlayer, owner: VideoPlayerPoolOwner) {
+        assert(Thread.isMainThread)
+        guard pooledPlayer.owner === owner else {
+            return
+        }
+        pooledPlayer.owner = nil
+        pooledPlayer.lastUseDate = Date()
+        pooledPlayer.player.pause()
+        self.trimIdlePlayers()
+    }
+    
+    // MARK: - Prerolling
+    
+    /// Loads the video into an idle player, so it starts right away once its cell becomes visible. Nothing happens if there is no idle player to spare.
+    func preroll(_ url: URL) {
+        assert(Thread.isMainThread)
+        guard !self.players.contains(where: { $0.url == url }) else {
+            return
+        }
+        let idlePlayers = self.players.filter { $0.owner == nil }
+        let pooledPlayer: PooledVideoPlayer
+        if self.players.count < self.maximumPlayerCount {
+            pooledPlayer = PooledVideoPlayer()
+            self.players.append(pooledPlayer)
+        } else if let oldestPlayer = idlePlayers.min(by: { $0.lastUseDate < $1.lastUseDate }) {
+            pooledPlayer = oldestPlayer
+        } else {
+            return
+        }
+        pooledPlayer.lastUseDate = Date()
+        pooledPlayer.load(url)
+        
+        let player = pooledPlayer.player
+        // Loading the asset starts the download into the looping video cache
+        pooledPlayer.asset?.loadValuesAsynchronously(forKeys: ["playable"]) {
+            DispatchQueue.main.async {
+                guard pooledPlayer.url == url, pooledPlayer.owner == nil, player.status == .readyToPlay else {
+                    return
+                }
+                player.preroll(atRate: 1, completionHandler: nil)
+            }
+        }
+    }
+    
+    // MARK: - Trimming
+    
+    /// Removes the idle players that don't fit the pool anymore, the least recently used first.
+    fileprivate func trimIdlePlayers() {
+        var excessCount = self.players.count - self.maximumPlayerCount
+        guard excessCount > 0 else {
+            return
+        }
+        for pooledPlayer in self.players.filter({ $0.owner == nil }).sorted(by: { $0.lastUseDate < $1.lastUseDate }) where excessCount > 0 {
+            pooledPlayer.unload()
+            self.players.removeAll(where: { $0 === pooledPlayer })
+            excessCount -= 1
+        }
+    }
+    
+    /// Removes all idle players, the players that are visible keep playing.
+    func removeIdlePlayers() {
+        for pooledPlayer in self.players where pooledPlayer.owner == nil {
+            pooledPlayer.unload()
+        }
+        self.players.removeAll(where: { $0.owner == nil })
+    }
+    
+    @objc fileprivate func didReceiveMemoryWarning(_ notification: Notification) {
+        DispatchQueue.main.async {
+            self.removeIdlePlayers()
+        }
+    }
+    
+}
@@ -149,6 +149,7 @@ extension Content {
             thumbnail.pixelHeight = NSNumber(value: Float(spec.size.height))
             
             mediaObject.thumbnails = Set([thumbnail])
+            mediaObject.updateThumbnailLadder()
             
             return mediaObject
             
@@ -196,6 +197,7 @@ extension Content {
                     return thumbnail
                 })
                 object.thumbnails = Set(thumbnails)
+                object.updateThumbnailLadder()
                 
             }
         } catch {
@@ -224,9 +226,10 @@ extension Content {
             return
         }
         let thumbnail = Thumbnail(context: context)
-        thumbnail.mediaObject = object
+        object.addToThumbnails(thumbnail)
         thumbnail.url = thumbnailURL
         thumbnail.pixelSize = .zero
+        object.updateThumbnailLadder()
     }
     
 }
@@ -11,8 +11,9 @@ import Snoo
 
 extension MessageCollectionQuery {
 
-    public class func fetchUnreadMessages(_ completionHandler: @escaping (_ messages: [Message]?, _ error: Error?) -> Void) {
+    public class func fetchUnreadMessages(priority: RequestPriority = .visibleContent, _ completionHandler: @escaping (_ messages: [Message]?, _ error: Error?) -> Void) {
         let collectionController = CollectionController(authentication: AppDelegate.shared.authenticationController, context: AppDelegate.shared.managedObjectContext)
+        collectionController.priority = priority
         let query = MessageCollectionQuery()
         query.contentPredicate = NSPredicate(format: "unread == %@", NSNumber(value: true))
         collectionController.query = query
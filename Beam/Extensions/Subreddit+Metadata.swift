@@ -20,6 +20,9 @@ enum SubredditMetadataKey: String {
     case FilterSubreddits = "com.madeawkward.beam.subreddit.filtersubreddits"
 }
 
+/// The compiled content filters per subreddit, shared by all views of the subreddit.
+private let subredditContentFilters = NSCache<NSManagedObjectID, ContentFilter>()
+
 extension Subreddit {
 
     var streamSortType: CollectionSortType {
@@ -102,6 +105,7 @@ extension Subreddit {
             } else {
                 self.setMetadataValue(newValue!, forKey: SubredditMetadataKey.FilterKeywords.rawValue)
             }
+            subredditContentFilters.removeObject(forKey: self.objectID)
         }
     }
     
@@ -118,7 +122,24 @@ extension Subreddit {
             } else {
                 self.setMetadataValue(newValue!, forKey: SubredditMetadataKey.FilterSubreddits.rawValue)
             }
+            subredditContentFilters.removeObject(forKey: self.objectID)
+        }
+    }
+    
+    /// The filter for the filter keywords and subreddits, nil if nothing is filtered. The filter is only compiled again when the filter settings change.
+    var contentFilter: ContentFilter? {
+        let keywords = self.filterKeywords ?? [String]()
+        let subreddits = self.filterSubreddits ?? [String]()
+        guard keywords.count > 0 || subreddits.count > 0 else {
+            return nil
+        }
+        // The metadata might also have been changed in another context
+        if let contentFilter = subredditContentFilters.object(forKey: self.objectID), contentFilter.keywords == keywords, contentFilter.subreddits == subreddits {
+            return contentFilter
         }
+        let contentFilter = ContentFilter(keywords: keywords, subreddits: subreddits)
+        subredditContentFilters.setObject(contentFilter, forKey: self.objectID)
+        return contentFilter
     }
 
 }
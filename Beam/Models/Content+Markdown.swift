@@ -19,7 +19,7 @@ extension Content {
             if let markdownString = objc_getAssociatedObject(self, &ContentMarkdownStringAssociationKey) as? MarkdownString {
                 return markdownString
             } else if let content = content {
-                let newMarkdownString = MarkdownString(string: content)
+                let newMarkdownString = MarkdownStringCache.shared.markdownString(for: content, readsFromDisk: false)
                 self.markdownString = newMarkdownString
                 return newMarkdownString
             } else {
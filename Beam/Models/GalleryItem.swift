@@ -101,7 +101,7 @@ extension GalleryItem: AWKGalleryItem {
     }
     
     @objc var placeholderImage: UIImage? {
-        if let urlString = self.mediaObject?.thumbnailWithSize(UIScreen.main.bounds.size)?.url?.absoluteString {
+        if let urlString = self.mediaObject?.thumbnailURL(for: UIScreen.main.bounds.size)?.absoluteString {
             return SDImageCache.shared.imageFromDiskCache(forKey: urlString)
         }
         return nil
@@ -9,9 +9,29 @@
 import UIKit
 import Snoo
 import CoreData
+import RedditMarkdownKit
 
+/// Parses the markdown of all content in a collection before it is displayed. Content that has been parsed before is loaded from the MarkdownStringCache instead.
+///
+/// Parsing happens in three steps, so the object context is only blocked while reading and attaching:
+/// 1. The content strings are read on the queue of the object context.
+/// 2. The strings are parsed concurrently on all cores, outside of the object context.
+/// 3. The parsed MarkdownStrings are attached to the objects on the queue of the object context.
+///
+/// After parsing, the markdown is rendered in the render styles and stored in the MarkdownRenderCache, so the cells don't have to render it on the main thread.
 class MarkdownParsingOperation: DataOperation {
     
+    /// The number of strings a single concurrent iteration parses. Small comments are cheap, so batching them keeps the dispatch overhead low.
+    fileprivate static let batchSize = 8
+    
+    /// The styles the content of the collection will be shown in.
+    let renderStyles: [MarkdownRenderStyle]
+    
+    init(renderStyles: [MarkdownRenderStyle] = []) {
+        self.renderStyles = renderStyles
+        super.init()
+    }
+    
     var parsingOperation: CollectionParsingOperation? {
         return self.dependencies.first as? CollectionParsingOperation
     }
@@ -19,25 +39,74 @@ class MarkdownParsingOperation: DataOperation {
     override func start() {
         super.start()
         
-        self.parsingOperation?.objectContext.perform {
+        guard let objectContext = self.parsingOperation?.objectContext else {
+            self.finishOperation()
+            return
+        }
+        
+        objectContext.perform {
             guard self.isCancelled == false else {
                 self.finishOperation()
                 return
             }
-            if let contents = self.parsingOperation?.objectCollection?.objects?.array as? [Content] {
-                let comments = contents.filter { $0 is Comment } as! [Comment]
-                for comment in comments {
-                    _ = comment.markdownString
-                }
-                let posts = contents.filter { $0 is Post } as! [Post]
-                for post in posts {
-                    _ = post.markdownString
+            
+            // Comments first, they are usually the bulk of the content
+            let contents = (self.parsingOperation?.objectCollection?.objects?.array as? [Content]) ?? []
+            let parsableContents = contents.filter { $0 is Comment } + contents.filter { $0 is Post }
+            let items = parsableContents.compactMap { (content) -> (objectID: NSManagedObjectID, identity: String?, string: String)? in
+                guard let string = content.content else {
+                    return nil
                 }
+                return (content.objectID, MarkdownRenderCache.identity(of: content), string)
             }
-            self.finishOperation()
             
+            DispatchQueue.global(qos: .userInitiated).async {
+                let markdownStrings = self.parseConcurrently(items.map { $0.string })
+                
+                if !self.renderStyles.isEmpty {
+                    let renderItems = items.enumerated().compactMap { (index, item) -> (identity: String, text: String, markdownString: MarkdownString)? in
+                        guard let identity = item.identity, let markdownString = markdownStrings[index] else {
+                            return nil
+                        }
+                        return (identity, item.string, markdownString)
+                    }
+                    MarkdownRenderCache.shared.prerender(renderItems, styles: self.renderStyles, isCancelled: { self.isCancelled })
+                }
+                
+                objectContext.perform {
+                    if self.isCancelled == false {
+                        for (index, item) in items.enumerated() {
+                            guard let markdownString = markdownStrings[index], let content = objectContext.object(with: item.objectID) as? Content else {
+                                continue
+                            }
+                            content.markdownString = markdownString
+                        }
+                    }
+                    self.finishOperation()
+                }
+            }
         }
+    }
+    
+    /// Parses the strings on all available cores. Strings that were not parsed because the operation got cancelled are nil.
+    fileprivate func parseConcurrently(_ strings: [String]) -> [MarkdownString?] {
+        var markdownStrings = [MarkdownString?](repeating: nil, count: strings.count)
+        let batchCount = (strings.count + MarkdownParsingOperation.batchSize - 1) / MarkdownParsingOperation.batchSize
         
+        markdownStrings.withUnsafeMutableBufferPointer { (buffer) in
+            // Every iteration writes to its own range of the buffer, so no locking is needed
+            DispatchQueue.concurrentPerform(iterations: batchCount) { (batch) in
+                let start = batch * MarkdownParsingOperation.batchSize
+                let end = min(start + MarkdownParsingOperation.batchSize, strings.count)
+                for index in start..<end {
+                    guard self.isCancelled == false else {
+                        return
+                    }
+                    buffer[index] = MarkdownStringCache.shared.markdownString(for: strings[index])
+                }
+            }
+        }
+        return markdownStrings
     }
     
 }
@@ -19,7 +19,7 @@ extension Subreddit {
             if let markdownString = objc_getAssociatedObject(self, &SubredditMarkdownStringAssociationKey) as? MarkdownString {
                 return markdownString
             } else if let content = self.descriptionText {
-                let newMarkdownString = MarkdownString(string: content)
+                let newMarkdownString = MarkdownStringCache.shared.markdownString(for: content, readsFromDisk: false)
                 self.descriptionTextMarkdownString = newMarkdownString
                 return newMarkdownString
             } else {
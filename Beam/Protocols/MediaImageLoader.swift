@@ -31,44 +31,34 @@ protocol MediaImageLoader: class {
 extension MediaImageLoader {
     
     func mediaURLString() -> String? {
-        guard self.mediaObject != nil else {
+        guard let mediaObject = self.mediaObject else {
             return nil
         }
-        var mediaURLString: String?
-        AppDelegate.shared.managedObjectContext.performAndWait { () -> Void in
-            if let urlString = self.mediaObject?.thumbnailWithSize(self.preferredThumbnailSize)?.url?.absoluteString {
-                mediaURLString = urlString
-            } else if let url = self.mediaObject?.smallThumbnailURL {
-                mediaURLString = url.absoluteString
-            } else {
-                mediaURLString = self.mediaObject?.contentURL?.absoluteString
-            }
+        if let url = mediaObject.thumbnailURL(for: self.preferredThumbnailSize) {
+            return url.absoluteString
+        } else if let url = mediaObject.smallThumbnailURL {
+            return url.absoluteString
+        } else {
+            return mediaObject.contentURL?.absoluteString
         }
-        return mediaURLString
     }
     
     func startImageLoading() {
+        self.mediaImageView.image = nil
+        // Picking the thumbnail doesn't touch the store, so the URL is determined on the queue of the media object
+        let URLString = self.mediaURLString()
         DispatchQueue.global(qos: .userInitiated).async { [weak self] () -> Void in
-            self?.mediaImageView.image = nil
-            let URLString = self?.mediaURLString()
             if let URLString = URLString, let url = URL(string: URLString) {
-                if let cachedImage = SDImageCache.shared.imageFromDiskCache(forKey: URLString) {
-                    DispatchQueue.main.async(execute: { () -> Void in
-                        self?.mediaImageView.image = cachedImage
-                        self?.imageLoadingCompleted()
-                    })
-                } else {
-                    self?.imageOperation = AppDelegate.shared.imageLoader.startDownloadingImageWithURL(url, progressHandler: { [weak self] (totalBytesWritten, totalBytesExpectedToWrite) in
-                        let progress = CGFloat(totalBytesWritten) / CGFloat(totalBytesExpectedToWrite)
-                        self?.progressDidChange(progress)
-                        }, completionHandler: { [weak self] (image) in
-                            DispatchQueue.main.async(execute: { () -> Void in
-                                self?.mediaImageView.image = image
-                                self?.imageLoadingCompleted()
-                            })
-                    })
-                }
-                
+                // The loader returns the downscaled image from the variant cache if it is available, before downloading or decoding the original
+                self?.imageOperation = AppDelegate.shared.imageLoader.startDownloadingImageWithURL(url, progressHandler: { [weak self] (totalBytesWritten, totalBytesExpectedToWrite) in
+                    let progress = CGFloat(totalBytesWritten) / CGFloat(totalBytesExpectedToWrite)
+                    self?.progressDidChange(progress)
+                    }, completionHandler: { [weak self] (image) in
+                        DispatchQueue.main.async(execute: { () -> Void in
+                            self?.mediaImageView.image = image
+                            self?.imageLoadingCompleted()
+                        })
+                })
             } else {
                 self?.stopImageLoading()
             }
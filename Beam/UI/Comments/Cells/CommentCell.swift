@@ -86,7 +86,7 @@ class CommentCell: BaseCommentCell {
     @IBOutlet fileprivate weak var collapseIconImageView: UIImageView!
     
     @IBOutlet fileprivate weak var authorButton: BeamPlainButton!
-    @IBOutlet weak var contentLabel: TTTAttributedLabel!
+    @IBOutlet weak var contentLabel: MarkdownLabel!
     @IBOutlet fileprivate weak var metadataLabel: UILabel!
     @IBOutlet fileprivate weak var stickiedLabel: UILabel!
     @IBOutlet fileprivate weak var flairLabel: UILabel!
@@ -193,10 +193,6 @@ class CommentCell: BaseCommentCell {
         self.setNeedsUpdateConstraints()
     }
     
-    fileprivate var contentStylesheet: MarkdownStylesheet {
-        return MarkdownStylesheet.beamCommentsStyleSheet(self.userInterfaceStyle == .dark)
-    }
-    
     override func updateConstraints() {
         super.updateConstraints()
         self.commentContentViewLeadingConstraint.constant = self.contentView.bounds.width
@@ -260,11 +256,11 @@ class CommentCell: BaseCommentCell {
             self.contentLabel.activeLinkAttributes = TTTAttributedLabel.beamActiveLinkAttributesWithStyle(userInterfaceStyle)
             if let comment = comment, let contentString = comment.content {
                 if comment.markdownString == nil {
-                    comment.markdownString = MarkdownString(string: contentString.stringByTrimmingTrailingWhitespacesAndNewLines())
+                    comment.markdownString = MarkdownStringCache.shared.markdownString(for: contentString.stringByTrimmingTrailingWhitespacesAndNewLines(), readsFromDisk: false)
                 }
-                self.contentLabel.setText(comment.markdownString?.attributedStringWithStylesheet(self.contentStylesheet))
+                self.contentLabel.renderedMarkdown = MarkdownRenderCache.shared.renderedMarkdown(for: comment, style: .comments, darkmode: self.userInterfaceStyle == .dark)
             } else {
-                self.contentLabel.attributedText = nil
+                self.contentLabel.renderedMarkdown = nil
             }
         }
     }
@@ -195,9 +195,7 @@ extension CommentCellDelegate where Self: UITableViewController {
             return
         }
         
-        let oldVoteStatus = VoteStatus(rawValue: comment.voteStatus?.intValue ?? 0) ?? VoteStatus.neutral
-        comment.updateScore(direction, oldVoteStatus: oldVoteStatus)
-        comment.voteStatus = NSNumber(value: direction.rawValue)
+        UserActivityController.shared.vote(comment, direction: direction)
         direction.soundType.play()
         
         if #available(iOS 10, *), [VoteStatus.up, VoteStatus.down].contains(direction) {
@@ -205,22 +203,6 @@ extension CommentCellDelegate where Self: UITableViewController {
             feedbackGenerator.prepare()
             feedbackGenerator.selectionChanged()
         }
-        
-        let operation = comment.voteOperation(direction, authenticationController: AppDelegate.shared.authenticationController)
-        DataController.shared.executeAndSaveOperations([operation], context: AppDelegate.shared.managedObjectContext, handler: { (error: Error?) -> Void in
-            DispatchQueue.main.async(execute: { () -> Void in
-                if let error = error as NSError? {
-                    comment.updateScore(oldVoteStatus, oldVoteStatus: direction)
-                    comment.voteStatus = NSNumber(value: oldVoteStatus.rawValue)
-                    if error.code == NSURLErrorNotConnectedToInternet && error.domain == NSURLErrorDomain {
-                        self.commentCell(cell, didProduceErrorMessage: AWKLocalizedString("error-vote-internet"))
-                    } else {
-                        self.commentCell(cell, didProduceErrorMessage: AWKLocalizedString("error-vote"))
-                    }
-                }
-            })
-        })
-        
     }
     
     /// Scrolls to the given indexPath to the top of the tableView, only if it's not visible in tableView
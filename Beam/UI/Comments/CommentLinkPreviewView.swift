@@ -88,23 +88,7 @@ class CommentLinkPreviewView: BeamControl {
     }
     
     private func isCherryAcceptedImageLink(_ link: URL) -> Bool {
-        guard let imageUrlPatterns = AppDelegate.shared.cherryController.features?.imageURLPatterns else {
-            return false
-        }
-        var isImageLink = false
-        for pattern in imageUrlPatterns {
-            do {
-                let regex = try NSRegularExpression(pattern: pattern, options: [NSRegularExpression.Options.caseInsensitive])
-                guard let match = regex.firstMatch(in: link.absoluteString, options: [], range: NSRange(location: 0, length: (link.absoluteString as NSString).length)), match.numberOfRanges > 0 else {
-                    continue
-                }
-                isImageLink = true
-                break
-            } catch {
-                NSLog("Invalid image URL regular expression \(error)")
-            }
-        }
-        return isImageLink
+        return AppDelegate.shared.cherryController.imageURLMatcher?.matches(link.absoluteString) == true
     }
     
     var isLoading = false
@@ -167,7 +151,7 @@ class CommentLinkPreviewView: BeamControl {
                 }
             }
             
-            if let imageURL = mediaObject.thumbnailWithSize(self.thumbnailImageView.bounds.size)?.url {
+            if let imageURL = mediaObject.thumbnailURL(for: self.thumbnailImageView.bounds.size) {
                 self.thumbnailImageView.isHidden = false
                 self.thumbnailImageView.sd_setImage(with: imageURL)
             } else {
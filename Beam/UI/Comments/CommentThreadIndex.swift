@@ -0,0 +1,320 @@
+//
+//  CommentThreadIndex.swift
+//  Beam
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import Foundation
+import Snoo
+
+/// A flattened index of the comment rows of a CommentsDataSource. Every row knows its indentation, the thread it belongs to and the number of rows its replies span, so these don't have to be looked up by walking the parent chain.
+///
+/// Collapsing, expanding or inserting a comment only updates the rows of that comment and the spans of its parents, the other threads are left alone.
+final class CommentThreadIndex {
+    
+    fileprivate struct Entry {
+        /// The level of the comment in the tree, the first comment of a thread has level 1. Replies are shown up to the maximum depth.
+        let level: Int
+        /// The indentation of the comment, relative to the parent comment of the query.
+        let indentation: Int
+        /// The first comment in the parent chain of the comment.
+        let superParent: Comment
+        /// The first comment of the thread the row is shown in.
+        let threadComment: Comment
+        /// The comment the row is shown under, nil for the first row of a thread.
+        let parent: Comment?
+        /// If the row only continues the thread, because its parent is at the maximum depth.
+        let isContinueThreadRow: Bool
+        /// The number of rows directly after this row that show the replies of the comment.
+        var span: Int
+    }
+    
+    let maximumDepth: Int
+    
+    /// The parent comment of the query, the indentation of the comments is relative to this comment.
+    let parentComment: Comment?
+    
+    /// The comments of every thread, in the order they are shown. Nil after the index has been reset.
+    fileprivate(set) var threads: [[Comment]]? = [[Comment]]()
+    
+    /// The comments that are collapsed. Only the username of a collapsed comment is shown, its replies are hidden.
+    fileprivate(set) var collapsedComments = Set<Comment>()
+    
+    fileprivate var entries = [Comment: Entry]()
+    
+    /// The thread index of the first comment of every thread.
+    fileprivate var threadIndexes = [Comment: Int]()
+    
+    /// The row of every comment, per thread. Nil if rows of the thread have been inserted or removed since the last lookup.
+    fileprivate var rowIndexes = [[Comment: Int]?]()
+    
+    init(maximumDepth: Int, parentComment: Comment?) {
+        self.maximumDepth = maximumDepth
+        self.parentComment = parentComment
+    }
+    
+    // MARK: - Building
+    
+    /// Rebuilds all threads from the top level comments.
+    func rebuild(topLevelComments: [Comment]) {
+        self.entries.removeAll()
+        self.threads = topLevelComments.map { self.threadRows(for: $0) }
+        self.reindexThreads()
+    }
+    
+    /// Removes all threads, the collapsed comments are kept.
+    func reset() {
+        self.entries.removeAll()
+        self.threads = nil
+        self.reindexThreads()
+    }
+    
+    /// Updates the threads for changed top level comments. The rows of existing threads are reused, only new threads are built.
+    func updateTopLevelComments(_ topLevelComments: [Comment]) {
+        guard let threads = self.threads else {
+            self.rebuild(topLevelComments: topLevelComments)
+            return
+        }
+        
+        var updatedThreads = [[Comment]]()
+        updatedThreads.reserveCapacity(topLevelComments.count)
+        var keptThreadIndexes = Set<Int>()
+        for comment in topLevelComments {
+            if let threadIndex = self.threadIndexes[comment] {
+                updatedThreads.append(threads[threadIndex])
+                keptThreadIndexes.insert(threadIndex)
+            } else {
+                updatedThreads.append(self.threadRows(for: comment))
+            }
+        }
+        for (threadIndex, thread) in threads.enumerated() where !keptThreadIndexes.contains(threadIndex) {
+            for comment in thread {
+                self.entries.removeValue(forKey: comment)
+            }
+        }
+        self.threads = updatedThreads
+        self.reindexThreads()
+    }
+    
+    /// Rebuilds the rows of the replies of a comment, for example after the children of a "load more comments" row have been loaded.
+    func updateReplies(of comment: Comment) {
+        guard let entry = self.entries[comment] else {
+            return
+        }
+        self.removeReplyRows(of: comment)
+        self.insertReplyRows(of: comment, entry: entry)
+    }
+    
+    fileprivate func reindexThreads() {
+        self.threadIndexes.removeAll()
+        for (threadIndex, thread) in (self.threads ?? []).enumerated() {
+            if let threadComment = thread.first {
+                self.threadIndexes[threadComment] = threadIndex
+            }
+        }
+        self.rowIndexes = [[Comment: Int]?](repeating: nil, count: self.threads?.count ?? 0)
+    }
+    
+    /// Creates the rows of a thread and indexes them.
+    fileprivate func threadRows(for comment: Comment) -> [Comment] {
+        let entry = Entry(level: 1, indentation: self.walkIndentation(for: comment), superParent: self.walkSuperParent(for: comment), threadComment: comment, parent: nil, isContinueThreadRow: false, span: 0)
+        var rows = [comment]
+        self.entries[comment] = entry
+        let span = self.appendReplyRows(of: comment, entry: entry, to: &rows)
+        self.entries[comment]?.span = span
+        return rows
+    }
+    
+    /**
+     Appends the rows for the replies of the comment and indexes them. The replies of a collapsed comment are not shown. At the maximum depth only the first reply is shown, to continue the thread in a new view.
+     
+     - returns: The number of rows that were appended.
+     */
+    @discardableResult
+    fileprivate func appendReplyRows(of comment: Comment, entry: Entry, to rows: inout [Comment]) -> Int {
+        guard !entry.isContinueThreadRow, let replies = comment.replies?.array as? [Comment] else {
+            return 0
+        }
+        let startCount = rows.count
+        
+        if entry.level >= self.maximumDepth {
+            if let reply = replies.first {
+                rows.append(reply)
+                self.entries[reply] = self.replyEntry(for: reply, parentEntry: entry, parent: comment, isContinueThreadRow: true)
+            }
+        } else if !self.collapsedComments.contains(comment) {
+            for reply in replies {
+                rows.append(reply)
+                let replyEntry = self.replyEntry(for: reply, parentEntry: entry, parent: comment, isContinueThreadRow: false)
+                self.entries[reply] = replyEntry
+                let span = self.appendReplyRows(of: reply, entry: replyEntry, to: &rows)
+                self.entries[reply]?.span = span
+            }
+        }
+        return rows.count - startCount
+    }
+    
+    fileprivate func replyEntry(for reply: Comment, parentEntry: Entry, parent: Comment, isContinueThreadRow: Bool) -> Entry {
+        return Entry(level: parentEntry.level + 1, indentation: parentEntry.indentation + 1, superParent: parentEntry.superParent, threadComment: parentEntry.threadComment, parent: parent, isContinueThreadRow: isContinueThreadRow, span: 0)
+    }
+    
+    // MARK: - Updating
+    
+    /// Collapses or expands the comment. Only the rows of the replies of the comment are removed or inserted.
+    func toggleCollapse(for comment: Comment) {
+        let wasCollapsed = self.collapsedComments.contains(comment)
+        guard let entry = self.entries[comment], entry.level < self.maximumDepth, !entry.isContinueThreadRow else {
+            // The replies of this comment are not shown anyway
+            if wasCollapsed {
+                self.collapsedComments.remove(comment)
+            } else {
+                self.collapsedComments.insert(comment)
+            }
+            return
+        }
+        
+        if wasCollapsed {
+            self.collapsedComments.remove(comment)
+            self.insertReplyRows(of: comment, entry: entry)
+        } else {
+            self.removeReplyRows(of: comment)
+            self.collapsedComments.insert(comment)
+        }
+    }
+    
+    /**
+     Inserts a new reply directly under its parent.
+     
+     - returns: The thread and row of the inserted comment, nil if the parent is not shown.
+     */
+    func insertReply(_ comment: Comment, parent: Comment) -> (thread: Int, row: Int)? {
+        guard let parentEntry = self.entries[parent], let threadIndex = self.threadIndexes[parentEntry.threadComment], let parentRow = self.row(for: parent, inThread: threadIndex) else {
+            return nil
+        }
+        self.threads?[threadIndex].insert(comment, at: parentRow + 1)
+        self.entries[comment] = self.replyEntry(for: comment, parentEntry: parentEntry, parent: parent, isContinueThreadRow: false)
+        self.addSpan(1, toRowsFrom: parent)
+        self.rowIndexes[threadIndex] = nil
+        return (threadIndex, parentRow + 1)
+    }
+    
+    /**
+     Adds a new thread at the end.
+     
+     - returns: The index of the new thread, nil if the index has been reset.
+     */
+    func appendThread(for comment: Comment) -> Int? {
+        guard self.threads != nil else {
+            return nil
+        }
+        self.threads?.append(self.threadRows(for: comment))
+        let threadIndex = self.threads!.count - 1
+        self.threadIndexes[comment] = threadIndex
+        self.rowIndexes.append(nil)
+        return threadIndex
+    }
+    
+    fileprivate func removeReplyRows(of comment: Comment) {
+        guard let entry = self.entries[comment], entry.span > 0, let threadIndex = self.threadIndexes[entry.threadComment], let row = self.row(for: comment, inThread: threadIndex) else {
+            return
+        }
+        let range = row + 1...row + entry.span
+        for reply in self.threads![threadIndex][range] {
+            self.entries.removeValue(forKey: reply)
+        }
+        self.threads?[threadIndex].removeSubrange(range)
+        self.addSpan(-entry.span, toRowsFrom: comment)
+        self.rowIndexes[threadIndex] = nil
+    }
+    
+    fileprivate func insertReplyRows(of comment: Comment, entry: Entry) {
+        guard let threadIndex = self.threadIndexes[entry.threadComment], let row = self.row(for: comment, inThread: threadIndex) else {
+            return
+        }
+        var rows = [Comment]()
+        let count = self.appendReplyRows(of: comment, entry: entry, to: &rows)
+        guard count > 0 else {
+            return
+        }
+        self.threads?[threadIndex].insert(contentsOf: rows, at: row + 1)
+        self.addSpan(count, toRowsFrom: comment)
+        self.rowIndexes[threadIndex] = nil
+    }
+    
+    /// Adds to the span of the comment and all rows it is shown under.
+    fileprivate func addSpan(_ count: Int, toRowsFrom comment: Comment) {
+        var current: Comment? = comment
+        while let row = current, self.entries[row] != nil {
+            self.entries[row]?.span += count
+            current = self.entries[row]?.parent
+        }
+    }
+    
+    // MARK: - Lookups
+    
+    fileprivate func row(for comment: Comment, inThread threadIndex: Int) -> Int? {
+        guard let threads = self.threads, threadIndex < threads.count else {
+            return nil
+        }
+        if self.rowIndexes[threadIndex] == nil {
+            var rows = [Comment: Int](minimumCapacity: threads[threadIndex].count)
+            for (row, threadComment) in threads[threadIndex].enumerated() {
+                rows[threadComment] = row
+            }
+            self.rowIndexes[threadIndex] = rows
+        }
+        return self.rowIndexes[threadIndex]?[comment]
+    }
+    
+    /// The thread and row the comment is shown in, nil if the comment is not shown.
+    func position(for comment: Comment) -> (thread: Int, row: Int)? {
+        guard let entry = self.entries[comment], let threadIndex = self.threadIndexes[entry.threadComment], let row = self.row(for: comment, inThread: threadIndex) else {
+            return nil
+        }
+        return (threadIndex, row)
+    }
+    
+    func indentation(for comment: Comment) -> Int {
+        return self.entries[comment]?.indentation ?? self.walkIndentation(for: comment)
+    }
+    
+    func superParent(for comment: Comment) -> Comment {
+        return self.entries[comment]?.superParent ?? self.walkSuperParent(for: comment)
+    }
+    
+    func isCollapsed(_ comment: Comment) -> Bool {
+        if self.collapsedComments.contains(comment) {
+            return true
+        }
+        // The parents of a row are expanded, unless the row only continues the thread
+        if let entry = self.entries[comment], !entry.isContinueThreadRow {
+            return false
+        }
+        if let parentComment = comment.parent as? Comment {
+            return self.isCollapsed(parentComment)
+        }
+        return false
+    }
+    
+    // MARK: - Parent chain
+    
+    fileprivate func walkIndentation(for comment: Comment) -> Int {
+        if self.parentComment != nil && comment == self.parentComment {
+            return 0
+        } else if let parent = comment.parent as? Comment {
+            return 1 + self.walkIndentation(for: parent)
+        } else {
+            return self.parentComment != nil ? 1 : 0
+        }
+    }
+    
+    fileprivate func walkSuperParent(for comment: Comment) -> Comment {
+        if let parentComment = comment.parent as? Comment {
+            return self.walkSuperParent(for: parentComment)
+        }
+        return comment
+    }
+    
+}
@@ -25,9 +25,16 @@ class CommentsDataSource: NSObject {
     
     var query: CommentCollectionQuery = CommentCollectionQuery()
     
-    var collapsedComments = [Comment]()
+    var collapsedComments: Set<Comment> {
+        return self.threadIndex.collapsedComments
+    }
+    
+    var threads: [[Comment]]? {
+        return self.threadIndex.threads
+    }
     
-    var threads: [[Comment]]? = [[Comment]]()
+    /// Indexes the rows of the threads, so collapsing or inserting a comment only has to update the rows of that comment.
+    fileprivate var threadIndex = CommentThreadIndex(maximumDepth: CommentsDataSource.maxCommentsDepth, parentComment: nil)
     
     var status: CollectionControllerStatus {
         return self.collectionController.status
@@ -36,7 +43,7 @@ class CommentsDataSource: NSObject {
     let collectionController: CollectionController = {
         let controller = CollectionController(authentication: AppDelegate.shared.authenticationController, context: AppDelegate.shared.managedObjectContext)
         controller.postProcessOperations = { () -> ([Operation]) in
-            return [MarkdownParsingOperation()]
+            return [MarkdownParsingOperation(renderStyles: [.comments])]
         }
         return controller
     }()
@@ -46,6 +53,17 @@ class CommentsDataSource: NSObject {
     //Used to determine the loading indicator for the Load More Comments cells
     fileprivate var loadingMoreComment: MoreComment?
     
+    /// The number of rounds an expansion of the thread takes at most, every round expands the placeholders the previous round loaded.
+    static let maximumExpansionRounds = 10
+    
+    /// Whether the "load more comments" rows of the thread are being expanded.
+    fileprivate(set) var isExpandingThread = false
+    
+    /// The placeholders the current round of the expansion is loading.
+    fileprivate var expandingPlaceholderIDs = Set<NSManagedObjectID>()
+    
+    fileprivate var expansionGraph: OperationGraph?
+    
     // MARK: - Data
     
     func fetchComments(_ completionHandler: @escaping (_ collectionID: NSManagedObjectID?, _ error: Error?) -> Void) {
@@ -60,6 +78,7 @@ class CommentsDataSource: NSObject {
     
     func cancelRequests() {
         self.collectionController.cancelFetching()
+        self.cancelThreadExpansion()
     }
     
     /**
@@ -95,22 +114,18 @@ class CommentsDataSource: NSObject {
     }
     
     func indexPath(forComment comment: Comment, withOffset: Bool = true) -> IndexPath? {
-        guard let threads: [[Comment]] = self.threads else {
+        guard let position = self.threadIndex.position(for: comment) else {
             return nil
         }
-        
-        var section: Int = 0
-        if withOffset {
-            section = self.indexPathSectionOffset
-        }
-        for thread: [Comment] in threads {
-            if let index = thread.firstIndex(of: comment) {
-                let indexPath = IndexPath(row: index, section: section)
-                return indexPath
-            }
-            section += 1
+        return IndexPath(row: position.row, section: position.thread + (withOffset ? self.indexPathSectionOffset : 0))
+    }
+    
+    /// The top level comments of the collection of the collection controller
+    fileprivate var topLevelComments: [Comment]? {
+        guard let collectionID = self.collectionController.collectionID, let collection = AppDelegate.shared.managedObjectContext.object(with: collectionID) as? ObjectCollection else {
+            return nil
         }
-        return nil
+        return collection.objects?.array as? [Comment]
     }
     
     /**
@@ -118,19 +133,20 @@ class CommentsDataSource: NSObject {
      */
     func createThreads() {
         AppDelegate.shared.managedObjectContext.performAndWait { () -> Void in
-            if let collectionID = self.collectionController.collectionID, let collection = AppDelegate.shared.managedObjectContext.object(with: collectionID) as? ObjectCollection, let topLevelComments = collection.objects?.array as? [Comment] {
-                var threads = [[Comment]]()
-                for comment in topLevelComments {
-                    var section = [Comment]()
-                    section.append(comment)
-                    section.append(contentsOf: self.commentReplies(comment, currentLevel: 1))
-                    threads.append(section)
-                }
-                self.threads = threads
+            if self.threadIndex.parentComment != self.query.parentComment || self.threadIndex.maximumDepth != CommentsDataSource.maxCommentsDepth {
+                self.threadIndex = CommentThreadIndex(maximumDepth: CommentsDataSource.maxCommentsDepth, parentComment: self.query.parentComment)
+            }
+            if let topLevelComments = self.topLevelComments {
+                self.threadIndex.rebuild(topLevelComments: topLevelComments)
             }
         }
     }
     
+    /// Removes all threads, for example before the comments are fetched again. The collapsed comments are kept.
+    func resetThreads() {
+        self.threadIndex.reset()
+    }
+    
     /**
      Inserts a comment into the datasource. However it might not add it to the data store!
     
@@ -139,34 +155,29 @@ class CommentsDataSource: NSObject {
      - Returns: The indexpath which can be used to add a row or section to the tableView
     */
     func insertComment(_ comment: Comment) -> IndexPath? {
-        guard let parent = comment.parent as? Comment, let threads = self.threads else {
-            self.threads?.append([comment])
-            return self.indexPath(forComment: comment)
+        guard let parent = comment.parent as? Comment, self.threads != nil else {
+            guard let threadIndex = self.threadIndex.appendThread(for: comment) else {
+                return nil
+            }
+            return IndexPath(row: 0, section: threadIndex + self.indexPathSectionOffset)
         }
-        var threadIndex = 0
-        for var thread in threads {
-            if let index = thread.firstIndex(of: parent) {
-                AppDelegate.shared.managedObjectContext.performAndWait {
-                    var replies = NSMutableOrderedSet()
-                    if let existingReplies = parent.replies {
-                        replies = existingReplies.mutableCopy() as! NSMutableOrderedSet
-                    }
-                    if replies.index(of: comment) != NSNotFound {
-                        replies.add(comment)
-                    }
-                    parent.replies = replies
-                }
-                if index + 1 < thread.count {
-                    thread.insert(comment, at: index + 1)
-                } else {
-                    thread.append(comment)
-                }
-                self.threads?[threadIndex] = thread
-                return self.indexPath(forComment: comment)
+        guard self.threadIndex.position(for: parent) != nil else {
+            return nil
+        }
+        AppDelegate.shared.managedObjectContext.performAndWait {
+            var replies = NSMutableOrderedSet()
+            if let existingReplies = parent.replies {
+                replies = existingReplies.mutableCopy() as! NSMutableOrderedSet
             }
-            threadIndex += 1
+            if replies.index(of: comment) != NSNotFound {
+                replies.add(comment)
+            }
+            parent.replies = replies
         }
-        return nil
+        guard let position = self.threadIndex.insertReply(comment, parent: parent) else {
+            return nil
+        }
+        return IndexPath(row: position.row, section: position.thread + self.indexPathSectionOffset)
     }
     
     /**
@@ -176,15 +187,26 @@ class CommentsDataSource: NSObject {
      - parameter completionHandler: A completion handler, called when the operation has completed or an error occured
      */
     func loadMoreCommentChildren(_ comment: MoreComment, completionHandler: @escaping (_ error: Error?) -> Void) {
-        if self.loadingMoreComment != nil {
+        if self.loadingMoreComment != nil || self.isExpandingThread {
             completionHandler(NSError.beamError(-20, localizedDescription: "Loading more comments while another is in progress is not allowed"))
             return
         }
         if let post = self.query.post, let collectionID = self.collectionController.collectionID, let operations = comment.moreChildrenOperation(post, sort: self.query.sortType, commentsCollectionID: collectionID, authenticationcontroller: AppDelegate.shared.authenticationController) {
             self.loadingMoreComment = comment
+            // Only the thread of the MoreComment has to be updated, unless it is a top level comment
+            var parentComment: Comment?
+            AppDelegate.shared.managedObjectContext.performAndWait {
+                parentComment = comment.parent as? Comment
+            }
             DataController.shared.executeAndSaveOperations(operations, context: AppDelegate.shared.managedObjectContext, handler: { (error: Error?) -> Void in
                 self.loadingMoreComment = nil
-                self.createThreads()
+                AppDelegate.shared.managedObjectContext.performAndWait {
+                    if let parentComment = parentComment, self.threadIndex.position(for: parentComment) != nil {
+                        self.threadIndex.updateReplies(of: parentComment)
+                    } else if let topLevelComments = self.topLevelComments {
+                        self.threadIndex.updateTopLevelComments(topLevelComments)
+                    }
+                }
                 completionHandler(error)
             })
         } else {
@@ -192,27 +214,89 @@ class CommentsDataSource: NSObject {
         }
     }
     
-    //This private method is used a a recursive loop to make the comment tree
-    fileprivate func commentReplies(_ parentComment: Comment, currentLevel: Int) -> [Comment] {
-        var comments = [Comment]()
-        if let replies = parentComment.replies?.array as? [Comment] {
-            for comment in replies {
-                if !self.isCommentFullyCollapsed(comment) {
-                    comments.append(comment)
-                    let level = currentLevel + 1
-                    if level < CommentsDataSource.maxCommentsDepth {
-                        comments.append(contentsOf: self.commentReplies(comment, currentLevel: level))
-                    } else {
-                        if let comment = comment.replies?.firstObject as? Comment {
-                            comments.append(comment)
-                        }
-                        
-                    }
+    // MARK: - Expanding the thread
+    
+    /**
+     Expands the "load more comments" rows of the thread in the background. Every round loads the children of all placeholders at once, in chunks that are fetched concurrently. The comments are parsed into a child context of the main context, which only changes once a round has been parsed, so the visible comments stay interactive.
+     
+     - parameter maximumLevel: Only placeholders up to this level are expanded, the top level comments are level 1. Nil to expand the entire thread.
+     - parameter progressHandler: Called on the main thread after every round, once the threads have been updated.
+     - parameter completionHandler: Called on the main thread when nothing is left to expand or an error occured. Not called when the expansion is cancelled.
+     */
+    func expandThread(maximumLevel: Int? = nil, progressHandler: (() -> Void)? = nil, completionHandler: @escaping (_ error: Error?) -> Void) {
+        if self.loadingMoreComment != nil || self.isExpandingThread {
+            completionHandler(NSError.beamError(-20, localizedDescription: "Loading more comments while another is in progress is not allowed"))
+            return
+        }
+        self.isExpandingThread = true
+        self.expandNextRound(1, maximumLevel: maximumLevel, progressHandler: progressHandler, completionHandler: completionHandler)
+    }
+    
+    /// Stops expanding the thread, the rounds that have finished are kept.
+    func cancelThreadExpansion() {
+        self.isExpandingThread = false
+        self.expandingPlaceholderIDs.removeAll()
+        self.expansionGraph?.cancel()
+        self.expansionGraph = nil
+    }
+    
+    fileprivate func expandNextRound(_ round: Int, maximumLevel: Int?, progressHandler: (() -> Void)?, completionHandler: @escaping (_ error: Error?) -> Void) {
+        let mainContext = AppDelegate.shared.managedObjectContext
+        var placeholderIDs = [NSManagedObjectID]()
+        mainContext.performAndWait {
+            placeholderIDs = self.expandablePlaceholders(maximumLevel: maximumLevel).map { $0.objectID }
+        }
+        guard round <= CommentsDataSource.maximumExpansionRounds, !placeholderIDs.isEmpty, let post = self.query.post, let collectionID = self.collectionController.collectionID else {
+            self.cancelThreadExpansion()
+            completionHandler(nil)
+            return
+        }
+        
+        let context = NSManagedObjectContext(concurrencyType: .privateQueueConcurrencyType)
+        context.parent = mainContext
+        context.undoManager = nil
+        var placeholders = [MoreComment]()
+        context.performAndWait {
+            placeholders = placeholderIDs.compactMap { context.object(with: $0) as? MoreComment }
+        }
+        let operations = MoreComment.expandOperations(placeholders, post: post, commentsCollectionID: collectionID, context: context, priority: .userAction, authenticationController: AppDelegate.shared.authenticationController)
+        self.expandingPlaceholderIDs = Set(placeholderIDs)
+        // Saving the child context merges the round into the main context at once
+        self.expansionGraph = DataController.shared.executeAndSaveOperations(operations, context: context, handler: { (error: Error?) -> Void in
+            DispatchQueue.main.async {
+                guard self.isExpandingThread else {
+                    return
+                }
+                self.expandingPlaceholderIDs.removeAll()
+                self.createThreads()
+                progressHandler?()
+                if let error = error {
+                    self.cancelThreadExpansion()
+                    completionHandler(error)
+                } else {
+                    self.expandNextRound(round + 1, maximumLevel: maximumLevel, progressHandler: progressHandler, completionHandler: completionHandler)
                 }
             }
-            
+        })
+    }
+    
+    /// The placeholders in the thread that can be expanded, up to the maximum level.
+    fileprivate func expandablePlaceholders(maximumLevel: Int?) -> [MoreComment] {
+        var placeholders = [MoreComment]()
+        var commentsToVisit = (self.topLevelComments ?? []).map { (comment: $0, level: 1) }
+        while let next = commentsToVisit.popLast() {
+            if let maximumLevel = maximumLevel, next.level > maximumLevel {
+                continue
+            }
+            if let placeholder = next.comment as? MoreComment {
+                if !placeholder.childIdentifiers.isEmpty {
+                    placeholders.append(placeholder)
+                }
+            } else if let replies = next.comment.replies?.array as? [Comment] {
+                commentsToVisit.append(contentsOf: replies.map { (comment: $0, level: next.level + 1) })
+            }
         }
-        return comments
+        return placeholders
     }
     
     // MARK: - Comment properties
@@ -225,17 +309,7 @@ class CommentsDataSource: NSObject {
      - returns: The level as integer between 0 and 100
      */
     func indentationForComment(_ comment: Comment) -> Int {
-        if self.self.query.parentComment != nil && comment == query.parentComment {
-            return 0
-        } else if comment.parent == nil {
-            if self.query.parentComment != nil {
-                return 1
-            } else {
-                return 0
-            }
-        } else {
-            return 1 + self.indentationForComment(comment.parent as! Comment)
-        }
+        return self.threadIndex.indentation(for: comment)
     }
     
     /**
@@ -246,11 +320,7 @@ class CommentsDataSource: NSObject {
      - returns: The super parent comment
      */
     func superParentForComment(_ comment: Comment) -> Comment? {
-        if let parentComment = comment.parent as? Comment {
-            return self.superParentForComment(parentComment)
-        } else {
-            return comment
-        }
+        return self.threadIndex.superParent(for: comment)
     }
     
     /**
@@ -259,12 +329,9 @@ class CommentsDataSource: NSObject {
      - parameter comment: The comment to collapse or expand
      */
     func toggleCollapseForComment(_ comment: Comment) {
-        if self.collapsedComments.contains(comment) {
-            self.collapsedComments.remove(at: self.collapsedComments.firstIndex(of: comment)!)
-        } else {
-            self.collapsedComments.append(comment)
+        AppDelegate.shared.managedObjectContext.performAndWait {
+            self.threadIndex.toggleCollapse(for: comment)
         }
-        self.createThreads()
     }
     
     /**
@@ -275,13 +342,7 @@ class CommentsDataSource: NSObject {
      - returns: True when collapsed
      */
     func isCommentCollapsed(_ comment: Comment) -> Bool {
-        if self.collapsedComments.contains(comment) {
-            return true
-        }
-        if let parentComment = comment.parent as? Comment {
-            return self.isCommentCollapsed(parentComment)
-        }
-        return false
+        return self.threadIndex.isCollapsed(comment)
     }
     
     /**
@@ -360,7 +421,7 @@ class CommentsDataSource: NSObject {
         } else if let moreCell = cell as? LoadMoreCommentsCell {
             
             moreCell.selectionStyle = .default
-            moreCell.loading = comment == self.loadingMoreComment
+            moreCell.loading = comment == self.loadingMoreComment || self.expandingPlaceholderIDs.contains(comment.objectID)
         
         } else if cell is CommentCell {
             
@@ -206,6 +206,7 @@ private class CommentsEmbeddedViewController: BeamTableViewController, MediaObje
     
     deinit {
         NotificationCenter.default.removeObserver(self)
+        self.dataSource.cancelThreadExpansion()
     }
     
     override func viewWillAppear(_ animated: Bool) {
@@ -376,13 +377,39 @@ private class CommentsEmbeddedViewController: BeamTableViewController, MediaObje
         }
     }
     
+    override func tableView(_ tableView: UITableView, contextMenuConfigurationForRowAt indexPath: IndexPath, point: CGPoint) -> UIContextMenuConfiguration? {
+        guard self.dataSource.commentAtIndexPath(indexPath) is MoreComment, !self.dataSource.isExpandingThread else {
+            return nil
+        }
+        return UIContextMenuConfiguration(identifier: nil, previewProvider: nil) { (_) -> UIMenu? in
+            let expandAction = UIAction(title: AWKLocalizedString("load-all-comments")) { [weak self] (_) in
+                self?.expandThread()
+            }
+            return UIMenu(title: "", children: [expandAction])
+        }
+    }
+    
+    /// Loads all comments of the thread, the threads are updated after every round.
+    fileprivate func expandThread() {
+        self.dataSource.expandThread(progressHandler: { [weak self] in
+            self?.tableView.reloadData()
+        }, completionHandler: { [weak self] (error) in
+            if let error = error {
+                self?.presentErrorMessage(AWKLocalizedString("error-loading-more-comments"))
+                AWKDebugLog("Error loading all comments: \(error)")
+            }
+            self?.tableView.reloadData()
+        })
+        self.tableView.reloadData()
+    }
+    
 }
 
 extension CommentsEmbeddedViewController: CommentsHeaderViewDelegate {
     
     func commentsHeaderView(_ headerView: CommentsHeaderView, didChangeSortType sortType: CollectionSortType) {
         self.dataSource.query.sortType = sortType
-        self.dataSource.threads = nil
+        self.dataSource.resetThreads()
         self.fetchComments()
         self.tableView.reloadData()
     }
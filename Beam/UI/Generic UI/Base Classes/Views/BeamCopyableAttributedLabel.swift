@@ -8,7 +8,7 @@
 
 import TTTAttributedLabel
 
-class BeamCopyableAttributedLabel: TTTAttributedLabel {
+class BeamCopyableAttributedLabel: MarkdownLabel {
     
     override init(frame: CGRect) {
         super.init(frame: frame)
@@ -0,0 +1,42 @@
+//
+//  MarkdownLabel.swift
+//  Beam
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import TTTAttributedLabel
+
+/// A label that shows markdown from the MarkdownRenderCache. The label takes the size of its text from the cache, so laying out a cell again doesn't measure the text again.
+class MarkdownLabel: TTTAttributedLabel {
+    
+    /// The markdown the label shows. Setting the same rendered markdown again doesn't reset the text and the links of the label.
+    var renderedMarkdown: RenderedMarkdown? {
+        didSet {
+            guard self.renderedMarkdown !== oldValue else {
+                return
+            }
+            self.setText(self.renderedMarkdown?.attributedString)
+        }
+    }
+    
+    override func sizeThatFits(_ size: CGSize) -> CGSize {
+        guard let renderedMarkdown = self.renderedMarkdown else {
+            return super.sizeThatFits(size)
+        }
+        // Like TTTAttributedLabel, the text is measured in the full width and the insets are added to the size
+        var fittingSize = renderedMarkdown.size(fittingWidth: size.width, numberOfLines: self.numberOfLines)
+        fittingSize.width += self.textInsets.left + self.textInsets.right
+        fittingSize.height += self.textInsets.top + self.textInsets.bottom
+        return fittingSize
+    }
+    
+    override func layoutSubviews() {
+        super.layoutSubviews()
+        if let renderedMarkdown = self.renderedMarkdown, self.bounds.width > 0 {
+            MarkdownRenderCache.shared.didLayout(renderedMarkdown.style, layout: MarkdownLayout(width: self.bounds.width, numberOfLines: self.numberOfLines))
+        }
+    }
+    
+}
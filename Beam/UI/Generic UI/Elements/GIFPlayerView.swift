@@ -31,25 +31,13 @@ class GIFPlayerView: UIView {
     /// The current gif url that is being played.
     private var currentUrl: URL?
     
-    /// A retained version of the player item on the AVPlayerLayer's player. Improves playback
-    private var currentPlayerItem: AVPlayerItem?
-    
-    /// A retained version of the player on the AVPlayerLayer. Improves playback
-    private var privatePlayer: AVPlayer?
+    /// The player borrowed from the pool, nil when the view isn't showing a gif.
+    private var pooledPlayer: PooledVideoPlayer?
     
     private var videoPlayer: AVPlayer? {
-        get {
-            return self.videoPlayerLayer.player
-        }
-        set {
-            self.privatePlayer = newValue
-            self.videoPlayerLayer.player = newValue
-        }
+        return self.pooledPlayer?.player
     }
     
-    //Because @available doesn't work for properties, we have to make this AnyObject. But in fact it will always be a AVPlayerLooper if it's not null
-    private var playerLooper: AnyObject?
-    
     override func awakeFromNib() {
         super.awakeFromNib()
         
@@ -64,42 +52,25 @@ class GIFPlayerView: UIView {
         self.play()
     }
     
-    private func replace(url: URL, force: Bool = false) {
-        guard self.currentUrl != url || force else {
+    private func replace(url: URL) {
+        guard self.currentUrl != url || self.pooledPlayer == nil else {
             return
         }
         self.currentUrl = url
         
-        //Make the playerItem on a different thread, it improves scrolling
-        DispatchQueue.global(qos: .userInteractive).async {
-            let item = AVPlayerItem(url: url)
-            DispatchQueue.main.async {
-                guard let urlAsset = item.asset as? AVURLAsset, urlAsset.url == self.currentUrl else {
-                    return
-                }
-                self.currentPlayerItem = item
-                if self.videoPlayerLayer.player == nil {
-
-                    let queuePlayer = AVQueuePlayer(playerItem: item)
-                    queuePlayer.isMuted = true
-                    
-                    //Create the looper controller. We need to retain this, otherwise the looping stops
-                    self.playerLooper = AVPlayerLooper(player: queuePlayer, templateItem: item)
-                    
-                    self.videoPlayer = queuePlayer
-                } else {
-                    if let queuePlayer = self.videoPlayer as? AVQueuePlayer {
-                        self.stop()
-                        queuePlayer.removeAllItems()
-                        self.playerLooper = AVPlayerLooper(player: queuePlayer, templateItem: item)
-                    }
-                    
-                }
-            }
+        //The pool reuses a player that already has the video, for example because it was prerolled
+        let pooledPlayer = VideoPlayerPool.shared.player(for: url, owner: self)
+        self.pooledPlayer = pooledPlayer
+        if self.videoPlayerLayer.player !== pooledPlayer.player {
+            self.videoPlayerLayer.player = pooledPlayer.player
         }
     }
     
     func play() {
+        if self.pooledPlayer == nil, let url = self.currentUrl {
+            //The player was reclaimed by the pool while the view was paused
+            self.replace(url: url)
+        }
         //Play changes the playing state of the AVPlayer, regardless of if it contains an item or not
         self.videoPlayer?.play()
         
@@ -111,13 +82,12 @@ class GIFPlayerView: UIView {
     
     func stop() {
         self.currentUrl = nil
-        self.videoPlayer?.pause()
-        self.videoPlayer?.rewind()
-        if let queuePlayer = self.videoPlayer as? AVQueuePlayer {
-            queuePlayer.removeAllItems()
-            (self.playerLooper as? AVPlayerLooper)?.disableLooping()
-            self.playerLooper = nil
+        if let pooledPlayer = self.pooledPlayer {
+            //The player keeps the video, in case the gif is shown again
+            VideoPlayerPool.shared.release(pooledPlayer, owner: self)
         }
+        self.pooledPlayer = nil
+        self.videoPlayerLayer.player = nil
     }
     
     var isPlaying: Bool {
@@ -163,8 +133,23 @@ class GIFPlayerView: UIView {
     
     deinit {
         NotificationCenter.default.removeObserver(self)
+        //The pool only holds a weak reference to its owner, the player becomes idle by itself
         self.videoPlayer?.pause()
-        self.videoPlayer = nil
+    }
+    
+}
+
+// MARK: - VideoPlayerPoolOwner
+
+extension GIFPlayerView: VideoPlayerPoolOwner {
+    
+    func videoPlayerPool(_ pool: VideoPlayerPool, didReclaim player: PooledVideoPlayer) {
+        guard self.pooledPlayer === player else {
+            return
+        }
+        //Another gif needs the player more, the url is kept so the view can borrow a player again when it plays
+        self.pooledPlayer = nil
+        self.videoPlayerLayer.player = nil
     }
     
 }
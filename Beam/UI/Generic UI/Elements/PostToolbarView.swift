@@ -116,9 +116,7 @@ extension PostToolbarViewDelegate where Self: UIViewController {
             post.markVisited()
         }
         
-        let oldVoteStatus = VoteStatus(rawValue: post.voteStatus?.intValue ?? 0) ?? VoteStatus.neutral
-        post.updateScore(status, oldVoteStatus: oldVoteStatus)
-        post.voteStatus = NSNumber(value: status.rawValue)
+        UserActivityController.shared.vote(post, direction: status)
         status.soundType.play()
         
         if #available(iOS 10, *), [VoteStatus.up, VoteStatus.down].contains(status) {
@@ -126,18 +124,6 @@ extension PostToolbarViewDelegate where Self: UIViewController {
             feedbackGenerator.prepare()
             feedbackGenerator.selectionChanged()
         }
-        
-        let operation = post.voteOperation(status, authenticationController: AppDelegate.shared.authenticationController)
-        DataController.shared.executeOperations([operation]) { [weak self] (error: Error?) -> Void in
-            post.managedObjectContext?.perform {
-                if let error = error {
-                    print("Error \(error)")
-                    post.updateScore(oldVoteStatus, oldVoteStatus: status)
-                    post.voteStatus = NSNumber(value: oldVoteStatus.rawValue)
-                    self?.presentVoteError(error)
-                }
-            }
-        }
     }
     
     fileprivate func shownInGallery() -> Bool {
@@ -166,19 +152,6 @@ extension PostToolbarViewDelegate where Self: UIViewController {
         }
     }
     
-    fileprivate func presentVoteError(_ error: Error?) {
-        if let error = error as NSError? {
-            if let noticeHandler = self as? NoticeHandling {
-                if error.code == NSURLErrorNotConnectedToInternet && error.domain == NSURLErrorDomain {
-                    noticeHandler.presentErrorMessage(AWKLocalizedString("error-vote-internet"))
-                } else {
-                    noticeHandler.presentErrorMessage(AWKLocalizedString("error-vote"))
-                }
-            }
-        }
-
-    }
-    
     func  visibleSubredditForToolbarView(_ toolbarView: PostToolbarView) -> Subreddit? {
         return nil
     }
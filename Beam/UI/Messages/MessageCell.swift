@@ -18,15 +18,13 @@ class MessageCell: BeamTableViewCell, MessageObjectCell {
     @IBOutlet var authorButton: BeamPlainButton!
     @IBOutlet var ageLabel: UILabel!
     @IBOutlet var subjectLabel: UILabel!
-    @IBOutlet var contentLabel: TTTAttributedLabel!
+    @IBOutlet var contentLabel: MarkdownLabel!
     
     weak var delegate: MessageObjectCellDelegate?
     
     var sentMessage = false
     
-    fileprivate var contentStylesheet: MarkdownStylesheet {
-        return MarkdownStylesheet.beamStyleSheet(UIFont.TextStyle.footnote, darkmode: self.userInterfaceStyle == .dark)
-    }
+    fileprivate let contentStyle = MarkdownRenderStyle.textStyle(UIFont.TextStyle.footnote)
     
     var message: Message? {
         didSet {
@@ -87,6 +85,6 @@ class MessageCell: BeamTableViewCell, MessageObjectCell {
         
         self.contentLabel.linkAttributes = TTTAttributedLabel.beamLinkAttributesWithStyle(userInterfaceStyle)
         self.contentLabel.activeLinkAttributes = TTTAttributedLabel.beamActiveLinkAttributesWithStyle(userInterfaceStyle)
-        self.contentLabel.setText(self.message?.markdownString?.attributedStringWithStylesheet(self.contentStylesheet))
+        self.contentLabel.renderedMarkdown = self.message.flatMap { MarkdownRenderCache.shared.renderedMarkdown(for: $0, style: self.contentStyle, darkmode: self.userInterfaceStyle == .dark) }
     }
 }
@@ -14,15 +14,13 @@ import RedditMarkdownKit
 class MessageDetailCell: BeamTableViewCell, MessageObjectCell {
     
     @IBOutlet var authorButton: BeamPlainButton!
-    @IBOutlet var contentLabel: TTTAttributedLabel!
+    @IBOutlet var contentLabel: MarkdownLabel!
     
     weak var delegate: MessageObjectCellDelegate?
     
     var sentMessage = false
     
-    fileprivate var contentStylesheet: MarkdownStylesheet {
-        return MarkdownStylesheet.beamStyleSheet(UIFont.TextStyle.subheadline, darkmode: self.userInterfaceStyle == .dark)
-    }
+    fileprivate let contentStyle = MarkdownRenderStyle.textStyle(UIFont.TextStyle.subheadline)
     
     var message: Message? {
         didSet {
@@ -70,7 +68,7 @@ class MessageDetailCell: BeamTableViewCell, MessageObjectCell {
         
         self.contentLabel.linkAttributes = TTTAttributedLabel.beamLinkAttributesWithStyle(userInterfaceStyle)
         self.contentLabel.activeLinkAttributes = TTTAttributedLabel.beamActiveLinkAttributesWithStyle(userInterfaceStyle)
-        self.contentLabel.setText(self.message?.markdownString?.attributedStringWithStylesheet(self.contentStylesheet))
+        self.contentLabel.renderedMarkdown = self.message.flatMap { MarkdownRenderCache.shared.renderedMarkdown(for: $0, style: self.contentStyle, darkmode: self.userInterfaceStyle == .dark) }
     }
 
 }
@@ -16,13 +16,11 @@ class NotificationCell: BeamTableViewCell, MessageObjectCell {
     @IBOutlet var unreadIndicator: UnreadIndicator!
     @IBOutlet var authorButton: BeamPlainButton!
     @IBOutlet var metadataLabel: UILabel!
-    @IBOutlet var contentLabel: TTTAttributedLabel!
+    @IBOutlet var contentLabel: MarkdownLabel!
     
     weak var delegate: MessageObjectCellDelegate?
 
-    fileprivate var contentStylesheet: MarkdownStylesheet {
-        return MarkdownStylesheet.beamStyleSheet(UIFont.TextStyle.footnote, darkmode: self.userInterfaceStyle == .dark)
-    }
+    fileprivate let contentStyle = MarkdownRenderStyle.textStyle(UIFont.TextStyle.footnote)
     
     var message: Message? {
         didSet {
@@ -89,7 +87,7 @@ class NotificationCell: BeamTableViewCell, MessageObjectCell {
         
         self.contentLabel.linkAttributes = TTTAttributedLabel.beamLinkAttributesWithStyle(userInterfaceStyle)
         self.contentLabel.activeLinkAttributes = TTTAttributedLabel.beamActiveLinkAttributesWithStyle(userInterfaceStyle)
-        self.contentLabel.setText(self.message?.markdownString?.attributedStringWithStylesheet(self.contentStylesheet))
+        self.contentLabel.renderedMarkdown = self.message.flatMap { MarkdownRenderCache.shared.renderedMarkdown(for: $0, style: self.contentStyle, darkmode: self.userInterfaceStyle == .dark) }
     }
 
 }
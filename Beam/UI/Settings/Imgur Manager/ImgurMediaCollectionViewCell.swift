@@ -8,7 +8,6 @@
 
 import UIKit
 import ImgurKit
-import SDWebImage
 
 class ImgurMediaCollectionViewCell: BeamCollectionViewCell {
     
@@ -131,30 +130,51 @@ class ImgurMediaCollectionViewCell: BeamCollectionViewCell {
         }
         
         if let thumbnailURLString: String = thumbnailURLString, let URL: URL = URL(string: thumbnailURLString) {
-            if let cachedImage: UIImage = SDImageCache.shared.imageFromDiskCache(forKey: thumbnailURLString) {
+            var options: DownscaledImageOptions = DownscaledImageOptions()
+            options.constrainingSize = self.mediaImageView.bounds.size
+            options.contentMode = UIView.ContentMode.scaleAspectFill
+            let variantKey = ImageVariantKey(urlString: thumbnailURLString, options: options)
+            
+            if let cachedImage: UIImage = ImageVariantCache.shared.memoryImage(for: variantKey) {
                 self.mediaImageView.image = cachedImage
                 self.reloadAlbumIdicators()
             } else {
-                let request: URLRequest = URLRequest(url: URL, cachePolicy: NSURLRequest.CachePolicy.returnCacheDataElseLoad, timeoutInterval: 60)
-                self.imageTask = URLSession.shared.downloadTask(with: request, completionHandler: { (location, _, _) in
-                    if let location: URL = location {
-                        var options: DownscaledImageOptions = DownscaledImageOptions()
-                        options.constrainingSize = self.mediaImageView.bounds.size
-                        options.contentMode = UIView.ContentMode.scaleAspectFill
-                        let image: UIImage? = UIImage.downscaledImageWithFileURL(location, options: options)
-                        if image != nil {
-                            SDImageCache.shared.store(image, forKey: thumbnailURLString, toDisk: true)
+                let imgurObject = self.imgurObject
+                // The disk cache blocks while reading, so the variant is read from disk in the background
+                DispatchQueue.global(qos: .userInitiated).async {
+                    let diskImage: UIImage? = ImageVariantCache.shared.image(for: variantKey)
+                    DispatchQueue.main.async(execute: { () -> Void in
+                        guard self.imgurObject === imgurObject else {
+                            return
                         }
-                        
-                        DispatchQueue.main.async(execute: { () -> Void in
-                            self.mediaImageView.image = image
-                            self.imageTask = nil
+                        if let diskImage = diskImage {
+                            self.mediaImageView.image = diskImage
                             self.reloadAlbumIdicators()
-                        })
-                    }
-                })
-                self.imageTask?.resume()
+                        } else {
+                            self.downloadImage(URL, options: options, variantKey: variantKey)
+                        }
+                    })
+                }
             }
         }
     }
+    
+    fileprivate func downloadImage(_ URL: URL, options: DownscaledImageOptions, variantKey: ImageVariantKey) {
+        let request: URLRequest = URLRequest(url: URL, cachePolicy: NSURLRequest.CachePolicy.returnCacheDataElseLoad, timeoutInterval: 60)
+        self.imageTask = URLSession.shared.downloadTask(with: request, completionHandler: { (location, _, _) in
+            if let location: URL = location {
+                let image: UIImage? = UIImage.downscaledImageWithFileURL(location, options: options)
+                if let image = image {
+                    ImageVariantCache.shared.store(image, for: variantKey)
+                }
+                
+                DispatchQueue.main.async(execute: { () -> Void in
+                    self.mediaImageView.image = image
+                    self.imageTask = nil
+                    self.reloadAlbumIdicators()
+                })
+            }
+        })
+        self.imageTask?.resume()
+    }
 }
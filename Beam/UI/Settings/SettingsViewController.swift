@@ -519,6 +519,7 @@ class SettingsViewController: BeamTableViewController {
     fileprivate func clearCaches() {
         SDImageCache.shared.clearDisk()
         SDImageCache.shared.clearMemory()
+        LoopingVideoCache.shared.removeAllVideos()
         let operation = DataController.clearAllObjectsOperation()
         DataController.shared.executeOperations([operation], handler: nil)
         let alertController = BeamAlertController(title: AWKLocalizedString("cache-cleared-title"), message: AWKLocalizedString("cache-cleared-message"), preferredStyle: .alert)
@@ -152,25 +152,28 @@ class MediaOverviewCollectionViewCell: BeamCollectionViewCell, MediaCellMediaLab
         self.albumStackUpperView?.isHidden = !self.representsAlbum
     }
     
+    /// The URL of the thumbnail a cell of the size shows for the media object, with the options it is downscaled with. The overview uses the same thumbnail for prefetching.
+    class func thumbnail(for mediaObject: Snoo.MediaObject?, cellSize: CGSize) -> (url: URL, options: DownscaledImageOptions)? {
+        guard let url = mediaObject?.thumbnailURL(for: cellSize) ?? mediaObject?.contentURL else {
+            return nil
+        }
+        // The size of the cell instead of the image view, so the variant doesn't depend on the album indicators
+        var options = DownscaledImageOptions()
+        options.constrainingSize = cellSize
+        options.contentMode = .scaleAspectFill
+        return (url, options)
+    }
+    
     fileprivate func fetchImage() {
-        
-        let thumbnail = self.mediaObject?.thumbnailWithSize(self.bounds.size)
-        let urlString = thumbnail?.url?.absoluteString ?? self.mediaObject?.contentURL?.absoluteString
-        if let urlString = urlString, let url = URL(string: urlString) {
-            
-            if let cachedImage = SDImageCache.shared.imageFromDiskCache(forKey: urlString) {
+        if let thumbnail = MediaOverviewCollectionViewCell.thumbnail(for: self.mediaObject, cellSize: self.bounds.size) {
+            let url = thumbnail.url
+            let options = thumbnail.options
+            let urlString = url.absoluteString
+            if let cachedImage = ImageVariantCache.shared.memoryImage(for: ImageVariantKey(urlString: urlString, options: options)) {
                 self.mediaImageView.image = cachedImage
                 self.reloadAlbumIdicators()
             } else {
-                var options = DownscaledImageOptions()
-                options.constrainingSize = self.mediaImageView.bounds.size
-                options.contentMode = .scaleAspectFill
-                
                 self.imageOperation = AppDelegate.shared.imageLoader.startDownloadingImageWithURL(url, downscalingOptions: options, progressHandler: nil, completionHandler: { (image) in
-                    if image != nil {
-                        SDImageCache.shared.store(image, forKey: urlString, toDisk: true)
-                    }
-                    
                     DispatchQueue.main.async {
                         self.mediaImageView.image = image
                         self.imageOperation = nil
@@ -33,6 +33,11 @@ class SubredditMediaOverviewViewController: BeamViewController, SubredditTabItem
     var lastScrollViewOffsetCapture: TimeInterval?
     @IBOutlet var collectionView: UICollectionView!
     
+    /// The items of which the thumbnails are prefetched.
+    fileprivate var prefetchRange: CountableRange<Int>?
+    
+    fileprivate var scrollVelocityTracker = ScrollVelocityTracker()
+    
     weak var galleryViewController: AWKGalleryViewController?
     
     var titleView = SubredditTitleView.titleViewWithSubreddit(nil)
@@ -122,6 +127,7 @@ class SubredditMediaOverviewViewController: BeamViewController, SubredditTabItem
 
         self.refreshControl.addTarget(self, action: #selector(SubredditMediaOverviewViewController.refresh(_:)), for: .valueChanged)
         self.collectionView.refreshControl = self.refreshControl
+        self.collectionView.prefetchDataSource = self
         
         self.flowLayout.minimumInteritemSpacing = 1
         self.flowLayout.minimumLineSpacing = 1
@@ -142,9 +148,23 @@ class SubredditMediaOverviewViewController: BeamViewController, SubredditTabItem
     }
     
     deinit {
+        ContentPrefetchController.shared.cancelAllPrefetching(for: self)
         NotificationCenter.default.removeObserver(self)
     }
     
+    override func viewDidAppear(_ animated: Bool) {
+        super.viewDidAppear(animated)
+        
+        self.updatePrefetchWindow()
+    }
+    
+    override func viewDidDisappear(_ animated: Bool) {
+        super.viewDidDisappear(animated)
+        
+        self.prefetchRange = nil
+        ContentPrefetchController.shared.cancelAllPrefetching(for: self)
+    }
+    
     override func viewWillAppear(_ animated: Bool) {
         super.viewWillAppear(animated)
         
@@ -420,6 +440,8 @@ extension SubredditMediaOverviewViewController: UICollectionViewDataSource {
 extension SubredditMediaOverviewViewController {
     
     func scrollViewDidScroll(_ scrollView: UIScrollView) {
+        self.scrollVelocityTracker.update(with: scrollView)
+        self.updatePrefetchWindow()
         
         //Determine if the user is in the "load more" scroll region
         if scrollView.contentOffset.y > scrollView.contentSize.height - scrollView.bounds.height && (scrollView.isDragging || scrollView.isDecelerating) {
@@ -454,6 +476,45 @@ extension SubredditMediaOverviewViewController {
     
 }
 
+// MARK: - UICollectionViewDataSourcePrefetching
+extension SubredditMediaOverviewViewController: UICollectionViewDataSourcePrefetching {
+    
+    fileprivate func prefetchItem(at index: Int) -> PrefetchItem? {
+        let post = self.mediaCollectionController?.itemAtIndexPath(IndexPath(item: index, section: 0))
+        guard let thumbnail = MediaOverviewCollectionViewCell.thumbnail(for: post?.mediaObjects?.firstObject as? Snoo.MediaObject, cellSize: self.itemSize) else {
+            return nil
+        }
+        return .thumbnail(thumbnail.url, options: thumbnail.options)
+    }
+    
+    /// Prefetches the thumbnails of the items ahead of the visible items, the number of items depends on the scroll velocity.
+    fileprivate func updatePrefetchWindow() {
+        let visibleItems = self.collectionView.indexPathsForVisibleItems.map { $0.item }
+        guard let firstItem = visibleItems.min(), let lastItem = visibleItems.max() else {
+            return
+        }
+        // The lookahead is in rows, the overview shows multiple items per row
+        let range = ContentPrefetchController.prefetchRange(visibleRange: (firstItem / self.imagesInRow)...(lastItem / self.imagesInRow), count: ((self.mediaCollectionController?.count ?? 0) + self.imagesInRow - 1) / self.imagesInRow, velocity: self.scrollVelocityTracker.velocity)
+        let itemCount = self.mediaCollectionController?.count ?? 0
+        let itemRange = min(range.lowerBound * self.imagesInRow, itemCount)..<min(range.upperBound * self.imagesInRow, itemCount)
+        guard itemRange != self.prefetchRange else {
+            return
+        }
+        self.prefetchRange = itemRange
+        ContentPrefetchController.shared.setPrefetchItems(itemRange.compactMap { self.prefetchItem(at: $0) }, for: self)
+    }
+    
+    func collectionView(_ collectionView: UICollectionView, prefetchItemsAt indexPaths: [IndexPath]) {
+        ContentPrefetchController.shared.prefetch(indexPaths.compactMap { self.prefetchItem(at: $0.item) }, for: self)
+    }
+    
+    func collectionView(_ collectionView: UICollectionView, cancelPrefetchingForItemsAt indexPaths: [IndexPath]) {
+        let indexPaths = indexPaths.filter { self.prefetchRange?.contains($0.item) != true }
+        ContentPrefetchController.shared.cancelPrefetching(indexPaths.compactMap { self.prefetchItem(at: $0.item) }, for: self)
+    }
+    
+}
+
 // MARK: - UICollectionViewDelegateFlowLayout
 extension SubredditMediaOverviewViewController: UICollectionViewDelegateFlowLayout {
 
@@ -658,6 +719,9 @@ extension SubredditMediaOverviewViewController: SubredditMediaCollectionControll
             self.hasEnteredLoadMoreState = false
             self.collectionView?.reloadData()
             self.galleryViewController?.reloadData()
+            
+            self.prefetchRange = nil
+            self.updatePrefetchWindow()
         }
     }
     
@@ -688,34 +752,12 @@ extension SubredditMediaOverviewViewController: SubredditMediaCollectionControll
     }
     
     func mediaCollectionController(_ controller: SubredditMediaCollectionController, filterCollection collection: [Post]) -> [Post] {
-        guard let subreddit = self.subreddit else {
+        guard let subreddit = self.subreddit, let contentFilter = subreddit.contentFilter else {
             return collection
         }
         let shouldFilterSubreddits: Bool = subreddit.identifier == Subreddit.allIdentifier
         let filteredContent: [Post] = collection.filter { (content: Post) -> Bool in
-            let postTitle: String? = content.title
-            let subredditName: String? = content.subreddit?.displayName
-            //containsString and length are faster on NSString than on swift string
-            if let keywords: [String] = subreddit.filterKeywords, let title: NSString = postTitle?.lowercased() as NSString?, title.length > 0 {
-                for filterKeyword: String in keywords {
-                    if title.contains(filterKeyword) {
-                        //If it contains the keyword, we don't want to continue!
-                        return false
-                    }
-                }
-            }
-            
-            //containsString and length are faster on NSString than on swift string
-            if shouldFilterSubreddits {
-                if let filterSubreddits: [String] = subreddit.filterSubreddits, let subreddit = subredditName?.lowercased(), subreddit.count > 0 {
-                    //If it contains the keyword, we don't want to continue!
-                    return !filterSubreddits.contains(where: { (keyword) -> Bool in
-                        return subreddit == keyword
-                    })
-                }
-            }
-            
-            return true
+            return !contentFilter.shouldFilter(content, filteringSubreddits: shouldFilterSubreddits)
         }
         return filteredContent
     }
@@ -15,7 +15,7 @@ final class PostCommentPartCell: BeamTableViewCell, PostCell {
 
     @IBOutlet var commentView: UIView!
     @IBOutlet var authorLabel: UILabel!
-    @IBOutlet var contentLabel: TTTAttributedLabel!
+    @IBOutlet var contentLabel: MarkdownLabel!
     @IBOutlet var dateLabel: UILabel!
     @IBOutlet var topConstraint: NSLayoutConstraint!
     
@@ -33,10 +33,6 @@ final class PostCommentPartCell: BeamTableViewCell, PostCell {
         }
     }
     
-    var contentStyleSheet: MarkdownStylesheet {
-        return MarkdownStylesheet.beamCommentsStyleSheet(self.userInterfaceStyle == .dark)
-    }
-    
     //This cell doesn't do anything with the post
     weak var post: Post?
     
@@ -45,7 +41,7 @@ final class PostCommentPartCell: BeamTableViewCell, PostCell {
     weak var comment: Comment? {
         didSet {
             self.authorLabel.text = comment?.author
-            self.contentLabel.setText(self.comment?.markdownString?.attributedStringWithStylesheet(self.contentStyleSheet))
+            self.contentLabel.renderedMarkdown = self.comment.flatMap { MarkdownRenderCache.shared.renderedMarkdown(for: $0, style: .comments, darkmode: self.userInterfaceStyle == .dark) }
             
             if let score = self.comment?.score, let dateString = self.comment?.creationDate?.localizedRelativeTimeString {
                 var localizedPoints = NSLocalizedString("points-inline", comment: "")
@@ -85,7 +81,7 @@ final class PostCommentPartCell: BeamTableViewCell, PostCell {
         
         self.contentLabel.linkAttributes = TTTAttributedLabel.beamLinkAttributesWithStyle(userInterfaceStyle)
         self.contentLabel.activeLinkAttributes = TTTAttributedLabel.beamActiveLinkAttributesWithStyle(userInterfaceStyle)
-        self.contentLabel.setText(self.comment?.markdownString?.attributedStringWithStylesheet(self.contentStyleSheet))
+        self.contentLabel.renderedMarkdown = self.comment.flatMap { MarkdownRenderCache.shared.renderedMarkdown(for: $0, style: .comments, darkmode: self.userInterfaceStyle == .dark) }
         self.dateLabel.textColor = AppearanceValue(light: UIColor(red: 127 / 225, green: 127 / 225, blue: 127 / 225, alpha: 1.0), dark: UIColor(red: 153 / 225, green: 153 / 225, blue: 153 / 225, alpha: 1.0))
         
         switch userInterfaceStyle {
@@ -13,11 +13,11 @@ import TTTAttributedLabel
 
 final class PostSelfTextPartCell: BeamTableViewCell, PostCell {
     
-    fileprivate var contentStylesheet: MarkdownStylesheet {
+    fileprivate var contentStyle: MarkdownRenderStyle {
         if !self.showsSummary {
-            return MarkdownStylesheet.beamSelfPostStyleSheet(self.userInterfaceStyle == .dark)
+            return .selfPost
         }
-        return MarkdownStylesheet.beamStyleSheet(UIFont.TextStyle.footnote, darkmode: self.userInterfaceStyle == .dark)
+        return .textStyle(UIFont.TextStyle.footnote)
     }
     
     var onDetailView: Bool = false {
@@ -29,7 +29,7 @@ final class PostSelfTextPartCell: BeamTableViewCell, PostCell {
     var shouldShowSpoilerOverlay: Bool = true
     var shouldShowNSFWOverlay: Bool = true
 
-    @IBOutlet var contentLabel: TTTAttributedLabel!
+    @IBOutlet var contentLabel: MarkdownLabel!
     @IBOutlet fileprivate var readAllLabel: UILabel!
     
     @IBOutlet fileprivate var spoilerOverlay: UIView!
@@ -143,7 +143,7 @@ final class PostSelfTextPartCell: BeamTableViewCell, PostCell {
         super.appearanceDidChange()
         self.contentLabel.linkAttributes = TTTAttributedLabel.beamLinkAttributesWithStyle(userInterfaceStyle)
         self.contentLabel.activeLinkAttributes = TTTAttributedLabel.beamActiveLinkAttributesWithStyle(userInterfaceStyle)
-        self.contentLabel.setText(post?.markdownString?.attributedStringWithStylesheet(self.contentStylesheet))
+        self.contentLabel.renderedMarkdown = self.post.flatMap { MarkdownRenderCache.shared.renderedMarkdown(for: $0, style: self.contentStyle, darkmode: self.userInterfaceStyle == .dark) }
         self.readAllLabel.textColor = AppearanceValue(light: UIColor.beam, dark: UIColor.beamPurpleLight)
         
         var containerBackgroundColor = AppearanceValue(light: UIColor(red: 245 / 255, green: 245 / 255, blue: 245 / 255, alpha: 1.0), dark: UIColor(red: 38 / 255, green: 38 / 255, blue: 38 / 255, alpha: 1.0))
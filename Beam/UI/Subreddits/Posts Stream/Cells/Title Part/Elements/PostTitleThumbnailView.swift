@@ -49,20 +49,16 @@ final class PostTitleThumbnailView: BeamControl, MediaImageLoader, MediaCellMedi
             }
             return nil
         } else {
-            guard self.mediaObject != nil else {
+            guard let mediaObject = self.mediaObject else {
                 return nil
             }
-            var mediaURLString: String?
-            AppDelegate.shared.managedObjectContext.performAndWait { () -> Void in
-                if let urlString = self.mediaObject?.thumbnailWithSize(self.preferredThumbnailSize)?.url?.absoluteString {
-                    mediaURLString = urlString
-                } else if let url = self.mediaObject?.smallThumbnailURL {
-                    mediaURLString = url.absoluteString
-                } else {
-                    mediaURLString = self.mediaObject?.contentURL?.absoluteString
-                }
+            if let url = mediaObject.thumbnailURL(for: self.preferredThumbnailSize) {
+                return url.absoluteString
+            } else if let url = mediaObject.smallThumbnailURL {
+                return url.absoluteString
+            } else {
+                return mediaObject.contentURL?.absoluteString
             }
-            return mediaURLString
         }
     }
     
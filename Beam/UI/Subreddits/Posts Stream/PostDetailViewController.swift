@@ -341,7 +341,7 @@ class PostDetailEmbeddedViewController: StreamViewController {
                 }
                 self.tableView.endUpdates()
             } else {
-                self.commentsDataSource.threads = nil
+                self.commentsDataSource.resetThreads()
                 self.tableView.reloadData()
                 self.fetchComments()
             }
@@ -535,7 +535,7 @@ extension PostDetailEmbeddedViewController: CommentsHeaderViewDelegate {
     
     func commentsHeaderView(_ headerView: CommentsHeaderView, didChangeSortType sortType: CollectionSortType) {
         self.commentsDataSource.query.sortType = sortType
-        self.commentsDataSource.threads = nil
+        self.commentsDataSource.resetThreads()
         self.commentsDataSource.query.post?.subreddit?.commentsSortType = sortType
         self.fetchComments()
         self.tableView.reloadData()
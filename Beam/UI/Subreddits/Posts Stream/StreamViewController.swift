@@ -14,7 +14,6 @@ import TTTAttributedLabel
 import CherryKit
 import SafariServices
 import AVFoundation
-import Ocarina
 
 enum BeamStreamSortingType {
     case hot
@@ -87,15 +86,19 @@ class StreamViewController: BeamTableViewController, PostMetadataViewDelegate, B
         
         let controller = CollectionController(authentication: AppDelegate.shared.authenticationController, context: AppDelegate.shared.managedObjectContext)
         
-        controller.postProcessOperations = { () -> ([Operation]) in
-            let operation = StreamImagesOperation()
-            operation.cherryController = AppDelegate.shared.cherryController
-            return [operation, MarkdownParsingOperation()]
-        }
+        controller.postProcessOperations = StreamViewController.postProcessOperations
         
         return controller
     }()
     
+    /// The operations that prepare the posts of a page for the stream, after they have been parsed.
+    class func postProcessOperations() -> [Operation] {
+        let operation = StreamImagesOperation()
+        operation.cherryController = AppDelegate.shared.cherryController
+        // Self posts are shown as a summary in the stream
+        return [operation, MarkdownParsingOperation(renderStyles: [.textStyle(UIFont.TextStyle.footnote)])]
+    }
+    
     var query: CollectionQuery? {
         get {
             return self.collectionController.query
@@ -189,23 +192,20 @@ class StreamViewController: BeamTableViewController, PostMetadataViewDelegate, B
     internal var galleryMediaObjects: [MediaObject]?
     fileprivate var gallerySourceIndexPath: IndexPath?
     
-    fileprivate var urlInformationPrefetcher: OcarinaPrefetcher?
+    /// The sections of which the link metadata and thumbnails are prefetched.
+    fileprivate var prefetchRange: CountableRange<Int>?
+    
+    fileprivate var scrollVelocityTracker = ScrollVelocityTracker()
     
     var content: [Content]? {
         didSet {
-            let urls: [URL]? = self.content?.compactMap { (content) -> URL? in
-                guard let post = content as? Post, let urlString = post.urlString else {
-                    return nil
-                }
-                return URL(string: urlString)
-            }
-            self.urlInformationPrefetcher?.cancel()
-            if let prefetchUrls = urls {
-                self.urlInformationPrefetcher = OcarinaPrefetcher(urls: prefetchUrls)
-            }
             DispatchQueue.main.async {
                 self.tableView.reloadData()
                 
+                // Sections may have moved, the window is set again for the new content
+                self.prefetchRange = nil
+                self.updatePrefetchWindow()
+                
                 if !(self is PostDetailEmbeddedViewController) {
                     UIView.animate(withDuration: 0.32, animations: { () -> Void in
                         self.tableView.tableFooterView?.frame = CGRect(origin: self.tableView.tableFooterView!.frame.origin, size: CGSize(width: self.tableView.bounds.width, height: 0))
@@ -249,6 +249,7 @@ class StreamViewController: BeamTableViewController, PostMetadataViewDelegate, B
         self.tableView.estimatedRowHeight = 60
         self.tableView.separatorStyle = UITableViewCell.SeparatorStyle.none
         self.tableView.rowHeight = UITableView.automaticDimension
+        self.tableView.prefetchDataSource = self
         
         //Add refresh control
         self.refreshControl = UIRefreshControl()
@@ -257,6 +258,7 @@ class StreamViewController: BeamTableViewController, PostMetadataViewDelegate, B
     
     deinit {
         self.cancelRequests()
+        ContentPrefetchController.shared.cancelAllPrefetching(for: self)
         if self.refreshNotificationTimer != nil {
             self.refreshNotificationTimer!.invalidate()
             self.refreshNotificationTimer = nil
@@ -277,6 +279,8 @@ class StreamViewController: BeamTableViewController, PostMetadataViewDelegate, B
         
         self.tableView.reloadData()
         
+        self.collectionController.priority = .visibleContent
+        
         if self.refreshNotificationTimer == nil {
             self.startRefreshNotificationTimer(self.collection?.expirationDate)
         }
@@ -291,6 +295,14 @@ class StreamViewController: BeamTableViewController, PostMetadataViewDelegate, B
         super.viewDidAppear(animated)
         
         self.updateGifPlayingState()
+        self.updatePrefetchWindow()
+    }
+    
+    override func viewDidDisappear(_ animated: Bool) {
+        super.viewDidDisappear(animated)
+        
+        self.prefetchRange = nil
+        ContentPrefetchController.shared.cancelAllPrefetching(for: self)
     }
     
     override func viewWillDisappear(_ animated: Bool) {
@@ -298,6 +310,9 @@ class StreamViewController: BeamTableViewController, PostMetadataViewDelegate, B
         
         self.pauseAllPlayingGifs()
         
+        // Requests for content that is no longer visible shouldn't hold up the requests of the next view
+        self.collectionController.priority = .prefetch
+        
         if self.refreshNotificationTimer != nil {
             self.refreshNotificationTimer!.invalidate()
             self.refreshNotificationTimer = nil
@@ -350,39 +365,12 @@ class StreamViewController: BeamTableViewController, PostMetadataViewDelegate, B
         guard let content: [Content] = list?.array as? [Content] else {
             return [Content]()
         }
+        guard let contentFilter = subreddit.contentFilter else {
+            return content
+        }
         let shouldFilterSubreddits: Bool = subreddit.identifier == Subreddit.allIdentifier || subreddit.identifier == Subreddit.frontpageIdentifier
         let filteredContent: [Content] = content.filter { (content: Content) -> Bool in
-            var postTitle: String?
-            var subredditName: String?
-            if let post: Post = content as? Post {
-                postTitle = post.title
-                subredditName = post.subreddit?.displayName
-
-            } else if let comment: Comment = content as? Comment {
-               postTitle = comment.post?.title
-                subredditName = comment.post?.subreddit?.displayName
-            }
-            //containsString and length are faster on NSString than on swift string
-            if let keywords = subreddit.filterKeywords, let title = postTitle?.lowercased(), title.count > 0 {
-                for filterKeyword in keywords {
-                    if title.contains(filterKeyword) {
-                        //If it contains the keyword, we don't want to continue!
-                        return false
-                    }
-                }
-            }
-            
-            //containsString and length are faster on NSString than on swift string
-            if shouldFilterSubreddits {
-                if let filterSubreddits = subreddit.filterSubreddits, let subreddit = subredditName?.lowercased(), subreddit.count > 0 {
-                    //If it contains the keyword, we don't want to continue!
-                    return !filterSubreddits.contains(where: { (keyword) -> Bool in
-                        return subreddit == keyword
-                    })
-                }
-            }
-
-            return true
+            return !contentFilter.shouldFilter(content, filteringSubreddits: shouldFilterSubreddits)
         }
         return filteredContent
     }
@@ -885,10 +873,14 @@ extension StreamViewController {
         
         let visibleRect = self.tableView.frame.inset(by: StreamViewController.visibleContentInset)
         
+        var gifCellCount = 0
         for cell in self.tableView.visibleCells {
             guard let indexPath = self.tableView.indexPath(for: cell), let imagePartCell = cell as? PostImagePartCell else {
                 continue
             }
+            if imagePartCell.mediaObject is MediaAnimatedGIF {
+                gifCellCount += 1
+            }
             let rectOfCell = self.tableView.rectForRow(at: indexPath)
             let rectOfCellInSuperview = self.tableView.convert(rectOfCell, to: self.tableView.superview)
             if visibleRect.intersects(rectOfCellInSuperview) && imagePartCell.gifPlayerView.isPlaying == false {
@@ -897,6 +889,100 @@ extension StreamViewController {
                 imagePartCell.gifPlayerView.pause()
             }
         }
+        
+        //Every visible gif keeps its player, the pool has one more for the gif that is scrolled towards
+        if VideoPlayerPool.shared.visibleSlotCount != gifCellCount {
+            VideoPlayerPool.shared.visibleSlotCount = gifCellCount
+        }
+        self.prerollUpcomingGif()
+    }
+    
+    /// The number of sections past the visible sections that are searched for a gif to preroll.
+    fileprivate static let gifPrerollDistance = 3
+    
+    /// Loads the first gif after the visible sections in the scroll direction, so it plays right away when its cell appears.
+    fileprivate func prerollUpcomingGif() {
+        guard let visibleSections = self.tableView.indexPathsForVisibleRows?.map({ $0.section }), let firstSection = visibleSections.min(), let lastSection = visibleSections.max() else {
+            return
+        }
+        let sections: [Int]
+        if self.scrollVelocityTracker.velocity < 0 {
+            sections = Array((max(0, firstSection - StreamViewController.gifPrerollDistance)..<firstSection).reversed())
+        } else {
+            sections = Array((lastSection + 1)..<(lastSection + 1 + StreamViewController.gifPrerollDistance))
+        }
+        for section in sections {
+            if let url = self.gifVideoURL(forSection: section) {
+                VideoPlayerPool.shared.preroll(url)
+                return
+            }
+        }
+    }
+    
+    /// The video the image cell of the section autoplays, if the content is a gif.
+    fileprivate func gifVideoURL(forSection section: Int) -> URL? {
+        guard let post = self.content(forSection: section) as? Post, self.cellIdentifiersForContent(post).contains(.Image) else {
+            return nil
+        }
+        return (post.mediaObjects?.firstObject as? MediaAnimatedGIF)?.videoURL
+    }
+    
+}
+
+// MARK: - Prefetching
+
+extension StreamViewController: UITableViewDataSourcePrefetching {
+    
+    /// The link metadata and thumbnail the cells of the content in the section will show.
+    fileprivate func prefetchItems(forSection section: Int) -> [PrefetchItem] {
+        guard let post = self.content(forSection: section) as? Post else {
+            return []
+        }
+        var items = [PrefetchItem]()
+        for cellType in self.cellIdentifiersForContent(post) {
+            switch cellType {
+            case .Link, .VideoLink:
+                if let urlString = post.urlString, let url = URL(string: urlString) {
+                    items.append(.linkMetadata(url))
+                }
+            case .Image, .TitleWithThumbnail:
+                if let mediaObject = post.mediaObjects?.firstObject as? MediaObject, let url = StreamViewController.thumbnailURL(for: mediaObject, small: cellType == .TitleWithThumbnail) {
+                    items.append(.thumbnail(url))
+                }
+            default:
+                break
+            }
+        }
+        return items
+    }
+    
+    /// The thumbnail the image cell, or the small thumbnail of the title cell, picks for the media object. The cells downscale it with the default options.
+    class func thumbnailURL(for mediaObject: MediaObject, small: Bool) -> URL? {
+        let thumbnailSize = small ? CGSize(width: 70, height: 70) : UIScreen.main.bounds.size
+        return mediaObject.thumbnailURL(for: thumbnailSize) ?? mediaObject.smallThumbnailURL ?? mediaObject.contentURL
+    }
+    
+    /// Prefetches the sections ahead of the visible sections, the number of sections depends on the scroll velocity.
+    fileprivate func updatePrefetchWindow() {
+        guard let visibleSections = self.tableView.indexPathsForVisibleRows?.map({ $0.section }), let firstSection = visibleSections.min(), let lastSection = visibleSections.max() else {
+            return
+        }
+        let range = ContentPrefetchController.prefetchRange(visibleRange: firstSection...lastSection, count: self.content?.count ?? 0, velocity: self.scrollVelocityTracker.velocity)
+        guard range != self.prefetchRange else {
+            return
+        }
+        self.prefetchRange = range
+        ContentPrefetchController.shared.setPrefetchItems(range.flatMap { self.prefetchItems(forSection: $0) }, for: self)
+    }
+    
+    func tableView(_ tableView: UITableView, prefetchRowsAt indexPaths: [IndexPath]) {
+        let sections = Set(indexPaths.map { $0.section }).sorted()
+        ContentPrefetchController.shared.prefetch(sections.flatMap { self.prefetchItems(forSection: $0) }, for: self)
+    }
+    
+    func tableView(_ tableView: UITableView, cancelPrefetchingForRowsAt indexPaths: [IndexPath]) {
+        let sections = Set(indexPaths.map { $0.section }).filter { self.prefetchRange?.contains($0) != true }
+        ContentPrefetchController.shared.cancelPrefetching(sections.flatMap { self.prefetchItems(forSection: $0) }, for: self)
     }
     
 }
@@ -910,6 +996,9 @@ extension StreamViewController {
         
         self.updateGifPlayingState()
         
+        self.scrollVelocityTracker.update(with: scrollView)
+        self.updatePrefetchWindow()
+        
         //Determine if the user is in the "load more" scroll region
         if scrollView.contentOffset.y > scrollView.contentSize.height - (UIScreen.main.bounds.height * 1.5) && scrollView.contentSize.height > scrollView.frame.height {
                 
@@ -23,7 +23,7 @@ class SubredditInfoDescriptionCell: BeamTableViewCell {
     @IBOutlet fileprivate var contentLabelBottomConstraint: NSLayoutConstraint!
     @IBOutlet var contentLabelReadMoreSpaceConstraint: NSLayoutConstraint!
     @IBOutlet fileprivate var contentLabelHeightConstraint: NSLayoutConstraint!
-    @IBOutlet var contentLabel: TTTAttributedLabel!
+    @IBOutlet var contentLabel: MarkdownLabel!
     
     weak var delegate: SubredditInfoDescriptionCellDelegate?
     
@@ -42,14 +42,10 @@ class SubredditInfoDescriptionCell: BeamTableViewCell {
         }
     }
     
-    fileprivate var contentStylesheet: MarkdownStylesheet {
-        return MarkdownStylesheet.beamSelfPostStyleSheet(self.userInterfaceStyle == .dark)
-    }
-    
     fileprivate func reloadData() {
         self.contentLabel.linkAttributes = TTTAttributedLabel.beamLinkAttributesWithStyle(userInterfaceStyle)
         self.contentLabel.activeLinkAttributes = TTTAttributedLabel.beamActiveLinkAttributesWithStyle(userInterfaceStyle)
-        self.contentLabel.setText(self.subreddit?.descriptionTextMarkdownString?.attributedStringWithStylesheet(contentStylesheet))
+        self.contentLabel.renderedMarkdown = self.subreddit.flatMap { MarkdownRenderCache.shared.renderedMarkdown(for: $0, style: .selfPost, darkmode: self.userInterfaceStyle == .dark) }
     }
     
     override func updateConstraints() {
@@ -137,7 +137,6 @@ class SubredditStreamViewController: BeamViewController, SubredditTabItemViewCon
     func updateStreamQuery(_ sortType: CollectionSortType? = nil, timeFrame: CollectionTimeFrame? = nil) {
         //Only update if the query was already set
         let currentQuery: PostCollectionQuery? = self.streamViewController?.query as? PostCollectionQuery
-        let query: PostCollectionQuery = PostCollectionQuery()
         
         var newSortType: CollectionSortType!
         var newTimeFrame: CollectionTimeFrame!
@@ -159,13 +158,19 @@ class SubredditStreamViewController: BeamViewController, SubredditTabItemViewCon
                 newTimeFrame = .thisMonth
             }
         }
-        query.sortType = newSortType
-        query.timeFrame = newTimeFrame
+        self.streamViewController?.query = SubredditStreamViewController.streamQuery(for: self.subreddit, sortType: newSortType, timeFrame: newTimeFrame)
+    }
+    
+    /// The query of the stream of the subreddit. The background warm-up uses the same query, so the stream finds the warmed up collection.
+    class func streamQuery(for subreddit: Subreddit?, sortType: CollectionSortType, timeFrame: CollectionTimeFrame) -> PostCollectionQuery {
+        let query = PostCollectionQuery()
+        query.sortType = sortType
+        query.timeFrame = timeFrame
         
-        query.subreddit = self.subreddit
+        query.subreddit = subreddit
         query.hideNSFWContent = !AppDelegate.shared.authenticationController.userCanViewNSFWContent
-
-        self.streamViewController?.query = query
+        query.contentFilter = subreddit?.contentFilter
+        return query
     }
     
     override func viewDidLayoutSubviews() {
@@ -38,19 +38,8 @@ class HidePostActivity: CustomObjectActivity<Post> {
         guard AppDelegate.shared.authenticationController.isAuthenticated, let post = self.object else {
             return
         }
-        post.isHidden = NSNumber(value: self.shouldHidePost)
-        NotificationCenter.default.post(name: .PostDidChangeHiddenState, object: post)
-        let operation = post.markHiddenOperation(self.shouldHidePost, authenticationController: AppDelegate.shared.authenticationController)
-        DataController.shared.executeAndSaveOperations([operation], context: AppDelegate.shared.managedObjectContext, handler: { (error: Error?) -> Void in
-            DispatchQueue.main.async(execute: { () -> Void in
-                self.activityDidFinish(true)
-                if error != nil {
-                    let alertController = BeamAlertController(title: AWKLocalizedString("post-hide-error"), message: AWKLocalizedString("post-hide-error-message"), preferredStyle: .alert)
-                    alertController.addCloseAction()
-                    AppDelegate.topViewController()?.present(alertController, animated: true, completion: nil)
-                }
-            })
-        })
+        UserActivityController.shared.hide(post, hidden: self.shouldHidePost)
+        self.activityDidFinish(true)
     }
 
 }
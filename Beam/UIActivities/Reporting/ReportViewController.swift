@@ -29,11 +29,9 @@ final class ReportViewController: BeamTableViewController {
                     }
                 })
             }
-            post.isHidden = true
-            NotificationCenter.default.post(name: .PostDidChangeHiddenState, object: post)
+            UserActivityController.shared.hide(post, hidden: true)
             let reportOperation = post.reportOperation(self.selectedReason, otherReason: nil, authenticationController: AppDelegate.shared.authenticationController)
-            let hideOperation = post.markHiddenOperation(true, authenticationController: AppDelegate.shared.authenticationController)
-            DataController.shared.executeAndSaveOperations([reportOperation, hideOperation], context: AppDelegate.shared.managedObjectContext, handler: { (error: Error?) -> Void in
+            DataController.shared.executeAndSaveOperations([reportOperation], context: AppDelegate.shared.managedObjectContext, handler: { (error: Error?) -> Void in
                 if let error = error {
                     AWKDebugLog("Error reporting post: \(error)")
                 }
@@ -26,23 +26,8 @@ class SaveContentActivity<T: Content>: CustomObjectActivity<T> {
         guard AppDelegate.shared.authenticationController.isAuthenticated, let content = self.object else {
             return
         }
-        content.isSaved = NSNumber(value: self.shouldSaveContent)
-        let operation = content.saveToRedditOperation(self.shouldSaveContent, authenticationController: AppDelegate.shared.authenticationController)
-        DataController.shared.executeAndSaveOperations([operation], context: AppDelegate.shared.managedObjectContext, handler: { (error: Error?) -> Void in
-            DispatchQueue.main.async(execute: { () -> Void in
-                self.activityDidFinish(true)
-                if error != nil {
-                    let isPost = content is Post
-                    let title = isPost ? AWKLocalizedString("post-save-error") : AWKLocalizedString("comment-save-error")
-                    let message = isPost ? AWKLocalizedString("post-save-error-message") : AWKLocalizedString("comment-save-error-message")
-                    let alertController = BeamAlertController(title: title, message: message, preferredStyle: .alert)
-                    alertController.addCloseAction()
-                    AppDelegate.topViewController()?.present(alertController, animated: true, completion: nil)
-                } else {
-                    NotificationCenter.default.post(name: .ContentDidChangeSavedState, object: content)
-                }
-            })
-        })
+        UserActivityController.shared.save(content, saved: self.shouldSaveContent)
+        self.activityDidFinish(true)
     }
     
 }
@@ -0,0 +1,135 @@
+//
+//  ImageVariantCacheTests.swift
+//  BeamTests
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import XCTest
+import SDWebImage
+@testable import beam
+
+class ImageVariantCacheTests: XCTestCase {
+    
+    var diskCacheDirectory: String!
+    var diskCache: SDImageCache!
+    
+    override func setUp() {
+        super.setUp()
+        self.diskCacheDirectory = (NSTemporaryDirectory() as NSString).appendingPathComponent("image-variant-tests-\(UUID().uuidString)")
+        self.diskCache = SDImageCache(namespace: "image-variant-tests", diskCacheDirectory: self.diskCacheDirectory)
+    }
+    
+    override func tearDown() {
+        try? FileManager.default.removeItem(atPath: self.diskCacheDirectory)
+        super.tearDown()
+    }
+    
+    func image(color: UIColor, size: CGSize = CGSize(width: 10, height: 10)) -> UIImage {
+        let format = UIGraphicsImageRendererFormat()
+        format.scale = 1
+        return UIGraphicsImageRenderer(size: size, format: format).image { context in
+            color.setFill()
+            context.fill(CGRect(origin: CGPoint.zero, size: size))
+        }
+    }
+    
+    func key(_ urlString: String, size: CGSize = CGSize(width: 10, height: 10), contentMode: UIView.ContentMode = .scaleAspectFill) -> ImageVariantKey {
+        var options = DownscaledImageOptions()
+        options.constrainingSize = size
+        options.contentMode = contentMode
+        return ImageVariantKey(urlString: urlString, options: options)
+    }
+    
+    func testKeySeparation() {
+        let key = self.key("https://i.imgur.com/a.jpg")
+        XCTAssertEqual(key, self.key("https://i.imgur.com/a.jpg"))
+        
+        let otherKeys = [self.key("https://i.imgur.com/b.jpg"), self.key("https://i.imgur.com/a.jpg", size: CGSize(width: 20, height: 10)), self.key("https://i.imgur.com/a.jpg", contentMode: .scaleAspectFit)]
+        for otherKey in otherKeys {
+            XCTAssertNotEqual(key, otherKey)
+            XCTAssertNotEqual(key.diskCacheKey, otherKey.diskCacheKey)
+        }
+        
+        let cache = ImageVariantCache(memoryBudget: 1024 * 1024, diskCache: nil)
+        cache.store(self.image(color: UIColor.red), for: key)
+        XCTAssertNotNil(cache.memoryImage(for: key))
+        for otherKey in otherKeys {
+            XCTAssertNil(cache.memoryImage(for: otherKey))
+        }
+    }
+    
+    func testMemoryBudgetEviction() {
+        let images = [UIColor.red, UIColor.green, UIColor.blue].map { self.image(color: $0) }
+        let cost = ImageVariantCache.cost(of: images[0])
+        XCTAssertGreaterThan(cost, 0)
+        let keys = ["a", "b", "c"].map { self.key("https://i.imgur.com/\($0).jpg") }
+        
+        // Room for two of the three images
+        let cache = ImageVariantCache(memoryBudget: cost * 2 + cost / 2, diskCache: nil)
+        cache.store(images[0], for: keys[0])
+        cache.store(images[1], for: keys[1])
+        XCTAssertEqual(cache.memoryCost, cost * 2)
+        
+        // Using the first image makes the second image the least recently used one
+        XCTAssertNotNil(cache.memoryImage(for: keys[0]))
+        cache.store(images[2], for: keys[2])
+        XCTAssertEqual(cache.memoryCost, cost * 2)
+        XCTAssertNotNil(cache.memoryImage(for: keys[0]))
+        XCTAssertNil(cache.memoryImage(for: keys[1]))
+        XCTAssertNotNil(cache.memoryImage(for: keys[2]))
+        
+        // Storing a variant again replaces it, without counting its cost twice
+        cache.store(images[2], for: keys[2])
+        XCTAssertEqual(cache.memoryCost, cost * 2)
+        
+        // An image that doesn't fit the budget at all is not kept
+        let largeKey = self.key("https://i.imgur.com/large.jpg", size: CGSize(width: 100, height: 100))
+        cache.store(self.image(color: UIColor.red, size: CGSize(width: 100, height: 100)), for: largeKey)
+        XCTAssertNil(cache.memoryImage(for: largeKey))
+        XCTAssertEqual(cache.memoryCost, cost * 2)
+        
+        cache.removeAllMemoryImages()
+        XCTAssertEqual(cache.memoryCost, 0)
+        XCTAssertNil(cache.memoryImage(for: keys[0]))
+    }
+    
+    func testDiskTierPromotion() {
+        let key = self.key("https://i.imgur.com/a.jpg")
+        let cache = ImageVariantCache(memoryBudget: 1024 * 1024, diskCache: self.diskCache)
+        XCTAssertNil(cache.image(for: key))
+        
+        // The variant is only on disk, like after the app was relaunched
+        self.diskCache.storeImageData(toDisk: self.image(color: UIColor.red).pngData(), forKey: key.diskCacheKey)
+        XCTAssertNil(cache.memoryImage(for: key))
+        
+        XCTAssertNotNil(cache.image(for: key))
+        XCTAssertEqual(cache.statistics.diskHits, 1)
+        XCTAssertGreaterThan(cache.memoryCost, 0)
+        
+        // Reading it from disk moved it into memory
+        XCTAssertNotNil(cache.memoryImage(for: key))
+        XCTAssertEqual(cache.statistics.memoryHits, 1)
+        XCTAssertEqual(cache.statistics.diskHits, 1)
+    }
+    
+    func testStatistics() {
+        let key = self.key("https://i.imgur.com/a.jpg")
+        let cache = ImageVariantCache(memoryBudget: 1024 * 1024, diskCache: nil)
+        XCTAssertEqual(cache.statistics.hitRate, 0)
+        
+        XCTAssertNil(cache.image(for: key))
+        cache.store(self.image(color: UIColor.red), for: key)
+        XCTAssertNotNil(cache.image(for: key))
+        XCTAssertNotNil(cache.memoryImage(for: key))
+        XCTAssertNil(cache.image(for: self.key("https://i.imgur.com/b.jpg")))
+        
+        let statistics = cache.statistics
+        XCTAssertEqual(statistics.memoryHits, 2)
+        XCTAssertEqual(statistics.diskHits, 0)
+        XCTAssertEqual(statistics.misses, 2)
+        XCTAssertEqual(statistics.hitRate, 0.5, accuracy: 0.001)
+    }
+    
+}
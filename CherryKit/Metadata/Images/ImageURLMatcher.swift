@@ -0,0 +1,101 @@
+//
+//  ImageURLMatcher.swift
+//  CherryKit
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import Foundation
+
+/// Checks if a URL matches any of the image URL patterns Cherry supports. The patterns are compiled once, create a new matcher when the patterns change.
+///
+/// Patterns that only match a single host, like `^https?://i.imgur.com/`, are looked up by the host of the URL. All other patterns are merged into a single regular expression, so a URL is checked in a single pass.
+public final class ImageURLMatcher {
+    
+    /// The regular expression patterns the matcher was created with.
+    public let patterns: [String]
+    
+    /// Hosts for which any URL matches, from patterns like `^https?://i.imgur.com/`.
+    fileprivate var matchingHosts = Set<String>()
+    
+    /// The expressions per host, for host patterns that also check the path.
+    fileprivate var hostExpressions = [String: [NSRegularExpression]]()
+    
+    /// The expressions for all other patterns. Usually a single merged expression.
+    fileprivate var expressions = [NSRegularExpression]()
+    
+    /// Matches patterns that start with a scheme and a literal host. Dots in the host are taken literally, also when they are not escaped.
+    fileprivate static let hostPatternExpression = try! NSRegularExpression(pattern: "^\\^https\\?://((?:[a-z0-9-]|\\\\\\.|\\.)+)/([^|]*)$", options: [.caseInsensitive])
+    
+    /// Numbered backreferences can't be used in a merged expression, because the group numbers change.
+    fileprivate static let backreferenceExpression = try! NSRegularExpression(pattern: "\\\\[1-9]", options: [])
+    
+    public init(patterns: [String]) {
+        self.patterns = patterns
+        
+        var otherPatterns = [String]()
+        for pattern in patterns {
+            let range = NSRange(location: 0, length: (pattern as NSString).length)
+            guard let match = ImageURLMatcher.hostPatternExpression.firstMatch(in: pattern, options: [], range: range) else {
+                otherPatterns.append(pattern)
+                continue
+            }
+            let host = (pattern as NSString).substring(with: match.range(at: 1)).replacingOccurrences(of: "\\.", with: ".").lowercased()
+            if match.range(at: 2).length == 0 {
+                self.matchingHosts.insert(host)
+            } else if let expression = ImageURLMatcher.expression(pattern) {
+                self.hostExpressions[host, default: [NSRegularExpression]()].append(expression)
+            }
+        }
+        
+        let canMerge = otherPatterns.count > 1 && !otherPatterns.contains(where: { ImageURLMatcher.backreferenceExpression.firstMatch(in: $0, options: [], range: NSRange(location: 0, length: ($0 as NSString).length)) != nil })
+        if canMerge, let expression = ImageURLMatcher.expression(otherPatterns.map({ "(?:\($0))" }).joined(separator: "|")) {
+            self.expressions = [expression]
+        } else {
+            // One of the patterns is invalid or can't be merged, check them one by one
+            self.expressions = otherPatterns.compactMap { ImageURLMatcher.expression($0) }
+        }
+    }
+    
+    /// Returns true if the URL matches any of the patterns.
+    public func matches(_ urlString: String) -> Bool {
+        let range = NSRange(location: 0, length: (urlString as NSString).length)
+        if let host = ImageURLMatcher.host(of: urlString) {
+            if self.matchingHosts.contains(host) {
+                return true
+            }
+            if let expressions = self.hostExpressions[host], expressions.contains(where: { $0.firstMatch(in: urlString, options: [], range: range) != nil }) {
+                return true
+            }
+        }
+        return self.expressions.contains(where: { $0.firstMatch(in: urlString, options: [], range: range) != nil })
+    }
+    
+    fileprivate static func expression(_ pattern: String) -> NSRegularExpression? {
+        do {
+            return try NSRegularExpression(pattern: pattern, options: [.caseInsensitive])
+        } catch {
+            NSLog("Invalid image URL regular expression \(error)")
+            return nil
+        }
+    }
+    
+    /// The lowercased host of an http or https URL. Nil if the URL has no path after the host, because host patterns always end with a slash.
+    fileprivate static func host(of urlString: String) -> String? {
+        let string = urlString.lowercased()
+        let remainder: Substring
+        if string.hasPrefix("https://") {
+            remainder = string.dropFirst(8)
+        } else if string.hasPrefix("http://") {
+            remainder = string.dropFirst(7)
+        } else {
+            return nil
+        }
+        guard let slashIndex = remainder.firstIndex(of: "/") else {
+            return nil
+        }
+        return String(remainder[remainder.startIndex..<slashIndex])
+    }
+    
+}
@@ -97,4 +97,54 @@ class CherryKitTests: XCTestCase {
         }
     }
     
+    /// A pattern set like the one in features.json.
+    let imageURLPatterns = ["^https?://i.imgur.com/", "^https?://imgur.com/a/", "^https?://imgur.com/gallery/", "^https?://m.imgur.com/", "^https?://(?: www.)?gfycat.com/", "^https?://i.redd.it/", "^https?://i.reddituploads.com/", "^https?://(?:i|g).redditmedia.com/", "^https?://(?:www\\.)?giphy.com/gifs/", "^https?://media\\.giphy\\.com/media/", "^https?://streamable.com/", "^https?://(?:www\\.)?flickr.com/photos/", "^https?://.*\\.deviantart\\.com/art/", "^https?://(?:www\\.)?instagram.com/p/", "(.jpe?g|.png|.gif)$"]
+    
+    /// Post URLs as they appear in a front page listing.
+    let postURLs = ["http://i.imgur.com/spygYxW.jpg", "https://imgur.com/a/abc12", "https://IMGUR.com/gallery/xyz", "http://gfycat.com/IdleExhaustedIrishterrier", "https://i.redd.it/abc.png", "https://www.reddit.com/r/swift/comments/abc/title/", "https://www.youtube.com/watch?v=abc", "https://giphy.com/gifs/cat-abc", "https://example.com/image.JPG", "https://example.com/article", "https://artist.deviantart.com/art/drawing-123", "https://www.instagram.com/p/abc/", "https://streamable.com", "ftp://i.imgur.com/abc", "https://twitter.com/user/status/123"]
+    
+    func testImageURLMatcher() {
+        let matcher = ImageURLMatcher(patterns: self.imageURLPatterns)
+        for urlString in self.postURLs {
+            XCTAssertEqual(matcher.matches(urlString), self.matchesPatternsOneByOne(urlString), "Matching differs for '\(urlString)'")
+        }
+        
+        // Invalid patterns are skipped, the others still match
+        let invalidMatcher = ImageURLMatcher(patterns: ["(unclosed", "(.jpe?g|.png|.gif)$"])
+        XCTAssertTrue(invalidMatcher.matches("https://example.com/image.jpg"))
+        XCTAssertFalse(invalidMatcher.matches("https://example.com/article"))
+    }
+    
+    func testImageURLMatcherPerformance() {
+        let matcher = ImageURLMatcher(patterns: self.imageURLPatterns)
+        let urlStrings = Array(repeating: self.postURLs, count: 100).joined()
+        self.measure {
+            for urlString in urlStrings {
+                _ = matcher.matches(urlString)
+            }
+        }
+    }
+    
+    func testImageURLPatternsOneByOnePerformance() {
+        let urlStrings = Array(repeating: self.postURLs, count: 100).joined()
+        self.measure {
+            for urlString in urlStrings {
+                _ = self.matchesPatternsOneByOne(urlString)
+            }
+        }
+    }
+    
+    /// Checks the patterns the way the stream did before the matcher existed.
+    private func matchesPatternsOneByOne(_ urlString: String) -> Bool {
+        for pattern in self.imageURLPatterns {
+            guard let regex = try? NSRegularExpression(pattern: pattern, options: [NSRegularExpression.Options.caseInsensitive]) else {
+                continue
+            }
+            if regex.firstMatch(in: urlString, options: [], range: NSRange(location: 0, length: (urlString as NSString).length)) != nil {
+                return true
+            }
+        }
+        return false
+    }
+    
 }
@@ -21,6 +21,13 @@ public class ImgurController: NSObject {
         return queue
     }()
     
+    /// Uploads only spend their time sending data, so a few of them can run side by side. Every upload streams its form from a file, so memory use doesn't grow with the number of uploads.
+    fileprivate var uploadsQueue: OperationQueue = {
+        let queue = OperationQueue()
+        queue.maxConcurrentOperationCount = 3
+        return queue
+    }()
+    
     lazy fileprivate var requestExecutionHandlerQueue: DispatchQueue = {
         return DispatchQueue(label: "com.madeawkward.imgurkit-execution-handler", attributes: DispatchQueue.Attributes.concurrent)
     }()
@@ -40,22 +47,30 @@ public class ImgurController: NSObject {
         self.requestExecutionHandlerQueue.async {
             for request in requests {
                 if uploadProgressHandler != nil {
-                    request.uploadProgressHandler = { (request: ImgurRequest, progress: CGFloat) in
-                        var requestNumber = 0
-                        if let index = requests.firstIndex(of: request) {
-                            requestNumber = index + 1
-                        }
+                    request.uploadProgressHandler = { (_: ImgurRequest, _: CGFloat) in
+                        // Uploads run side by side, so the number is the first request that hasn't completed its upload yet
+                        var completedRequests = 0
                         var totalProgress: CGFloat = 0
                         for request in requests {
                             totalProgress += request.uploadProgress
+                            if request.uploadProgress >= 1 {
+                                completedRequests += 1
+                            }
                         }
+                        let requestNumber = min(completedRequests + 1, requests.count)
                         totalProgress /= CGFloat(requests.count)
                         uploadProgressHandler!(requestNumber, totalProgress)
                     }
                 }
                 request.imgurController = self
             }
-            self.requestsQeue.addOperations(requests, waitUntilFinished: true)
+            let uploadRequests = requests.filter { $0 is ImgurUploadRequest }
+            let otherRequests = requests.filter { !($0 is ImgurUploadRequest) }
+            self.uploadsQueue.addOperations(uploadRequests, waitUntilFinished: false)
+            self.requestsQeue.addOperations(otherRequests, waitUntilFinished: true)
+            for request in uploadRequests {
+                request.waitUntilFinished()
+            }
             var errors = [NSError]()
             for request in requests {
                 if let error = request.error {
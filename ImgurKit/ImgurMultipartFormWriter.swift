@@ -0,0 +1,177 @@
+//
+//  ImgurMultipartFormWriter.swift
+//  ImgurKit
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import UIKit
+import Photos
+import ImageIO
+import MobileCoreServices
+
+/// Writes a multipart form body to a temporary file, so an upload never needs the complete file in memory. The file data is written in chunks, straight from the photo library or the JPEG encoder.
+///
+/// Upload the form with `URLSession.uploadTask(with:fromFile:)` and call `removeFile()` when the upload is done.
+internal final class ImgurMultipartFormWriter {
+    
+    let boundary: String
+    
+    /// The temporary file the form is written to.
+    let fileURL: URL
+    
+    fileprivate let fileHandle: FileHandle
+    
+    fileprivate var isFinished = false
+    
+    init(boundary: String) throws {
+        self.boundary = boundary
+        self.fileURL = FileManager.default.temporaryDirectory.appendingPathComponent("imgur-upload-\(UUID().uuidString)")
+        guard FileManager.default.createFile(atPath: self.fileURL.path, contents: nil, attributes: nil) else {
+            throw NSError.imgurKitError(500, message: "Could not create upload file")
+        }
+        self.fileHandle = try FileHandle(forWritingTo: self.fileURL)
+    }
+    
+    deinit {
+        if !self.isFinished {
+            self.fileHandle.closeFile()
+        }
+    }
+    
+    var contentType: String {
+        return "multipart/form-data; boundary=\(self.boundary)"
+    }
+    
+    // MARK: - Writing
+    
+    func appendParameter(_ name: String, value: Any) {
+        self.appendString("--\(self.boundary)\r\n")
+        self.appendString("Content-Disposition: form-data; name=\"\(name)\"\r\n\r\n")
+        self.appendString("\(value)\r\n")
+    }
+    
+    /**
+     Appends a file part with the data of a photo library asset. The data is requested in chunks and written directly to the form.
+     
+     - parameter name: The name of the form field.
+     - parameter asset: The asset to upload, the edited version is used if the asset has been edited.
+     - parameter completionHandler: Called with an error if the data of the asset could not be loaded.
+     */
+    func appendFile(_ name: String, asset: PHAsset, completionHandler: @escaping (_ error: NSError?) -> Void) {
+        let resources = PHAssetResource.assetResources(for: asset)
+        guard let resource = resources.first(where: { $0.type == .fullSizePhoto }) ?? resources.first(where: { $0.type == .photo }) else {
+            // Assets without a photo resource, like shared stream photos, can only be loaded as a whole
+            let requestOptions = PHImageRequestOptions()
+            requestOptions.isNetworkAccessAllowed = true
+            PHImageManager.default().requestImageDataAndOrientation(for: asset, options: requestOptions) { (imageData, dataUTI, _, userInfo) in
+                guard let imageData = imageData else {
+                    completionHandler(userInfo?[PHImageErrorKey] as? NSError ?? NSError.imgurKitError(404, message: "Photo data missing"))
+                    return
+                }
+                self.beginFile(name, filename: "file.jpg", mimeType: ImgurMultipartFormWriter.mimeType(dataUTI))
+                self.fileHandle.write(imageData)
+                self.appendString("\r\n")
+                completionHandler(nil)
+            }
+            return
+        }
+        self.beginFile(name, filename: resource.originalFilename, mimeType: ImgurMultipartFormWriter.mimeType(resource.uniformTypeIdentifier))
+        
+        let options = PHAssetResourceRequestOptions()
+        options.isNetworkAccessAllowed = true
+        PHAssetResourceManager.default().requestData(for: resource, options: options, dataReceivedHandler: { (data) in
+            self.fileHandle.write(data)
+        }, completionHandler: { (error) in
+            self.appendString("\r\n")
+            completionHandler(error as NSError?)
+        })
+    }
+    
+    /// Appends a file part with the image encoded as JPEG. The encoder writes directly to the form.
+    func appendFile(_ name: String, image: UIImage) throws {
+        guard let cgImage = image.cgImage else {
+            throw NSError.imgurKitError(400, message: "Image data missing")
+        }
+        self.beginFile(name, filename: "file.jpg", mimeType: "image/jpeg")
+        
+        var callbacks = CGDataConsumerCallbacks(putBytes: { (info, buffer, count) -> Int in
+            let fileHandle = Unmanaged<FileHandle>.fromOpaque(info!).takeUnretainedValue()
+            fileHandle.write(Data(bytes: buffer, count: count))
+            return count
+        }, releaseConsumer: nil)
+        guard let consumer = CGDataConsumer(info: Unmanaged.passUnretained(self.fileHandle).toOpaque(), cbks: &callbacks),
+            let destination = CGImageDestinationCreateWithDataConsumer(consumer, kUTTypeJPEG, 1, nil) else {
+            throw NSError.imgurKitError(500, message: "Could not encode image")
+        }
+        let properties: [CFString: Any] = [
+            kCGImageDestinationLossyCompressionQuality: 1.0,
+            kCGImagePropertyOrientation: ImgurMultipartFormWriter.propertyOrientation(image.imageOrientation).rawValue
+        ]
+        CGImageDestinationAddImage(destination, cgImage, properties as CFDictionary)
+        guard CGImageDestinationFinalize(destination) else {
+            throw NSError.imgurKitError(500, message: "Could not encode image")
+        }
+        self.appendString("\r\n")
+    }
+    
+    /// Writes the end boundary and closes the file. Returns the size of the form in bytes.
+    @discardableResult
+    func finish() -> UInt64 {
+        self.appendString("--\(self.boundary)--\r\n")
+        let length = self.fileHandle.offsetInFile
+        self.fileHandle.closeFile()
+        self.isFinished = true
+        return length
+    }
+    
+    func removeFile() {
+        if !self.isFinished {
+            self.fileHandle.closeFile()
+            self.isFinished = true
+        }
+        try? FileManager.default.removeItem(at: self.fileURL)
+    }
+    
+    fileprivate func beginFile(_ name: String, filename: String, mimeType: String) {
+        self.appendString("--\(self.boundary)\r\n")
+        self.appendString("Content-Disposition: form-data; name=\"\(name)\"; filename=\"\(filename)\"\r\n")
+        self.appendString("Content-Type: \(mimeType)\r\n\r\n")
+    }
+    
+    fileprivate func appendString(_ string: String) {
+        self.fileHandle.write(Data(string.utf8))
+    }
+    
+    fileprivate static func mimeType(_ uniformTypeIdentifier: String?) -> String {
+        guard let uniformTypeIdentifier = uniformTypeIdentifier, let mimeType = UTTypeCopyPreferredTagWithClass(uniformTypeIdentifier as CFString, kUTTagClassMIMEType)?.takeRetainedValue() else {
+            return "image/jpeg"
+        }
+        return mimeType as String
+    }
+    
+    fileprivate static func propertyOrientation(_ orientation: UIImage.Orientation) -> CGImagePropertyOrientation {
+        switch orientation {
+        case .up:
+            return .up
+        case .upMirrored:
+            return .upMirrored
+        case .down:
+            return .down
+        case .downMirrored:
+            return .downMirrored
+        case .left:
+            return .left
+        case .leftMirrored:
+            return .leftMirrored
+        case .right:
+            return .right
+        case .rightMirrored:
+            return .rightMirrored
+        @unknown default:
+            return .up
+        }
+    }
+    
+}
@@ -8,7 +8,6 @@
 
 import UIKit
 import Photos
-import MobileCoreServices
 
 public class ImgurUploadRequest: ImgurRequest {
 
@@ -30,46 +29,57 @@ public class ImgurUploadRequest: ImgurRequest {
     internal override func performRequest(_ completionHandler: @escaping ((_ resultObject: AnyObject?, _ error: NSError?) -> Void)) {
         self.updateDownloadProgress(0)
         self.updateUploadProgress(0)
+        
+        // The form is written to a file, so the image data never has to be in memory as a whole
+        let formWriter: ImgurMultipartFormWriter
+        do {
+            formWriter = try ImgurMultipartFormWriter(boundary: self.randomString() as String)
+        } catch let error as NSError {
+            completionHandler(nil, error)
+            return
+        }
+        if let parameters = self.parameters {
+            for (key, value) in parameters {
+                formWriter.appendParameter(key, value: value)
+            }
+        }
+        
         if let asset = self.asset {
-            let requestOptions = PHImageRequestOptions()
-            requestOptions.isNetworkAccessAllowed = true
-            PHImageManager.default().requestImageDataAndOrientation(for: asset, options: requestOptions) { (imageData, dataUTI, _, userInfo) in
-                if let imageData = imageData, let dataUTI = dataUTI {
-                    var mimeType: String = "image/jpeg"
-                    if let dataMimeType = self.convertCFTypeToString(UTTypeCopyPreferredTagWithClass(dataUTI as CFString, kUTTagClassMIMEType)) {
-                        mimeType = dataMimeType
-                    }
-                    self.startUpload(imageData, mimeType: mimeType, completionHandler: completionHandler)
+            formWriter.appendFile("image", asset: asset) { (error) in
+                if let error = error {
+                    formWriter.removeFile()
+                    completionHandler(nil, error)
                 } else {
-                    completionHandler(nil, userInfo![PHImageErrorKey] as? NSError)
+                    self.startUpload(formWriter, completionHandler: completionHandler)
                 }
             }
         } else if let image = self.image {
-            self.startUpload(image.jpegData(compressionQuality: 1.0)!, mimeType: "image/jpeg", completionHandler: completionHandler)
+            do {
+                try formWriter.appendFile("image", image: image)
+            } catch let error as NSError {
+                formWriter.removeFile()
+                completionHandler(nil, error)
+                return
+            }
+            self.startUpload(formWriter, completionHandler: completionHandler)
         } else {
             fatalError("Image missing!")
         }
     }
     
-    fileprivate func convertCFTypeToString(_ CFValue: Unmanaged<CFString>?) -> String? {
-        guard CFValue != nil else {
-            return nil
+    fileprivate func startUpload(_ formWriter: ImgurMultipartFormWriter, completionHandler: @escaping ((_ resultObject: AnyObject?, _ error: NSError?) -> Void)) {
+        formWriter.finish()
+        guard !self.isCancelled else {
+            formWriter.removeFile()
+            completionHandler(nil, nil)
+            return
         }
         
-        let value = Unmanaged.fromOpaque(
-            CFValue!.toOpaque()).takeUnretainedValue() as CFString
-        if CFGetTypeID(value) == CFStringGetTypeID() {
-            return value as String
-        } else {
-            return nil
-        }
-    }
-    
-    fileprivate func startUpload(_ imageData: Data, mimeType: String, completionHandler: @escaping ((_ resultObject: AnyObject?, _ error: NSError?) -> Void)) {
-        let mutableRequest = (self.URLRequest as NSURLRequest).mutableCopy() as! NSMutableURLRequest
-        let multiPartFormInformation = self.multiPartFormInformation(imageData)
-        mutableRequest.setValue("multipart/form-data; boundary=\(multiPartFormInformation.boundaryString)", forHTTPHeaderField: "Content-Type")
-        self.currentTask = self.session.uploadTask(with: mutableRequest as URLRequest, from: multiPartFormInformation.data, completionHandler: { (data, response, error) in
+        var request = self.URLRequest
+        request.httpBody = nil
+        request.setValue(formWriter.contentType, forHTTPHeaderField: "Content-Type")
+        self.currentTask = self.session.uploadTask(with: request, fromFile: formWriter.fileURL, completionHandler: { (data, response, error) in
+            formWriter.removeFile()
             if self.isCancelled {
                 self.removeProgressObservers()
                 completionHandler(nil, nil)
@@ -93,36 +103,6 @@ public class ImgurUploadRequest: ImgurRequest {
         self.currentTask!.resume()
     }
     
-    fileprivate func multiPartFormInformation(_ imageData: Data?) -> (data: Data, boundaryString: NSString) {
-        let boundaryString = self.randomString()
-        
-        let body = NSMutableData()
-        
-        //Add parameters is available
-        if let parameters = self.parameters {
-            for (key, value) in parameters {
-                body.appendString("--\(boundaryString)\r\n")
-                body.appendString("Content-Disposition: form-data; name=\"\(key)\"\r\n\r\n")
-                body.appendString("\(value)\r\n")
-            }
-        }
-        
-        //Add the files
-        if let fileData = imageData {
-            let mimeType = "image/jpeg"
-            body.appendString("--\(boundaryString)\r\n")
-            body.appendString("Content-Disposition: form-data; name=\"image\"; filename=\"file.jpg\"\r\n")
-            body.appendString("Content-Type: \(mimeType)\r\n\r\n")
-            body.append(fileData)
-            body.appendString("\r\n")
-        }
-        
-        //Add the end boundary
-        body.appendString("--\(boundaryString)--\r\n")
-        
-        return (data: body as Data, boundaryString: boundaryString)
-    }
-    
     fileprivate func randomString(withLength length: Int = 12) -> NSString {
         let letters: NSString = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
         
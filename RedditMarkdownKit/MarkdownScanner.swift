@@ -0,0 +1,566 @@
+//
+//  MarkdownScanner.swift
+//  RedditMarkdownKit
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import Foundation
+
+/// A single-pass tokenizer for reddit markdown. It produces the same base string and elements as the regular expression parser of MarkdownString, but walks the UTF-16 code units only once. Elements are mapped directly onto the output string, so no elements have to be moved after a replacement.
+///
+/// The scanner does not copy a few quirks of the regular expression parser:
+/// - Adjacent emphasis (`**a** **b**`) results in two elements instead of one.
+/// - Elements containing other markup get the length of the visible text.
+/// - Duplicate lines are parsed at their own location instead of the location of the first occurrence.
+/// - Link texts are not checked for raw links.
+internal final class MarkdownScanner {
+    
+    private struct Checkpoint {
+        let outputCount: Int
+        let elementsCount: Int
+        let linkCount: Int
+        let rawLinkIndex: Int
+    }
+    
+    /// A forward search over the input. The result only depends on the start of the search, so a later search with the same key can reuse it.
+    private enum SearchKey: Hashable {
+        /// A closing emphasis delimiter of the given length, followed by a boundary.
+        case emphasisCloser(length: Int, limit: Int, endIsBoundary: Bool)
+        /// A single character, like the closing bracket of a link.
+        case character(unichar, limit: Int)
+    }
+    
+    private struct Search {
+        let start: Int
+        let match: Int?
+    }
+    
+    private enum CodeUnit {
+        static let asterisk: unichar = 0x2A
+        static let underscore: unichar = 0x5F
+        static let tilde: unichar = 0x7E
+        static let backtick: unichar = 0x60
+        static let caret: unichar = 0x5E
+        static let dash: unichar = 0x2D
+        static let space: unichar = 0x20
+        static let slash: unichar = 0x2F
+        static let openingBracket: unichar = 0x5B
+        static let closingBracket: unichar = 0x5D
+        static let openingParenthesis: unichar = 0x28
+        static let closingParenthesis: unichar = 0x29
+    }
+    
+    /// The line prefixes in the order the regular expression parser checks them.
+    private static let linePrefixes: [(prefix: [unichar], type: MarkdownElementType, replacement: [unichar])] = [
+        (Array("######".utf16), MarkdownElementType.underline, []),
+        (Array("#####".utf16), MarkdownElementType.h5, []),
+        (Array("####".utf16), MarkdownElementType.h4, []),
+        (Array("###".utf16), MarkdownElementType.h3, []),
+        (Array("##".utf16), MarkdownElementType.h2, []),
+        (Array("#".utf16), MarkdownElementType.h1, []),
+        (Array(">".utf16), MarkdownElementType.quote, []),
+        (Array("* ".utf16), MarkdownElementType.unorderedListElement, Array("• ".utf16)),
+        (Array("- ".utf16), MarkdownElementType.unorderedListElement, Array("• ".utf16))
+    ]
+    
+    private static let codePrefix = Array("    ".utf16)
+    
+    private static let linkDetector: NSDataDetector? = {
+        do {
+            return try NSDataDetector(types: NSTextCheckingResult.CheckingType.link.rawValue)
+        } catch {
+            NSLog("Error setting up link data detector in MarkdownScanner: %@", error as NSError)
+            return nil
+        }
+    }()
+    
+    private let string: String
+    private let input: [unichar]
+    private let autoDetectLinks: Bool
+    
+    private var output = [unichar]()
+    private var elements = [MarkdownElement]()
+    
+    /// The number of markdown and raw links that have been emitted. Markup containing a link is not parsed, just like the regular expression parser.
+    private var linkCount = 0
+    
+    /// Links found by the data detector, sorted by location in the input.
+    private var rawLinks = [(range: NSRange, url: URL?)]()
+    private var rawLinkIndex = 0
+    
+    /// The last search for every key. Without these, every unmatched delimiter would search until the end of the line again.
+    private var searches = [SearchKey: Search]()
+    
+    init(string: String, autoDetectLinks: Bool) {
+        self.string = string
+        self.input = Array(string.utf16)
+        self.autoDetectLinks = autoDetectLinks
+    }
+    
+    // MARK: - Scanning
+    
+    /// Scans the complete input and returns the string without markdown syntax, together with the elements mapped onto that string.
+    func scan() -> (baseString: NSMutableString, elements: [MarkdownElement]) {
+        output.reserveCapacity(input.count)
+        if autoDetectLinks {
+            detectRawLinks()
+        }
+        
+        var lineStart = 0
+        while lineStart <= input.count {
+            var lineEnd = lineStart
+            while lineEnd < input.count && !isNewline(input[lineEnd]) {
+                lineEnd += 1
+            }
+            scanLine(lineStart..<lineEnd)
+            if lineEnd < input.count {
+                output.append(input[lineEnd])
+            }
+            lineStart = lineEnd + 1
+        }
+        
+        let baseString = NSMutableString(characters: output, length: output.count)
+        return (baseString, elements)
+    }
+    
+    private func detectRawLinks() {
+        guard let detector = MarkdownScanner.linkDetector else {
+            return
+        }
+        let nsString = string as NSString
+        rawLinks = detector.matches(in: string, options: [], range: NSRange(location: 0, length: input.count)).map({ (match: NSTextCheckingResult) -> (range: NSRange, url: URL?) in
+            return (match.range, MarkdownString.rawLinkURL(nsString.substring(with: match.range)))
+        })
+    }
+    
+    // MARK: Line elements
+    
+    private func scanLine(_ line: Range<Int>) {
+        var trimmedEnd = line.upperBound
+        while trimmedEnd > line.lowerBound && isWhitespace(input[trimmedEnd - 1], includingNewlines: false) {
+            trimmedEnd -= 1
+        }
+        let trimmedLine = line.lowerBound..<trimmedEnd
+        let outputLineStart = output.count
+        
+        if isHorizontalLine(trimmedLine) {
+            var element = MarkdownElement(range: NSRange(location: outputLineStart, length: 0), type: MarkdownElementType.horizontalLine)
+            element.isLineElement = true
+            elements.append(element)
+            output.append(contentsOf: input[trimmedEnd..<line.upperBound])
+            return
+        }
+        
+        if hasPrefix(MarkdownScanner.codePrefix, in: trimmedLine) {
+            // The regular expression parser anchors code elements on the prefix instead of the code itself.
+            let prefixLength = MarkdownScanner.codePrefix.count
+            var element = MarkdownElement(range: NSRange(location: outputLineStart - prefixLength, length: trimmedLine.count - prefixLength), type: MarkdownElementType.code)
+            element.isLineElement = true
+            elements.append(element)
+            scanInline(line, startIsBoundary: true, endIsBoundary: true)
+            return
+        }
+        
+        for linePrefix in MarkdownScanner.linePrefixes where hasPrefix(linePrefix.prefix, in: trimmedLine) {
+            var contentStart = line.lowerBound + linePrefix.prefix.count
+            while contentStart < trimmedEnd && isWhitespace(input[contentStart], includingNewlines: false) {
+                contentStart += 1
+            }
+            let contentLength = trimmedEnd - contentStart
+            output.append(contentsOf: linePrefix.replacement)
+            
+            let elementIndex = elements.count
+            var element = MarkdownElement(range: NSRange(location: outputLineStart, length: contentLength), type: linePrefix.type)
+            element.isLineElement = true
+            elements.append(element)
+            
+            scanInline(contentStart..<line.upperBound, startIsBoundary: true, endIsBoundary: true)
+            
+            // Line elements never exceed the line after inline markup has been removed
+            elements[elementIndex].range.length = min(contentLength, output.count - outputLineStart)
+            return
+        }
+        
+        scanInline(line, startIsBoundary: true, endIsBoundary: true)
+    }
+    
+    /// Horizontal lines are lines that only contain at least 3 asterisks or dashes, optionally separated by spaces.
+    private func isHorizontalLine(_ line: Range<Int>) -> Bool {
+        var start = line.lowerBound
+        var end = line.upperBound
+        while start < end && isWhitespace(input[start], includingNewlines: true) {
+            start += 1
+        }
+        while end > start && isWhitespace(input[end - 1], includingNewlines: true) {
+            end -= 1
+        }
+        
+        var lineCharacter: unichar?
+        var count = 0
+        for index in start..<end where input[index] != CodeUnit.space {
+            let character = input[index]
+            guard character == CodeUnit.asterisk || character == CodeUnit.dash, lineCharacter == nil || lineCharacter == character else {
+                return false
+            }
+            lineCharacter = character
+            count += 1
+        }
+        return count >= 3
+    }
+    
+    // MARK: Inline elements
+    
+    /// Scans the given range of the input for inline elements and appends the visible text to the output.
+    /// - parameter startIsBoundary: If the start of the range counts as the start of a line or a whitespace for emphasis.
+    /// - parameter endIsBoundary: If the end of the range counts as the end of a line or a whitespace for emphasis.
+    private func scanInline(_ range: Range<Int>, startIsBoundary: Bool, endIsBoundary: Bool) {
+        var index = range.lowerBound
+        while index < range.upperBound {
+            if let next = scanRawLink(at: index, in: range) {
+                index = next
+                continue
+            }
+            
+            let isAtBoundary = index == range.lowerBound ? startIsBoundary : isWhitespace(input[index - 1], includingNewlines: true)
+            var next: Int?
+            switch input[index] {
+            case CodeUnit.asterisk, CodeUnit.underscore:
+                if isAtBoundary {
+                    next = scanEmphasis(at: index, in: range, endIsBoundary: endIsBoundary)
+                }
+            case CodeUnit.tilde:
+                if isAtBoundary {
+                    next = scanEmphasizedLink(at: index, delimiter: CodeUnit.tilde, length: 2, type: MarkdownElementType.strikethrough, in: range, endIsBoundary: endIsBoundary)
+                }
+                if next == nil {
+                    next = scanStrikethrough(at: index, in: range)
+                }
+            case CodeUnit.openingBracket:
+                next = scanLink(at: index, in: range, type: MarkdownElementType.paragraph)
+            case CodeUnit.backtick:
+                next = scanInlineCode(at: index, in: range)
+            case CodeUnit.caret:
+                next = scanSuperscript(at: index, in: range)
+            default:
+                next = scanRedditLink(at: index, in: range)
+            }
+            
+            if let next = next {
+                index = next
+            } else {
+                output.append(input[index])
+                index += 1
+            }
+        }
+    }
+    
+    private func scanRawLink(at index: Int, in range: Range<Int>) -> Int? {
+        while rawLinkIndex < rawLinks.count && rawLinks[rawLinkIndex].range.location < index {
+            rawLinkIndex += 1
+        }
+        guard rawLinkIndex < rawLinks.count else {
+            return nil
+        }
+        let rawLink = rawLinks[rawLinkIndex]
+        let end = rawLink.range.location + rawLink.range.length
+        guard rawLink.range.location == index, end <= range.upperBound else {
+            return nil
+        }
+        rawLinkIndex += 1
+        
+        var element = MarkdownElement(range: NSRange(location: output.count, length: rawLink.range.length), type: MarkdownElementType.paragraph)
+        element.url = rawLink.url
+        elements.append(element)
+        linkCount += 1
+        output.append(contentsOf: input[index..<end])
+        return end
+    }
+    
+    private func scanEmphasis(at index: Int, in range: Range<Int>, endIsBoundary: Bool) -> Int? {
+        let types = [MarkdownElementType.boldItalic, MarkdownElementType.bold, MarkdownElementType.italic]
+        for (offset, type) in types.enumerated() {
+            let delimiterLength = types.count - offset
+            guard isDelimiter(at: index, length: delimiterLength, limit: range.upperBound) else {
+                continue
+            }
+            if let next = scanEmphasizedLink(at: index, delimiter: input[index], length: delimiterLength, type: type, in: range, endIsBoundary: endIsBoundary) {
+                return next
+            }
+            
+            let contentStart = index + delimiterLength
+            let key = SearchKey.emphasisCloser(length: delimiterLength, limit: range.upperBound, endIsBoundary: endIsBoundary)
+            let closerMatch = firstMatch(from: contentStart, limit: range.upperBound - delimiterLength + 1, key: key) { (closer) -> Bool in
+                return isDelimiter(at: closer, length: delimiterLength, limit: range.upperBound) && isBoundary(at: closer + delimiterLength, in: range, endIsBoundary: endIsBoundary)
+            }
+            guard let closer = closerMatch else {
+                continue
+            }
+            if emitMarkup(contentStart..<closer, type: type, startIsBoundary: true, endIsBoundary: true) {
+                return closer + delimiterLength
+            }
+        }
+        return nil
+    }
+    
+    /// Scans a link wrapped in emphasis delimiters, like `**[text](url)**`.
+    private func scanEmphasizedLink(at index: Int, delimiter: unichar, length: Int, type: MarkdownElementType, in range: Range<Int>, endIsBoundary: Bool) -> Int? {
+        let delimiters = delimiter == CodeUnit.tilde ? [CodeUnit.tilde] : [CodeUnit.asterisk, CodeUnit.underscore]
+        guard isDelimiter(at: index, length: length, limit: range.upperBound, characters: delimiters), let link = matchLink(at: index + length, in: range) else {
+            return nil
+        }
+        let closer = link.end
+        guard isDelimiter(at: closer, length: length, limit: range.upperBound, characters: delimiters), isBoundary(at: closer + length, in: range, endIsBoundary: endIsBoundary) else {
+            return nil
+        }
+        emitLink(text: link.text, url: link.url, type: type)
+        return closer + length
+    }
+    
+    private func scanLink(at index: Int, in range: Range<Int>, type: MarkdownElementType) -> Int? {
+        guard let link = matchLink(at: index, in: range) else {
+            return nil
+        }
+        emitLink(text: link.text, url: link.url, type: type)
+        return link.end
+    }
+    
+    /// Matches `[text](url)` or `[text] (url)` at the given index.
+    private func matchLink(at index: Int, in range: Range<Int>) -> (text: Range<Int>, url: Range<Int>, end: Int)? {
+        guard index < range.upperBound, input[index] == CodeUnit.openingBracket, let textEnd = firstIndex(of: CodeUnit.closingBracket, in: index + 1..<range.upperBound) else {
+            return nil
+        }
+        var urlOpening = textEnd + 1
+        if urlOpening < range.upperBound && isWhitespace(input[urlOpening], includingNewlines: true) {
+            urlOpening += 1
+        }
+        guard urlOpening < range.upperBound, input[urlOpening] == CodeUnit.openingParenthesis else {
+            return nil
+        }
+        let urlStart = urlOpening + 1
+        guard urlStart < range.upperBound, input[urlStart] != CodeUnit.closingParenthesis, let urlEnd = firstIndex(of: CodeUnit.closingParenthesis, in: urlStart..<range.upperBound) else {
+            return nil
+        }
+        return (index + 1..<textEnd, urlStart..<urlEnd, urlEnd + 1)
+    }
+    
+    private func emitLink(text: Range<Int>, url: Range<Int>, type: MarkdownElementType) {
+        let urlString = String(utf16CodeUnits: Array(input[url]), count: url.count).replacingOccurrences(of: " ", with: "%20")
+        var element = MarkdownElement(range: NSRange(location: output.count, length: text.count), type: type)
+        if urlString.hasPrefix("/r/") && MarkdownString.isRelativeRedditLink(urlString) {
+            //It's a link to a subreddit, parse it like a subreddit
+            element.url = URL(string: "\(MarkdownString.BeamInternalURLScheme)://\(urlString)/")
+        } else {
+            element.url = URL(string: urlString)
+        }
+        elements.append(element)
+        linkCount += 1
+        output.append(contentsOf: input[text])
+    }
+    
+    private func scanInlineCode(at index: Int, in range: Range<Int>) -> Int? {
+        // Inline code needs at least one character
+        guard index + 2 < range.upperBound, let closer = firstIndex(of: CodeUnit.backtick, in: index + 2..<range.upperBound) else {
+            return nil
+        }
+        return emitMarkup(index + 1..<closer, type: MarkdownElementType.inlineCode, startIsBoundary: false, endIsBoundary: false) ? closer + 1 : nil
+    }
+    
+    private func scanStrikethrough(at index: Int, in range: Range<Int>) -> Int? {
+        guard isDelimiter(at: index, length: 2, limit: range.upperBound, characters: [CodeUnit.tilde]) else {
+            return nil
+        }
+        var closer = index + 2
+        while closer + 2 <= range.upperBound && !(input[closer] == CodeUnit.tilde && input[closer + 1] == CodeUnit.tilde) {
+            closer += 1
+        }
+        guard closer + 2 <= range.upperBound else {
+            return nil
+        }
+        return emitMarkup(index + 2..<closer, type: MarkdownElementType.strikethrough, startIsBoundary: false, endIsBoundary: false) ? closer + 2 : nil
+    }
+    
+    /// Scans `^(superscript text)` or `^superscript` until the next word boundary.
+    private func scanSuperscript(at index: Int, in range: Range<Int>) -> Int? {
+        if index + 1 < range.upperBound && input[index + 1] == CodeUnit.openingParenthesis {
+            if let closer = firstIndex(of: CodeUnit.closingParenthesis, in: index + 2..<range.upperBound) {
+                return emitMarkup(index + 2..<closer, type: MarkdownElementType.superscript, startIsBoundary: false, endIsBoundary: false) ? closer + 1 : nil
+            }
+        }
+        
+        var end = index + 2
+        while end <= range.upperBound {
+            let nextIsWordCharacter = end < input.count && isWordCharacter(input[end])
+            if isWordCharacter(input[end - 1]) != nextIsWordCharacter {
+                return emitMarkup(index + 1..<end, type: MarkdownElementType.superscript, startIsBoundary: false, endIsBoundary: false) ? end : nil
+            }
+            end += 1
+        }
+        return nil
+    }
+    
+    /// Scans r/subreddit and u/user links. Just like the regular expression parser, the element includes the preceding whitespace.
+    private func scanRedditLink(at index: Int, in range: Range<Int>) -> Int? {
+        switch input[index] {
+        case CodeUnit.slash, 0x52, 0x55, 0x72, 0x75:
+            break
+        default:
+            return nil
+        }
+        
+        let elementStart: Int
+        if let previous = output.last {
+            guard isWhitespace(previous, includingNewlines: true) else {
+                return nil
+            }
+            elementStart = output.count - 1
+        } else {
+            elementStart = 0
+        }
+        
+        var typeIndex = index
+        if input[typeIndex] == CodeUnit.slash {
+            typeIndex += 1
+        }
+        guard typeIndex + 1 < range.upperBound, input[typeIndex + 1] == CodeUnit.slash, let scalar = UnicodeScalar(input[typeIndex]) else {
+            return nil
+        }
+        let host: String
+        switch Character(scalar).lowercased() {
+        case "r":
+            host = "subreddit"
+        case "u":
+            host = "user"
+        default:
+            return nil
+        }
+        
+        let nameStart = typeIndex + 2
+        var nameEnd = nameStart
+        while nameEnd < range.upperBound && nameEnd - nameStart < 21 && isRedditNameCharacter(input[nameEnd]) {
+            nameEnd += 1
+        }
+        guard nameEnd - nameStart >= 3 else {
+            return nil
+        }
+        
+        output.append(contentsOf: input[index..<nameEnd])
+        let displayName = String(utf16CodeUnits: Array(input[nameStart..<nameEnd]), count: nameEnd - nameStart)
+        var element = MarkdownElement(range: NSRange(location: elementStart, length: output.count - elementStart), type: MarkdownElementType.paragraph)
+        element.url = URL(string: "\(MarkdownString.BeamInternalURLScheme)://\(host)/\(displayName)/")
+        elements.append(element)
+        return nameEnd
+    }
+    
+    /// Scans the content of a markup element and adds the element. Markup containing links is not parsed, in which case all output of the content is reverted and false is returned.
+    private func emitMarkup(_ content: Range<Int>, type: MarkdownElementType, startIsBoundary: Bool, endIsBoundary: Bool) -> Bool {
+        let checkpoint = Checkpoint(outputCount: output.count, elementsCount: elements.count, linkCount: linkCount, rawLinkIndex: rawLinkIndex)
+        scanInline(content, startIsBoundary: startIsBoundary, endIsBoundary: endIsBoundary)
+        
+        guard linkCount == checkpoint.linkCount else {
+            output.removeSubrange(checkpoint.outputCount..<output.count)
+            elements.removeSubrange(checkpoint.elementsCount..<elements.count)
+            linkCount = checkpoint.linkCount
+            rawLinkIndex = checkpoint.rawLinkIndex
+            return false
+        }
+        
+        elements.append(MarkdownElement(range: NSRange(location: checkpoint.outputCount, length: output.count - checkpoint.outputCount), type: type))
+        return true
+    }
+    
+    // MARK: - Character classes
+    
+    private func hasPrefix(_ prefix: [unichar], in range: Range<Int>) -> Bool {
+        guard range.count >= prefix.count else {
+            return false
+        }
+        for (offset, character) in prefix.enumerated() where input[range.lowerBound + offset] != character {
+            return false
+        }
+        return true
+    }
+    
+    /// Delimiters consist of one repeated character, for example `**` or `__` for bold text.
+    private func isDelimiter(at index: Int, length: Int, limit: Int, characters: [unichar] = [CodeUnit.asterisk, CodeUnit.underscore]) -> Bool {
+        guard index + length <= limit else {
+            return false
+        }
+        let character = input[index]
+        guard characters.contains(character) else {
+            return false
+        }
+        for offset in 1..<length where input[index + offset] != character {
+            return false
+        }
+        return true
+    }
+    
+    private func isBoundary(at index: Int, in range: Range<Int>, endIsBoundary: Bool) -> Bool {
+        guard index < range.upperBound else {
+            return endIsBoundary
+        }
+        return isWhitespace(input[index], includingNewlines: true)
+    }
+    
+    private func firstIndex(of character: unichar, in range: Range<Int>) -> Int? {
+        return firstMatch(from: range.lowerBound, limit: range.upperBound, key: SearchKey.character(character, limit: range.upperBound)) { (index) -> Bool in
+            return input[index] == character
+        }
+    }
+    
+    /// Returns the first index from the start up to the limit that matches the predicate. The predicate should only depend on the key.
+    ///
+    /// Delimiters are searched from left to right, so the previous search with the same key usually still holds: its match is also the first match from a later start, unless that start lies past the match. This way every code unit is checked about once per key, even if none of the delimiters are closed.
+    private func firstMatch(from start: Int, limit: Int, key: SearchKey, where predicate: (Int) -> Bool) -> Int? {
+        if let search = searches[key], search.start <= start, search.match.map({ $0 >= start }) ?? true {
+            return search.match
+        }
+        
+        var index = start
+        while index < limit && !predicate(index) {
+            index += 1
+        }
+        let match = index < limit ? index : nil
+        searches[key] = Search(start: start, match: match)
+        return match
+    }
+    
+    private func isNewline(_ character: unichar) -> Bool {
+        if character < 0x80 {
+            return character >= 0x0A && character <= 0x0D
+        }
+        guard let scalar = UnicodeScalar(character) else {
+            return false
+        }
+        return CharacterSet.newlines.contains(scalar)
+    }
+    
+    private func isWhitespace(_ character: unichar, includingNewlines: Bool) -> Bool {
+        if character < 0x80 {
+            return character == CodeUnit.space || character == 0x09 || (includingNewlines && character >= 0x0A && character <= 0x0D)
+        }
+        guard let scalar = UnicodeScalar(character) else {
+            return false
+        }
+        return includingNewlines ? CharacterSet.whitespacesAndNewlines.contains(scalar) : CharacterSet.whitespaces.contains(scalar)
+    }
+    
+    private func isWordCharacter(_ character: unichar) -> Bool {
+        guard let scalar = UnicodeScalar(character) else {
+            return false
+        }
+        return character == CodeUnit.underscore || CharacterSet.alphanumerics.contains(scalar)
+    }
+    
+    private func isRedditNameCharacter(_ character: unichar) -> Bool {
+        switch character {
+        case 0x30...0x39, 0x41...0x5A, 0x61...0x7A, CodeUnit.underscore:
+            return true
+        default:
+            return false
+        }
+    }
+    
+}
@@ -13,18 +13,41 @@ enum RedditLinkType {
     case user
 }
 
+/// The parsers that can analyze the markdown elements in a MarkdownString.
+public enum MarkdownParser {
+    /// Parses every element type with a regular expression over the complete string.
+    case regularExpressions
+    /// Parses all element types in a single pass over the string, see MarkdownScanner.
+    case scanner
+}
+
 /// A string with mapped MarkDown elements in it. This can be converted to an NSAttributedString using a MarkdownStylesheet struct. The stylesheet will contain all the visual elements like fonts, colors, etc. This makes it possible to use an analyzed markdown string in multiple places in your app without reparsing for a different layout.
-public class MarkdownString: NSObject, NSSecureCoding {
+public class MarkdownString: NSObject, NSSecureCoding, NSCopying {
     
     static let BeamInternalURLScheme = "beamwtf"
     
+    /// The parser that is used for new MarkdownStrings when no parser is given.
+    public static var defaultParser = MarkdownParser.regularExpressions
+    
+    fileprivate static let relativeRedditLinkExpression: NSRegularExpression? = {
+        do {
+            return try NSRegularExpression(pattern: "(?:^|\\s)/?r/([a-z0-9]{3,21})(?:/comments|/\\s|\\s)", options: [NSRegularExpression.Options.anchorsMatchLines, NSRegularExpression.Options.caseInsensitive])
+        } catch {
+            NSLog("Relative reddit link expression failed \(error)")
+            return nil
+        }
+    }()
+    
     // MARK: - Properties
     
     /// The string where MarkDown elements are mapped onto.
     fileprivate (set) public var baseString: NSMutableString
     
     /// All markdown elements that exist in the baseString.
-    fileprivate var elements: [MarkdownElement]
+    fileprivate (set) internal var elements: [MarkdownElement]
+    
+    /// The parser that analyzed the elements in the baseString.
+    fileprivate (set) public var parser: MarkdownParser
     
     /// A boolean to decide whether to
     public var autoDetectLinks: Bool {
@@ -37,18 +60,35 @@ public class MarkdownString: NSObject, NSSecureCoding {
     // MARK: - Lifecycle
     
     /// Initializes a MarkdownString based on the given String. The MarkdownString constructor will instantly analyze the contents for markdown elements, so be sure to initialize on a background queue whenever possible.
-    public init(string: String, autoDetectLinks: Bool = true) {
+    public init(string: String, autoDetectLinks: Bool = true, parser: MarkdownParser = MarkdownString.defaultParser) {
         baseString = NSMutableString(string: string)
         self.elements = [MarkdownElement]()
         self.autoDetectLinks = autoDetectLinks
+        self.parser = parser
         super.init()
         self.parseElements()
     }
     
+    /// Initializes a MarkdownString with elements that have already been analyzed.
+    fileprivate init(baseString: NSMutableString, elements: [MarkdownElement], autoDetectLinks: Bool, parser: MarkdownParser) {
+        self.baseString = baseString
+        self.elements = elements
+        self.autoDetectLinks = autoDetectLinks
+        self.parser = parser
+        super.init()
+    }
+    
     override public var description: String {
         return baseString as String
     }
     
+    // MARK: - NSCopying
+    
+    /// Returns a MarkdownString with the same elements, without analyzing the string again. Changing `autoDetectLinks` of the copy doesn't change the original.
+    public func copy(with zone: NSZone? = nil) -> Any {
+        return MarkdownString(baseString: NSMutableString(string: self.baseString as String), elements: self.elements, autoDetectLinks: self.autoDetectLinks, parser: self.parser)
+    }
+    
     // MARK: - NSSecureCoding
     
     public class var supportsSecureCoding: Bool {
@@ -73,10 +113,12 @@ public class MarkdownString: NSObject, NSSecureCoding {
         }
         self.autoDetectLinks = aDecoder.decodeBool(forKey: "autodetectLinks")
         self.elements = [MarkdownElement]()
+        self.parser = MarkdownString.defaultParser
         
         super.init()
         
-        if let codedElements = aDecoder.decodeObject(of: NSArray.self, forKey: "elements") as? [[NSString: AnyObject]] {
+        let elementClasses = [NSArray.self, NSDictionary.self, NSString.self, NSNumber.self, NSURL.self]
+        if let codedElements = aDecoder.decodeObject(of: elementClasses, forKey: "elements") as? [[NSString: AnyObject]] {
             self.elements = codedElements.map({ (element: [NSString: AnyObject]) -> MarkdownElement in
                 return MarkdownElement.decode(element, baseString: baseString)
             })
@@ -128,9 +170,16 @@ public class MarkdownString: NSObject, NSSecureCoding {
     
     fileprivate func parseElements() {
         if (baseString as NSString).rangeOfCharacter(from: MarkdownString.markdownCharacters).location != NSNotFound {
-            self.parseLineElements()
-            self.parseInlineElements()
-            self.updateLineElements()
+            switch self.parser {
+            case .scanner:
+                let result = MarkdownScanner(string: baseString as String, autoDetectLinks: autoDetectLinks).scan()
+                self.baseString.setString(result.baseString as String)
+                self.elements += result.elements
+            case .regularExpressions:
+                self.parseLineElements()
+                self.parseInlineElements()
+                self.updateLineElements()
+            }
         } else if autoDetectLinks {
             self.elements += parseRawLinkElements()
         }
@@ -306,15 +355,7 @@ public class MarkdownString: NSObject, NSSecureCoding {
             let dataDetector = try NSDataDetector(types: NSTextCheckingResult.CheckingType.link.rawValue)
             return dataDetector.matches(in: baseString as String, options: [], range: NSRange(location: 0, length: self.baseString.length)).map({ (match: NSTextCheckingResult) -> MarkdownElement in
                 var element = MarkdownElement(range: match.range, type: MarkdownElementType.paragraph)
-                var urlString = baseString.substring(with: match.range)
-                
-                //This is a fix because dataDector does detect URL's with "www." as URL's, but doesn't transform them to "http://www."
-                //NSURL or NSURLComponents can not be used to fix this, because that will break it even more
-                if urlString.hasPrefix("http") == false && urlString.hasPrefix("www.") {
-                    urlString = "http://" + urlString
-                }
-                
-                element.url = URL(string: urlString)
+                element.url = MarkdownString.rawLinkURL(baseString.substring(with: match.range))
                 return element
             })
             
@@ -325,6 +366,19 @@ public class MarkdownString: NSObject, NSSecureCoding {
         return [MarkdownElement]()
     }
     
+    /// Creates the URL for a link found by the data detector.
+    internal static func rawLinkURL(_ string: String) -> URL? {
+        var urlString = string
+        
+        //This is a fix because dataDector does detect URL's with "www." as URL's, but doesn't transform them to "http://www."
+        //NSURL or NSURLComponents can not be used to fix this, because that will break it even more
+        if urlString.hasPrefix("http") == false && urlString.hasPrefix("www.") {
+            urlString = "http://" + urlString
+        }
+        
+        return URL(string: urlString)
+    }
+    
     fileprivate func elementsAtRange(_ range: NSRange) -> [MarkdownElement] {
         return self.elements.filter({ NSIntersectionRange(range, $0.range).length != 0 })
     }
@@ -333,14 +387,11 @@ public class MarkdownString: NSObject, NSSecureCoding {
         return self.elementsAtRange(range).filter({ $0.url != nil  }).count > 0
     }
     
-    fileprivate func isRelativeRedditLink(_ string: String) -> Bool {
-        do {
-            let regularExpression = try NSRegularExpression(pattern: "(?:^|\\s)/?r/([a-z0-9]{3,21})(?:/comments|/\\s|\\s)", options: [NSRegularExpression.Options.anchorsMatchLines, NSRegularExpression.Options.caseInsensitive])
-            return regularExpression.matches(in: string, options: [], range: NSRange(location: 0, length: (string as NSString).length)).count > 0
-        } catch {
-            NSLog("Relative reddit link expression failed \(error)")
+    internal static func isRelativeRedditLink(_ string: String) -> Bool {
+        guard let regularExpression = MarkdownString.relativeRedditLinkExpression else {
             return false
         }
+        return regularExpression.firstMatch(in: string, options: [], range: NSRange(location: 0, length: (string as NSString).length)) != nil
     }
     
     fileprivate func parseLinkElements(_ pattern: String, elementType: MarkdownElementType = MarkdownElementType.paragraph) -> [MarkdownElement] {
@@ -358,7 +409,7 @@ public class MarkdownString: NSObject, NSSecureCoding {
                     urlString = urlString.replacingOccurrences(of: " ", with: "%20")
                     var url = URL(string: urlString)
                     
-                    if urlString.hasPrefix("/r/") && self.isRelativeRedditLink(urlString) {
+                    if urlString.hasPrefix("/r/") && MarkdownString.isRelativeRedditLink(urlString) {
                         
                         //It's a link to a subreddit, parse it like a subreddit
                         url = URL(string: "\(MarkdownString.BeamInternalURLScheme)://\(urlString)/")
@@ -0,0 +1,242 @@
+//
+//  MarkdownStringCache.swift
+//  RedditMarkdownKit
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import Foundation
+import CryptoKit
+
+/// A persistent cache of parsed MarkdownStrings, so the same content never has to be parsed twice. MarkdownStrings are stored on disk using NSSecureCoding, keyed by a hash of the content and the parser that was used. When the cache exceeds its byte limit, the least recently used MarkdownStrings are removed.
+public final class MarkdownStringCache {
+    
+    /// The version of the parsed output. Increase this number whenever a change in a parser changes the base string or the elements, so MarkdownStrings parsed by an older version are not used anymore.
+    public static let parserVersion = 1
+    
+    public static let shared = MarkdownStringCache()
+    
+    private struct Entry {
+        var byteCount: Int
+        var accessDate: Date
+    }
+    
+    /// The directory containing the cached MarkdownStrings of the current parser version.
+    public let directoryURL: URL
+    
+    /// The maximum number of bytes the cache can use on disk.
+    public var byteLimit: Int {
+        didSet {
+            self.ioQueue.async {
+                self.trimToByteLimit()
+            }
+        }
+    }
+    
+    private let memoryCache = NSCache<NSString, MarkdownString>()
+    private let ioQueue = DispatchQueue(label: "com.madeawkward.markdown-string-cache")
+    
+    /// The entries on disk by key, only accessed on the ioQueue. This index is loaded lazily from the directory.
+    private var entries: [String: Entry]?
+    private var totalByteCount = 0
+    
+    public init(directoryURL: URL? = nil, byteLimit: Int = 20 * 1024 * 1024) {
+        let cachesDirectory = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first ?? FileManager.default.temporaryDirectory
+        let baseDirectory = directoryURL ?? cachesDirectory.appendingPathComponent("MarkdownStrings", isDirectory: true)
+        self.directoryURL = baseDirectory.appendingPathComponent("v\(MarkdownStringCache.parserVersion)", isDirectory: true)
+        self.byteLimit = byteLimit
+        self.memoryCache.totalCostLimit = 5 * 1024 * 1024
+        
+        self.ioQueue.async {
+            self.removeOutdatedVersions(in: baseDirectory)
+        }
+    }
+    
+    // MARK: - Accessing MarkdownStrings
+    
+    /// Returns the parsed MarkdownString for the given content. If the content has not been parsed before, it will be parsed and stored in the cache.
+    ///
+    /// Every call returns a copy, so changing the returned MarkdownString doesn't change the MarkdownString of other callers. Reading from disk blocks until the file has been read, pass false for `readsFromDisk` on the main thread. The content is then parsed when it is not in memory, prefetching on a background queue reads it from disk instead.
+    public func markdownString(for content: String, autoDetectLinks: Bool = true, parser: MarkdownParser = MarkdownString.defaultParser, readsFromDisk: Bool = true) -> MarkdownString {
+        let cachedMarkdownString = readsFromDisk ? self.cachedMarkdownString(for: content, autoDetectLinks: autoDetectLinks, parser: parser) : self.memoryMarkdownString(for: content, autoDetectLinks: autoDetectLinks, parser: parser)
+        if let markdownString = cachedMarkdownString {
+            return markdownString
+        }
+        let markdownString = MarkdownString(string: content, autoDetectLinks: autoDetectLinks, parser: parser)
+        self.store(markdownString, for: content, autoDetectLinks: autoDetectLinks, parser: parser)
+        return markdownString
+    }
+    
+    /// Returns a copy of the MarkdownString for the given content if it is in memory. This doesn't touch the disk, so it can be used on the main thread.
+    public func memoryMarkdownString(for content: String, autoDetectLinks: Bool = true, parser: MarkdownParser = MarkdownString.defaultParser) -> MarkdownString? {
+        let key = self.key(for: content, autoDetectLinks: autoDetectLinks, parser: parser)
+        guard let markdownString = self.memoryCache.object(forKey: key as NSString) else {
+            return nil
+        }
+        self.ioQueue.async {
+            self.entries?[key]?.accessDate = Date()
+        }
+        return markdownString.copy() as? MarkdownString
+    }
+    
+    /// Returns a copy of the MarkdownString for the given content from memory or disk, without parsing the content. Reading from disk blocks, so this shouldn't be used on the main thread.
+    public func cachedMarkdownString(for content: String, autoDetectLinks: Bool = true, parser: MarkdownParser = MarkdownString.defaultParser) -> MarkdownString? {
+        if let markdownString = self.memoryMarkdownString(for: content, autoDetectLinks: autoDetectLinks, parser: parser) {
+            return markdownString
+        }
+        
+        let key = self.key(for: content, autoDetectLinks: autoDetectLinks, parser: parser)
+        let data: Data? = self.ioQueue.sync {
+            guard self.loadEntriesIfNeeded()[key] != nil else {
+                return nil
+            }
+            let fileURL = self.fileURL(for: key)
+            guard let data = try? Data(contentsOf: fileURL) else {
+                self.removeEntry(for: key)
+                return nil
+            }
+            self.touchEntry(for: key, fileURL: fileURL)
+            return data
+        }
+        guard let archivedData = data else {
+            return nil
+        }
+        
+        do {
+            guard let markdownString = try NSKeyedUnarchiver.unarchivedObject(ofClass: MarkdownString.self, from: archivedData) else {
+                return nil
+            }
+            self.memoryCache.setObject(markdownString, forKey: key as NSString, cost: markdownString.baseString.length * 2)
+            return markdownString.copy() as? MarkdownString
+        } catch {
+            NSLog("Could not decode cached MarkdownString: %@", error as NSError)
+            self.ioQueue.async {
+                self.removeEntry(for: key)
+            }
+            return nil
+        }
+    }
+    
+    /// Stores a copy of the parsed MarkdownString for the given content. The MarkdownString is archived and written to disk asynchronously, unless it is already on disk.
+    public func store(_ markdownString: MarkdownString, for content: String, autoDetectLinks: Bool = true, parser: MarkdownParser = MarkdownString.defaultParser) {
+        let key = self.key(for: content, autoDetectLinks: autoDetectLinks, parser: parser)
+        // The cached MarkdownString is never handed out, so it can't be changed while it is being archived
+        guard let cachedMarkdownString = markdownString.copy() as? MarkdownString else {
+            return
+        }
+        self.memoryCache.setObject(cachedMarkdownString, forKey: key as NSString, cost: cachedMarkdownString.baseString.length * 2)
+        
+        self.ioQueue.async {
+            if self.loadEntriesIfNeeded()[key] != nil {
+                self.touchEntry(for: key, fileURL: self.fileURL(for: key))
+                return
+            }
+            
+            let data: Data
+            do {
+                data = try NSKeyedArchiver.archivedData(withRootObject: cachedMarkdownString, requiringSecureCoding: true)
+                try FileManager.default.createDirectory(at: self.directoryURL, withIntermediateDirectories: true, attributes: nil)
+                try data.write(to: self.fileURL(for: key), options: [.atomic])
+            } catch {
+                NSLog("Could not write MarkdownString to the cache: %@", error as NSError)
+                return
+            }
+            self.totalByteCount += data.count
+            self.entries?[key] = Entry(byteCount: data.count, accessDate: Date())
+            self.trimToByteLimit()
+        }
+    }
+    
+    /// Removes all MarkdownStrings from memory and disk.
+    public func removeAll() {
+        self.memoryCache.removeAllObjects()
+        self.ioQueue.async {
+            try? FileManager.default.removeItem(at: self.directoryURL)
+            self.entries = [String: Entry]()
+            self.totalByteCount = 0
+        }
+    }
+    
+    /// The number of bytes the cached MarkdownStrings use on disk.
+    public var byteCount: Int {
+        return self.ioQueue.sync {
+            _ = self.loadEntriesIfNeeded()
+            return self.totalByteCount
+        }
+    }
+    
+    // MARK: - Keys
+    
+    private func key(for content: String, autoDetectLinks: Bool, parser: MarkdownParser) -> String {
+        let digest = SHA256.hash(data: Data(content.utf8))
+        let hash = digest.map { String(format: "%02x", $0) }.joined()
+        return "\(parser)-\(autoDetectLinks ? 1 : 0)-\(hash)"
+    }
+    
+    private func fileURL(for key: String) -> URL {
+        return self.directoryURL.appendingPathComponent(key, isDirectory: false)
+    }
+    
+    // MARK: - Disk index (ioQueue only)
+    
+    private func loadEntriesIfNeeded() -> [String: Entry] {
+        if let entries = self.entries {
+            return entries
+        }
+        
+        var entries = [String: Entry]()
+        var totalByteCount = 0
+        let resourceKeys: [URLResourceKey] = [.fileSizeKey, .contentModificationDateKey]
+        let fileURLs = (try? FileManager.default.contentsOfDirectory(at: self.directoryURL, includingPropertiesForKeys: resourceKeys, options: [.skipsHiddenFiles])) ?? []
+        for fileURL in fileURLs {
+            guard let values = try? fileURL.resourceValues(forKeys: Set(resourceKeys)) else {
+                continue
+            }
+            let byteCount = values.fileSize ?? 0
+            entries[fileURL.lastPathComponent] = Entry(byteCount: byteCount, accessDate: values.contentModificationDate ?? Date.distantPast)
+            totalByteCount += byteCount
+        }
+        self.entries = entries
+        self.totalByteCount = totalByteCount
+        return entries
+    }
+    
+    /// Marks the entry as recently used. The modification date of the file is used as the access date, so the order survives a relaunch.
+    private func touchEntry(for key: String, fileURL: URL) {
+        let now = Date()
+        self.entries?[key]?.accessDate = now
+        try? FileManager.default.setAttributes([FileAttributeKey.modificationDate: now], ofItemAtPath: fileURL.path)
+    }
+    
+    private func removeEntry(for key: String) {
+        try? FileManager.default.removeItem(at: self.fileURL(for: key))
+        if let entry = self.entries?.removeValue(forKey: key) {
+            self.totalByteCount -= entry.byteCount
+        }
+    }
+    
+    /// Removes the least recently used MarkdownStrings until the cache uses three quarters of the byte limit.
+    private func trimToByteLimit() {
+        guard self.totalByteCount > self.byteLimit, let entries = self.entries else {
+            return
+        }
+        let targetByteCount = self.byteLimit / 4 * 3
+        let sortedKeys = entries.keys.sorted { (entries[$0]?.accessDate ?? Date.distantPast) < (entries[$1]?.accessDate ?? Date.distantPast) }
+        for key in sortedKeys {
+            guard self.totalByteCount > targetByteCount else {
+                break
+            }
+            self.removeEntry(for: key)
+            self.memoryCache.removeObject(forKey: key as NSString)
+        }
+    }
+    
+    private func removeOutdatedVersions(in baseDirectory: URL) {
+        let directories = (try? FileManager.default.contentsOfDirectory(at: baseDirectory, includingPropertiesForKeys: nil, options: [.skipsHiddenFiles])) ?? []
+        for directory in directories where directory.lastPathComponent != self.directoryURL.lastPathComponent {
+            try? FileManager.default.removeItem(at: directory)
+        }
+    }
+    
+}
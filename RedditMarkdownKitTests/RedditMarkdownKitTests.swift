@@ -0,0 +1,166 @@
+//
+//  RedditMarkdownKitTests.swift
+//  RedditMarkdownKitTests
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import XCTest
+@testable import RedditMarkdownKit
+
+class RedditMarkdownKitTests: XCTestCase {
+    
+    /// Markdown samples that both parsers should parse to the same result. Replace or extend MarkdownCorpus.json with a dump of a real thread to compare the parsers on real content.
+    lazy var corpus: [String] = {
+        guard let url = Bundle(for: RedditMarkdownKitTests.self).url(forResource: "MarkdownCorpus", withExtension: "json"),
+            let data = try? Data(contentsOf: url),
+            let corpus = try? JSONSerialization.jsonObject(with: data, options: []) as? [String] else {
+            XCTFail("Could not load markdown corpus")
+            return []
+        }
+        return corpus
+    }()
+    
+    /// A document the size of a large comment page, to compare parse times.
+    var largeDocument: String {
+        return Array(repeating: self.corpus.joined(separator: "\n\n"), count: 40).joined(separator: "\n\n")
+    }
+    
+    func testScannerEquivalence() {
+        XCTAssertFalse(self.corpus.isEmpty)
+        
+        for string in self.corpus {
+            let expected = MarkdownString(string: string, parser: .regularExpressions)
+            let result = MarkdownString(string: string, parser: .scanner)
+            
+            XCTAssertEqual(expected.baseString as String, result.baseString as String, "Base string differs for '\(string)'")
+            
+            let expectedElements = self.sortedElements(expected.elements)
+            let resultElements = self.sortedElements(result.elements)
+            XCTAssertEqual(expectedElements, resultElements, "Elements differ for '\(string)'")
+            XCTAssertEqual(expectedElements.map { $0.url }, resultElements.map { $0.url }, "Links differ for '\(string)'")
+        }
+    }
+    
+    func testScannerWithoutLinkDetection() {
+        let string = "Visit **http://example.com** and [the docs](http://example.com/docs)"
+        let result = MarkdownString(string: string, autoDetectLinks: false, parser: .scanner)
+        
+        XCTAssertEqual(result.baseString as String, "Visit http://example.com and the docs")
+        XCTAssertEqual(result.elements.filter({ $0.type == .bold }).count, 1)
+        XCTAssertEqual(result.elements.filter({ $0.url != nil }).count, 1)
+    }
+    
+    func testRegularExpressionsPerformance() {
+        let document = self.largeDocument
+        self.measure {
+            _ = MarkdownString(string: document, parser: .regularExpressions)
+        }
+    }
+    
+    func testScannerPerformance() {
+        let document = self.largeDocument
+        self.measure {
+            _ = MarkdownString(string: document, parser: .scanner)
+        }
+    }
+    
+    /// A single line with thousands of delimiters that are never closed. Every delimiter used to search until the end of the line for its closer.
+    var unmatchedDelimiterDocument: String {
+        return String(repeating: "*open _open **open __open ***open [open ", count: 2000)
+    }
+    
+    func testScannerWithUnmatchedDelimiters() {
+        let document = self.unmatchedDelimiterDocument
+        let result = MarkdownString(string: document, parser: .scanner)
+        XCTAssertEqual(result.baseString as String, document)
+        XCTAssertTrue(result.elements.isEmpty)
+        
+        // A closer at the end of the line is still found by the first delimiter
+        let closedResult = MarkdownString(string: document + "closed*", parser: .scanner)
+        XCTAssertEqual(closedResult.elements.filter({ $0.type == .italic }).map({ $0.range.location }), [0])
+        
+        self.measure {
+            _ = MarkdownString(string: document, parser: .scanner)
+        }
+    }
+    
+    func testCacheRoundTrip() {
+        let directoryURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+        let string = "# Heading\n\nSome **bold** text with [a link](http://example.com)"
+        let writingCache = MarkdownStringCache(directoryURL: directoryURL)
+        let markdownString = writingCache.markdownString(for: string)
+        // Waits for the asynchronous write
+        XCTAssertGreaterThan(writingCache.byteCount, 0)
+        
+        // A new cache instance only has the MarkdownString on disk
+        let cache = MarkdownStringCache(directoryURL: directoryURL)
+        XCTAssertGreaterThan(cache.byteCount, 0)
+        guard let cachedMarkdownString = cache.cachedMarkdownString(for: string) else {
+            XCTFail("MarkdownString missing in cache")
+            return
+        }
+        XCTAssertEqual(cachedMarkdownString.baseString as String, markdownString.baseString as String)
+        XCTAssertEqual(cachedMarkdownString.elements, markdownString.elements)
+        XCTAssertEqual(cachedMarkdownString.elements.map { $0.url }, markdownString.elements.map { $0.url })
+        XCTAssertNil(cache.cachedMarkdownString(for: string, parser: .scanner))
+        
+        try? FileManager.default.removeItem(at: directoryURL)
+    }
+    
+    func testCacheReturnsCopies() {
+        let directoryURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+        let string = "Visit http://example.com for **more**"
+        let writingCache = MarkdownStringCache(directoryURL: directoryURL)
+        let markdownString = writingCache.markdownString(for: string)
+        XCTAssertGreaterThan(writingCache.byteCount, 0)
+        
+        // Changing a MarkdownString doesn't change the one other callers get from the cache
+        let linkCount = markdownString.elements.count
+        guard let memoryMarkdownString = writingCache.memoryMarkdownString(for: string) else {
+            XCTFail("MarkdownString missing in memory")
+            return
+        }
+        XCTAssertFalse(memoryMarkdownString === markdownString)
+        memoryMarkdownString.autoDetectLinks = false
+        XCTAssertLessThan(memoryMarkdownString.elements.count, linkCount)
+        XCTAssertEqual(writingCache.memoryMarkdownString(for: string)?.elements.count, linkCount)
+        XCTAssertEqual(markdownString.elements.count, linkCount)
+        
+        // Without reading from disk, a new cache instance doesn't have the MarkdownString in memory and parses it again
+        let cache = MarkdownStringCache(directoryURL: directoryURL)
+        XCTAssertNil(cache.memoryMarkdownString(for: string))
+        XCTAssertEqual(cache.markdownString(for: string, readsFromDisk: false).elements, markdownString.elements)
+        XCTAssertNotNil(cache.memoryMarkdownString(for: string))
+        
+        try? FileManager.default.removeItem(at: directoryURL)
+    }
+    
+    func testCacheEviction() {
+        let directoryURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+        let cache = MarkdownStringCache(directoryURL: directoryURL, byteLimit: 1024 * 1024)
+        for string in self.corpus {
+            _ = cache.markdownString(for: string)
+        }
+        let byteCount = cache.byteCount
+        XCTAssertGreaterThan(byteCount, 0)
+        
+        cache.byteLimit = byteCount / 2
+        XCTAssertLessThanOrEqual(cache.byteCount, byteCount / 2)
+        
+        try? FileManager.default.removeItem(at: directoryURL)
+    }
+    
+    private func sortedElements(_ elements: [MarkdownElement]) -> [MarkdownElement] {
+        return elements.sorted(by: { (lhs, rhs) -> Bool in
+            if lhs.range.location != rhs.range.location {
+                return lhs.range.location < rhs.range.location
+            } else if lhs.range.length != rhs.range.length {
+                return lhs.range.length < rhs.range.length
+            }
+            return lhs.type.rawValue < rhs.type.rawValue
+        })
+    }
+    
+}
@@ -40,6 +40,16 @@ public class DataRequest: SnooOperation {
         }
     }
     
+    /// If set to true, the body of a successful response is kept in `responseBody` instead of being deserialized into `result`. Used for listings, which are decoded while they are parsed.
+    internal var keepsResponseBody = false
+    
+    /// The raw body of the response, only set if `keepsResponseBody` is true.
+    public internal(set) var responseBody: Data? {
+        didSet {
+            self.requestCompletionHandler?(nil)
+        }
+    }
+    
     override public var error: Error? {
         didSet {
             self.requestCompletionHandler?(self.error)
@@ -48,8 +58,32 @@ public class DataRequest: SnooOperation {
     
     fileprivate var dataTask: URLSessionDataTask?
     
+    /// The number of bytes in the body of the response. Zero when the response of an identical request was used.
+    public fileprivate(set) var receivedByteCount = 0
+    
+    /// How urgent the request is. Changing the priority only has effect until the request starts.
+    public var priority = RequestPriority.userAction {
+        didSet {
+            self.queuePriority = self.priority.queuePriority
+            self.qualityOfService = self.priority.qualityOfService
+        }
+    }
+    
+    /// An identical request that was scheduled earlier. If it completes, its response is used instead of performing this request.
+    internal var coalescedRequest: DataRequest?
+    
+    /// Identifies requests that can share a response: GET requests for the same URL, on the same session and with the same way of handling the body. Nil for requests that can't be coalesced.
+    internal var coalescingKey: String? {
+        guard let urlRequest = self.urlRequest, let url = urlRequest.url, urlRequest.httpMethod == nil || urlRequest.httpMethod == "GET" else {
+            return nil
+        }
+        return "\(ObjectIdentifier(self.urlSession).hashValue) \(self.keepsResponseBody) \(url.absoluteString)"
+    }
+    
     public override init() {
         super.init()
+        self.queuePriority = self.priority.queuePriority
+        self.qualityOfService = self.priority.qualityOfService
     }
     
     deinit {
@@ -65,6 +99,14 @@ public class DataRequest: SnooOperation {
                 return
             }
             
+            if let coalescedRequest = self.coalescedRequest {
+                self.coalescedRequest = nil
+                if self.takeResponse(of: coalescedRequest) {
+                    self.finishOperation()
+                    return
+                }
+            }
+            
             let startDate: Date = Date()
             self.dataTask = self.urlSession.dataTask(with: urlRequest, completionHandler: { (data, urlResponse, responseError) in
                 guard self.isCancelled == false else {
@@ -72,6 +114,7 @@ public class DataRequest: SnooOperation {
                     return
                 }
                 self.HTTPResponse = urlResponse as? HTTPURLResponse
+                self.receivedByteCount = data?.count ?? 0
                 
                 /*
                 Reddit often responds with a 200 status code, however in some cases a 201 might be sent upon creation.
@@ -83,6 +126,8 @@ public class DataRequest: SnooOperation {
                     self.error = NSError.snooError(httpResponse.statusCode, localizedDescription: HTTPURLResponse.localizedString(forStatusCode: httpResponse.statusCode))
                 } else if let httpResponse: HTTPURLResponse = urlResponse as? HTTPURLResponse, httpResponse.statusCode >= 200 && httpResponse.statusCode < 300 && (data?.count == 0 || httpResponse.statusCode == 202) {
                     self.result = [String: AnyObject]() as NSDictionary?
+                } else if let data: Data = data, self.keepsResponseBody {
+                    self.responseBody = data
                 } else if let data: Data = data {
                     do {
                         let responseData: NSDictionary? = try self.responseData(data)
@@ -136,6 +181,26 @@ public class DataRequest: SnooOperation {
         self.dataTask = nil
     }
     
+    /// Uses the response of an identical request. Returns false if the request didn't complete, for example because it was cancelled.
+    fileprivate func takeResponse(of request: DataRequest) -> Bool {
+        guard request.isFinished && !request.isCancelled else {
+            return false
+        }
+        if let error = request.error {
+            self.HTTPResponse = request.HTTPResponse
+            self.error = error
+        } else if let responseBody = request.responseBody {
+            self.HTTPResponse = request.HTTPResponse
+            self.responseBody = responseBody
+        } else if let result = request.result {
+            self.HTTPResponse = request.HTTPResponse
+            self.result = result
+        } else {
+            return false
+        }
+        return true
+    }
+    
     fileprivate func responseData(_ data: Data) throws -> NSDictionary? {
         let object = try JSONSerialization.jsonObject(with: data, options: [])
         if let result = object as? NSDictionary {
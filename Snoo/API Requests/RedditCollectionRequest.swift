@@ -16,6 +16,8 @@ class RedditCollectionRequest: RedditRequest {
     init(query: CollectionQuery, authenticationController: AuthenticationController) {
         self.query = query
         super.init(authenticationController: authenticationController)
+        // Listings are decoded by the CollectionParsingOperation while parsing
+        self.keepsResponseBody = true
     }
     
     override var urlRequest: URLRequest? {
@@ -0,0 +1,109 @@
+//
+//  RequestScheduler.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import Foundation
+
+/// How urgent a request is. When all connections are in use, waiting requests of a higher priority are started first.
+public enum RequestPriority: Int, Comparable {
+    /// Requests nobody is waiting for, like refreshing the messages in the background.
+    case background
+    /// Requests for content that will probably be shown soon, or for views that are no longer visible.
+    case prefetch
+    /// Requests the user triggered, like voting or saving.
+    case userAction
+    /// Requests for content that is on screen.
+    case visibleContent
+    
+    var queuePriority: Operation.QueuePriority {
+        switch self {
+        case .background:
+            return .veryLow
+        case .prefetch:
+            return .low
+        case .userAction:
+            return .high
+        case .visibleContent:
+            return .veryHigh
+        }
+    }
+    
+    var qualityOfService: QualityOfService {
+        switch self {
+        case .background:
+            return .background
+        case .prefetch:
+            return .utility
+        case .userAction, .visibleContent:
+            return .userInitiated
+        }
+    }
+    
+    public static func < (lhs: RequestPriority, rhs: RequestPriority) -> Bool {
+        return lhs.rawValue < rhs.rawValue
+    }
+    
+}
+
+/// Runs the network requests of Snoo in order of priority and coalesces identical GET requests.
+///
+/// A GET request that is identical to a request that is already waiting or running doesn't go to the network itself. It waits for the first request and takes over its response.
+public final class RequestScheduler {
+    
+    /// The queue the requests run on. The number of concurrent requests is limited, so reddit doesn't rate limit the app.
+    let queue: OperationQueue
+    
+    /// The first request for every coalescable request, by its key. Finished requests are replaced when an identical request is scheduled.
+    fileprivate let inFlightRequests = NSMapTable<NSString, DataRequest>.strongToWeakObjects()
+    
+    fileprivate let lock = NSLock()
+    
+    init(maxConcurrentRequestCount: Int = 2) {
+        self.queue = OperationQueue()
+        self.queue.maxConcurrentOperationCount = maxConcurrentRequestCount
+        self.queue.name = "nl.madeawkward.snoo.networking"
+        self.queue.qualityOfService = QualityOfService.default
+    }
+    
+    /// Makes requests wait for identical requests that are in flight, call this before adding the requests to the queue.
+    func coalesce(_ requests: [DataRequest]) {
+        for request in requests {
+            self.coalesce(request)
+        }
+    }
+    
+    /// Changes the priority of requests that are still waiting. Requests they are coalesced with are raised to the new priority as well.
+    public func reprioritize(_ requests: [DataRequest], to priority: RequestPriority) {
+        for request in requests where !request.isExecuting && !request.isFinished {
+            request.priority = priority
+            if let leader = request.coalescedRequest, leader.priority < priority, !leader.isExecuting, !leader.isFinished {
+                leader.priority = priority
+            }
+        }
+    }
+    
+    fileprivate func coalesce(_ request: DataRequest) {
+        guard let key = request.coalescingKey else {
+            return
+        }
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        if let leader = self.inFlightRequests.object(forKey: key as NSString), !leader.isFinished, !leader.isCancelled, leader !== request {
+            request.coalescedRequest = leader
+            request.addDependency(leader)
+            // The first request shouldn't wait longer than the request that needs its response
+            if leader.priority < request.priority && !leader.isExecuting {
+                leader.priority = request.priority
+            }
+        } else {
+            self.inFlightRequests.setObject(request, forKey: key as NSString)
+        }
+    }
+    
+}
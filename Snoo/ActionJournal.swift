@@ -0,0 +1,236 @@
+//
+//  ActionJournal.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import Foundation
+
+/// A change the user made to a post or comment that still has to be sent to reddit.
+public struct JournalAction: Codable, Equatable {
+    
+    public enum Kind: String, Codable {
+        /// The value is the raw value of the `VoteStatus`.
+        case vote
+        /// The value is 1 for saved, 0 for unsaved.
+        case save
+        /// The value is 1 for hidden, 0 for not hidden.
+        case hide
+        /// The value is always 1, visits can't be undone.
+        case visit
+    }
+    
+    public let kind: Kind
+    
+    /// The full name of the post or comment, like "t3_5hfsuk".
+    public let objectName: String
+    
+    /// The user that made the change, actions are only sent with the session of this user.
+    public let userIdentifier: String
+    
+    /// The state the user wants the object to have.
+    public internal(set) var value: Int
+    
+    /// The state of the object on reddit before the user made the change. If the user changes it back, the action is dropped.
+    public internal(set) var originalValue: Int
+    
+    /// The number of times sending the action failed.
+    public internal(set) var attemptCount: Int = 0
+    
+    /// When the action was first recorded. Nil for actions that were journaled before the date was kept.
+    public internal(set) var recordDate: Date? = nil
+    
+    fileprivate var key: String {
+        return "\(self.userIdentifier)/\(self.kind.rawValue)/\(self.objectName)"
+    }
+    
+}
+
+/// Keeps the votes, saves, hides and visits that haven't been sent to reddit yet, in a file that survives a relaunch.
+///
+/// Changes to the same object are coalesced: only the last state is kept, and a change that puts the object back in the state reddit already knows about removes the action. Voting up, down and up again therefore sends one request. The journal is written to disk on a background queue. It can be used from any thread.
+public final class ActionJournal {
+    
+    /// The number of failed attempts after which an action is dropped.
+    public var maximumAttemptCount = 10
+    
+    fileprivate let fileURL: URL?
+    
+    /// The pending actions, in the order they were first recorded.
+    fileprivate var actions = [JournalAction]()
+    
+    fileprivate let lock = NSLock()
+    
+    fileprivate let writeQueue = DispatchQueue(label: "nl.madeawkward.snoo.action-journal", qos: .utility)
+    
+    /// Creates a journal that is stored in the file, or only in memory if the URL is nil. Actions that were stored by a previous launch are loaded.
+    public init(fileURL: URL?) {
+        self.fileURL = fileURL
+        if let fileURL = fileURL, let data = try? Data(contentsOf: fileURL) {
+            do {
+                self.actions = try JSONDecoder().decode([JournalAction].self, from: data)
+            } catch {
+                NSLog("Failed to read the action journal: %@", (error as NSError))
+            }
+        }
+    }
+    
+    /// The actions that have not been sent yet.
+    public var pendingActions: [JournalAction] {
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        return self.actions
+    }
+    
+    /// Returns the pending actions of the user.
+    public func pendingActions(for userIdentifier: String) -> [JournalAction] {
+        return self.pendingActions.filter { $0.userIdentifier == userIdentifier }
+    }
+    
+    /// Returns the pending action of the user for the object, if there is one. Cheap enough to call for every object that is parsed.
+    public func pendingAction(_ kind: JournalAction.Kind, objectName: String, userIdentifier: String) -> JournalAction? {
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        guard !self.actions.isEmpty else {
+            return nil
+        }
+        return self.actions.first(where: { $0.kind == kind && $0.objectName == objectName && $0.userIdentifier == userIdentifier })
+    }
+    
+    // MARK: - Recording
+    
+    /// Records that the user changed the state of an object.
+    ///
+    /// - Parameters:
+    ///   - value: The new state of the object.
+    ///   - originalValue: The state of the object before the change. Only used when there is no pending action for the object yet.
+    public func record(_ kind: JournalAction.Kind, objectName: String, userIdentifier: String, value: Int, originalValue: Int) {
+        self.updateActions { (actions) in
+            let action = JournalAction(kind: kind, objectName: objectName, userIdentifier: userIdentifier, value: value, originalValue: originalValue, attemptCount: 0, recordDate: Date())
+            if let index = actions.firstIndex(where: { $0.key == action.key }) {
+                if value == actions[index].originalValue {
+                    // Back to the state reddit knows about, nothing has to be sent
+                    actions.remove(at: index)
+                } else {
+                    actions[index].value = value
+                }
+            } else if value != originalValue {
+                actions.append(action)
+            }
+        }
+    }
+    
+    // MARK: - Sending
+    
+    /// Removes the actions that have been sent. If the user changed an object again while its action was being sent, the new change stays in the journal.
+    public func complete(_ sentActions: [JournalAction]) {
+        self.updateActions { (actions) in
+            for sentAction in sentActions {
+                guard let index = actions.firstIndex(where: { $0.key == sentAction.key }) else {
+                    if sentAction.kind != .visit {
+                        // The user changed the object back while it was being sent, which reddit doesn't know about yet
+                        actions.append(JournalAction(kind: sentAction.kind, objectName: sentAction.objectName, userIdentifier: sentAction.userIdentifier, value: sentAction.originalValue, originalValue: sentAction.value, attemptCount: 0, recordDate: Date()))
+                    }
+                    continue
+                }
+                // Reddit now knows about the sent state
+                actions[index].originalValue = sentAction.value
+                actions[index].attemptCount = 0
+                if actions[index].value == sentAction.value {
+                    actions.remove(at: index)
+                }
+            }
+        }
+    }
+    
+    /// Keeps the actions so they are sent again later, unless they have failed too often.
+    ///
+    /// - Returns: The actions that have been dropped.
+    @discardableResult
+    public func retryLater(_ failedActions: [JournalAction]) -> [JournalAction] {
+        var droppedActions = [JournalAction]()
+        self.updateActions { (actions) in
+            for failedAction in failedActions {
+                guard let index = actions.firstIndex(where: { $0.key == failedAction.key }) else {
+                    continue
+                }
+                actions[index].attemptCount += 1
+                if actions[index].attemptCount >= self.maximumAttemptCount {
+                    droppedActions.append(actions.remove(at: index))
+                }
+            }
+        }
+        return droppedActions
+    }
+    
+    /// Removes the actions, for example because reddit rejected them.
+    ///
+    /// - Returns: The actions that have been removed. Actions the user changed again in the meantime are kept with their new state.
+    @discardableResult
+    public func remove(_ rejectedActions: [JournalAction]) -> [JournalAction] {
+        var removedActions = [JournalAction]()
+        self.updateActions { (actions) in
+            for rejectedAction in rejectedActions {
+                if let index = actions.firstIndex(where: { $0.key == rejectedAction.key && $0.value == rejectedAction.value }) {
+                    removedActions.append(actions.remove(at: index))
+                }
+            }
+        }
+        return removedActions
+    }
+    
+    /// Removes the actions that match, for example the actions of a user that signed out.
+    ///
+    /// - Returns: The actions that have been removed.
+    @discardableResult
+    public func removeActions(where shouldRemove: (JournalAction) -> Bool) -> [JournalAction] {
+        var removedActions = [JournalAction]()
+        self.updateActions { (actions) in
+            removedActions = actions.filter(shouldRemove)
+            actions.removeAll(where: shouldRemove)
+        }
+        return removedActions
+    }
+    
+    // MARK: - Storage
+    
+    fileprivate func updateActions(_ update: (_ actions: inout [JournalAction]) -> Void) {
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        let previousActions = self.actions
+        update(&self.actions)
+        if self.actions != previousActions {
+            // Queued while locked, so the last state is also written last
+            self.write(self.actions)
+        }
+    }
+    
+    fileprivate func write(_ actions: [JournalAction]) {
+        guard let fileURL = self.fileURL else {
+            return
+        }
+        self.writeQueue.async {
+            do {
+                let data = try JSONEncoder().encode(actions)
+                try FileManager.default.createDirectory(at: fileURL.deletingLastPathComponent(), withIntermediateDirectories: true, attributes: nil)
+                try data.write(to: fileURL, options: [.atomic, .completeFileProtectionUntilFirstUserAuthentication])
+            } catch {
+                NSLog("Failed to write the action journal: %@", (error as NSError))
+            }
+        }
+    }
+    
+    /// Waits until the journal has been written to disk.
+    public func waitUntilWritten() {
+        self.writeQueue.sync {}
+    }
+    
+}
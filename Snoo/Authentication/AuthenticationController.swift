@@ -74,6 +74,7 @@ public final class AuthenticationController: NSObject {
                 UserDefaults.standard.removeObject(forKey: AuthenticationController.ApplicationSessionKey)
             }
             self.updateURLSession()
+            self.scheduleProactiveRefresh()
             NotificationCenter.default.post(name: AuthenticationController.ApplicationTokenDidChangeNotificationName, object: self)
         }
     }
@@ -91,6 +92,7 @@ public final class AuthenticationController: NSObject {
         didSet {
             self.saveCurrentUserSession()
             self.updateURLSession()
+            self.scheduleProactiveRefresh()
             NotificationCenter.default.post(name: AuthenticationController.UserTokenDidChangeNotificationName, object: self)
         }
     }
@@ -156,6 +158,9 @@ public final class AuthenticationController: NSObject {
     
     internal var authorizationState: String?
     
+    /// Shares a refresh of the session between all requests that need it.
+    internal let refreshCoordinator = AuthenticationRefreshCoordinator()
+    
     // MARK: Setup
     
     public init(clientID: String, redirectUri: String, clientName: String, loadCurrentSession: Bool = true) {
@@ -254,10 +259,19 @@ public final class AuthenticationController: NSObject {
     
     /**
      Operations to be added before other RedditRequest operations. These make sure that the application is correctly authenticated. In case the app is already authenticated, the operations will be instantly finished.
+     
+     While the session is being refreshed, the operations only wait for that refresh. This way concurrent requests don't refresh the session more than once.
+     
+     - parameter interval: The minimum time the session should stay valid, a longer interval refreshes the session ahead of time.
      */
-    func authenticationOperations() -> [Operation] {
-
-        if let userSession = self.userSession, let refreshToken = userSession.refreshToken, userSession.isValid == false {
+    func authenticationOperations(validFor interval: TimeInterval = 30) -> [Operation] {
+        return self.refreshCoordinator.operations(refreshOperations: { () -> [Operation] in
+            return self.refreshOperations(validFor: interval)
+        })
+    }
+    
+    fileprivate func refreshOperations(validFor interval: TimeInterval) -> [Operation] {
+        if let userSession = self.userSession, let refreshToken = userSession.refreshToken, userSession.isValid(for: interval) == false {
             // Expired user session. First refresh this.
             
             let tokenRequest = AccessTokenRequest(grant: AccessTokenGrant.refreshToken(refreshToken), clientId: self.configuration.clientID, authenticationController: self)
@@ -294,7 +308,7 @@ public final class AuthenticationController: NSObject {
             
             return [tokenRequest, userRequest, userParser]
             
-        } else if let deviceId = UIDevice.current.identifierForVendor?.uuidString, applicationSession?.isValid != true && self.userSession?.isValid != true {
+        } else if let deviceId = UIDevice.current.identifierForVendor?.uuidString, applicationSession?.isValid(for: interval) != true && self.userSession?.isValid(for: interval) != true {
             // Expired app token, no app token and user is not logged in.
                 
             let tokenRequest = AccessTokenRequest(grant: AccessTokenGrant.installedClient(deviceId), clientId: self.configuration.clientID, authenticationController: self)
@@ -313,6 +327,22 @@ public final class AuthenticationController: NSObject {
         
     }
     
+    /// Refreshes the active session shortly before it expires, once no requests are running.
+    fileprivate func scheduleProactiveRefresh() {
+        let expirationDate = self.activeSession?.expirationDate
+        self.refreshCoordinator.scheduleProactiveRefresh(expirationDate: expirationDate, isNetworkIdle: { () -> Bool in
+            return DataController.shared.networkingQueue.operationCount == 0
+        }, refresh: { [weak self] () in
+            guard let authenticationController = self else {
+                return
+            }
+            let operations = authenticationController.authenticationOperations(validFor: authenticationController.refreshCoordinator.proactiveRefreshInterval)
+            if !operations.isEmpty {
+                DataController.shared.executeOperations(operations, handler: nil)
+            }
+        })
+    }
+    
     /**
     If the user is not authenticated and he wants to login, you can present a web view to trigger the OAuth authentication process. Use this URL.
     */
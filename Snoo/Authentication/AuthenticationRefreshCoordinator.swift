@@ -0,0 +1,124 @@
+//
+//  AuthenticationRefreshCoordinator.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import Foundation
+
+/// Makes sure an expired session is refreshed once, no matter how many batches of requests need it at the same time.
+///
+/// The first batch that needs a refresh gets the refresh operations. While those are in flight, every other batch gets an operation that only waits for the refresh to finish. The coordinator also refreshes the session shortly before it expires, when no requests are running, so requests don't have to wait for a refresh at all.
+final class AuthenticationRefreshCoordinator {
+    
+    /// How long before the expiration date the session is refreshed ahead of time.
+    var proactiveRefreshInterval: TimeInterval = 5 * 60
+    
+    /// How long a refresh ahead of time waits when the network is busy, before checking again.
+    var busyNetworkRetryInterval: TimeInterval = 15
+    
+    /// The operations of the refresh that is in flight. The last operation finishes once the new session has been set.
+    fileprivate var inFlightOperations: [Operation]?
+    
+    fileprivate var currentRefreshCount = 0
+    
+    fileprivate var proactiveRefreshTimer: DispatchSourceTimer?
+    
+    /// Identifies the scheduled refresh, so a timer that fires after it has been replaced doesn't cancel its successor.
+    fileprivate var proactiveRefreshGeneration = 0
+    
+    fileprivate let timerQueue = DispatchQueue(label: "nl.madeawkward.snoo.authentication-refresh", qos: .utility)
+    
+    fileprivate let lock = NSLock()
+    
+    deinit {
+        self.proactiveRefreshTimer?.cancel()
+    }
+    
+    /// The number of refreshes that have been started.
+    var refreshCount: Int {
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        return self.currentRefreshCount
+    }
+    
+    // MARK: - Single flight
+    
+    /// Returns the operations a batch of requests has to wait for. If the session needs a refresh and a refresh is already in flight, this is an operation that waits for that refresh instead of the new refresh operations.
+    ///
+    /// - Parameter refreshOperations: Creates the operations that refresh the session, or no operations if the session is valid. The last operation should finish after the new session has been set.
+    func operations(refreshOperations: () -> [Operation]) -> [Operation] {
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        let operations = refreshOperations()
+        guard !operations.isEmpty else {
+            // Requests don't wait for a refresh ahead of time, the session is still valid
+            return operations
+        }
+        if let lastOperation = self.inFlightOperations?.last, !lastOperation.isFinished {
+            let waitOperation = BlockOperation()
+            waitOperation.addDependency(lastOperation)
+            return [waitOperation]
+        }
+        
+        self.inFlightOperations = operations
+        self.currentRefreshCount += 1
+        return operations
+    }
+    
+    // MARK: - Refreshing ahead of time
+    
+    /// Schedules a refresh shortly before the expiration date, replacing the refresh that was scheduled before. When requests are running at that time, the refresh waits until the network is idle. Once the session has expired, the next request refreshes it instead.
+    ///
+    /// - Parameters:
+    ///   - expirationDate: The date the session expires, nil to cancel the scheduled refresh.
+    ///   - isNetworkIdle: Whether no requests are running. Called on a background queue.
+    ///   - refresh: Starts the refresh. Called on a background queue.
+    func scheduleProactiveRefresh(expirationDate: Date?, isNetworkIdle: @escaping () -> Bool, refresh: @escaping () -> Void) {
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        self.proactiveRefreshTimer?.cancel()
+        self.proactiveRefreshTimer = nil
+        guard let expirationDate = expirationDate else {
+            return
+        }
+        
+        self.proactiveRefreshGeneration += 1
+        let generation = self.proactiveRefreshGeneration
+        let timer = DispatchSource.makeTimerSource(queue: self.timerQueue)
+        let delay = max(expirationDate.timeIntervalSinceNow - self.proactiveRefreshInterval, 0)
+        timer.schedule(deadline: .now() + delay, repeating: self.busyNetworkRetryInterval)
+        timer.setEventHandler { [weak self] in
+            guard expirationDate.timeIntervalSinceNow > 30 else {
+                // Too late, the next request refreshes the session
+                self?.cancelProactiveRefresh(generation: generation)
+                return
+            }
+            guard isNetworkIdle() else {
+                return
+            }
+            self?.cancelProactiveRefresh(generation: generation)
+            refresh()
+        }
+        self.proactiveRefreshTimer = timer
+        timer.resume()
+    }
+    
+    fileprivate func cancelProactiveRefresh(generation: Int) {
+        self.lock.lock()
+        if self.proactiveRefreshGeneration == generation {
+            self.proactiveRefreshTimer?.cancel()
+            self.proactiveRefreshTimer = nil
+        }
+        self.lock.unlock()
+    }
+    
+}
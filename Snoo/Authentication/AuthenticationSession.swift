@@ -140,8 +140,13 @@ public final class AuthenticationSession: NSObject, NSSecureCoding {
     // MARK: - Helpers
     
     var isValid: Bool {
+        return self.isValid(for: 30)
+    }
+    
+    /// Whether the session is still valid after the interval, used to refresh the session before it expires.
+    func isValid(for interval: TimeInterval) -> Bool {
         if let expirationDate = self.expirationDate {
-            return expirationDate.timeIntervalSinceNow > 30
+            return expirationDate.timeIntervalSinceNow > interval
         }
         return false
     }
@@ -0,0 +1,216 @@
+//
+//  CollectionChangeDispatcher.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import CoreData
+
+/// Dispatches the changes of an object context to the collection controllers that show the changed collections or objects.
+///
+/// The dispatcher observes the context notifications once for all controllers. It keeps an index from every object to the collections that contain it, so a notification only costs as much as the number of changed objects, not the number of controllers times the number of changed objects.
+final class CollectionChangeDispatcher {
+    
+    static let shared = CollectionChangeDispatcher()
+    
+    /// The controllers and objects of the collections in a single context.
+    fileprivate final class ContextIndex {
+        
+        weak var context: NSManagedObjectContext?
+        
+        /// The controllers per collection.
+        var controllers = [NSManagedObjectID: NSHashTable<CollectionController>]()
+        
+        /// The collections that contain an object, for all indexed collections.
+        var collectionsByObject = [NSManagedObjectID: Set<NSManagedObjectID>]()
+        
+        /// The objects of every indexed collection.
+        var objectsByCollection = [NSManagedObjectID: Set<NSManagedObjectID>]()
+        
+        /// Collections of which the objects have changed since they were indexed. They are indexed again on the next notification.
+        var staleCollections = Set<NSManagedObjectID>()
+        
+        init(context: NSManagedObjectContext) {
+            self.context = context
+        }
+        
+        func removeObjects(of collectionID: NSManagedObjectID) {
+            for objectID in self.objectsByCollection.removeValue(forKey: collectionID) ?? [] {
+                self.collectionsByObject[objectID]?.remove(collectionID)
+                if self.collectionsByObject[objectID]?.isEmpty == true {
+                    self.collectionsByObject.removeValue(forKey: objectID)
+                }
+            }
+        }
+        
+        func setObjects(_ objectIDs: Set<NSManagedObjectID>, of collectionID: NSManagedObjectID) {
+            self.removeObjects(of: collectionID)
+            self.objectsByCollection[collectionID] = objectIDs
+            for objectID in objectIDs {
+                self.collectionsByObject[objectID, default: Set<NSManagedObjectID>()].insert(collectionID)
+            }
+        }
+        
+    }
+    
+    fileprivate var indexes = [ObjectIdentifier: ContextIndex]()
+    
+    fileprivate let lock = NSLock()
+    
+    init() {
+        NotificationCenter.default.addObserver(self, selector: #selector(CollectionChangeDispatcher.objectContextDidSave(_:)), name: NSNotification.Name.NSManagedObjectContextDidSave, object: nil)
+        NotificationCenter.default.addObserver(self, selector: #selector(CollectionChangeDispatcher.objectContextObjectsDidChange(_:)), name: NSNotification.Name.NSManagedObjectContextObjectsDidChange, object: nil)
+    }
+    
+    deinit {
+        NotificationCenter.default.removeObserver(self)
+    }
+    
+    // MARK: - Registration
+    
+    /// Moves the controller from the collection it showed to the collection it shows now. A nil collection ID removes the controller.
+    func register(_ controller: CollectionController, context: NSManagedObjectContext, from oldCollectionID: NSManagedObjectID?, to newCollectionID: NSManagedObjectID?) {
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        let key = ObjectIdentifier(context)
+        if self.indexes[key]?.context !== context {
+            self.indexes[key] = ContextIndex(context: context)
+        }
+        let index = self.indexes[key]!
+        
+        if let oldCollectionID = oldCollectionID, let controllers = index.controllers[oldCollectionID] {
+            controllers.remove(controller)
+            if controllers.allObjects.isEmpty {
+                index.controllers.removeValue(forKey: oldCollectionID)
+                index.removeObjects(of: oldCollectionID)
+                index.staleCollections.remove(oldCollectionID)
+            }
+        }
+        if let newCollectionID = newCollectionID {
+            if index.controllers[newCollectionID] == nil {
+                index.controllers[newCollectionID] = NSHashTable<CollectionController>.weakObjects()
+                index.staleCollections.insert(newCollectionID)
+            }
+            index.controllers[newCollectionID]?.add(controller)
+        }
+        
+        if index.controllers.isEmpty {
+            self.indexes.removeValue(forKey: key)
+        }
+    }
+    
+    /// The collections that are shown by a collection controller, in any context.
+    var shownCollectionIDs: Set<NSManagedObjectID> {
+        self.lock.lock()
+        defer {
+            self.lock.unlock()
+        }
+        return Set(self.indexes.values.flatMap { $0.controllers.keys })
+    }
+    
+    // MARK: - Notifications
+    
+    /// Returns the index of the context the notification was posted for, if any of the collections in that context are shown by a controller.
+    fileprivate func index(for notification: Notification) -> ContextIndex? {
+        guard let context = notification.object as? NSManagedObjectContext, let index = self.indexes[ObjectIdentifier(context)], index.context === context else {
+            return nil
+        }
+        return index
+    }
+    
+    @objc fileprivate func objectContextDidSave(_ notification: Notification) {
+        self.lock.lock()
+        guard let index = self.index(for: notification) else {
+            self.lock.unlock()
+            return
+        }
+        var changedCollectionIDs = Set<NSManagedObjectID>()
+        for key in [NSInsertedObjectsKey, NSUpdatedObjectsKey, NSDeletedObjectsKey] {
+            for case let collection as ObjectCollection in notification.userInfo?[key] as? Set<NSManagedObject> ?? [] where index.controllers[collection.objectID] != nil {
+                changedCollectionIDs.insert(collection.objectID)
+            }
+        }
+        index.staleCollections.formUnion(changedCollectionIDs)
+        let controllers = changedCollectionIDs.flatMap { index.controllers[$0]?.allObjects ?? [] }
+        self.lock.unlock()
+        
+        for controller in controllers {
+            controller.collectionDidSave()
+        }
+    }
+    
+    @objc fileprivate func objectContextObjectsDidChange(_ notification: Notification) {
+        // Most contexts don't have an index, they return before anything else is done
+        self.lock.lock()
+        let contextIndex = self.index(for: notification)
+        self.lock.unlock()
+        guard let index = contextIndex, let context = index.context else {
+            return
+        }
+        
+        var changedCollectionIDs = Set<NSManagedObjectID>()
+        var updatedObjects = [SyncObject]()
+        for key in [NSUpdatedObjectsKey, NSRefreshedObjectsKey, NSInvalidatedObjectsKey, NSDeletedObjectsKey] {
+            for object in notification.userInfo?[key] as? Set<NSManagedObject> ?? [] {
+                if object is ObjectCollection {
+                    changedCollectionIDs.insert(object.objectID)
+                } else if key == NSUpdatedObjectsKey, let object = object as? SyncObject {
+                    updatedObjects.append(object)
+                }
+            }
+        }
+        
+        self.lock.lock()
+        if notification.userInfo?[NSInvalidatedAllObjectsKey] != nil {
+            index.staleCollections.formUnion(index.controllers.keys)
+        }
+        index.staleCollections.formUnion(changedCollectionIDs.filter { index.controllers[$0] != nil })
+        let staleCollectionIDs = index.staleCollections
+        index.staleCollections.removeAll()
+        self.lock.unlock()
+        
+        // The notification is posted on the queue of the context, so the objects of the collections can be read. Reading them can fire faults that wait for the queue of a parent context, which might be waiting for the lock itself, so the lock is not held meanwhile.
+        var objectIDsPerCollection = [NSManagedObjectID: Set<NSManagedObjectID>]()
+        var removedCollectionIDs = [NSManagedObjectID]()
+        for collectionID in staleCollectionIDs {
+            if let collection = try? context.existingObject(with: collectionID) as? ObjectCollection, !collection.isDeleted {
+                let objectIDs = (collection.objects?.array as? [NSManagedObject])?.map { $0.objectID } ?? []
+                objectIDsPerCollection[collectionID] = Set(objectIDs)
+            } else {
+                removedCollectionIDs.append(collectionID)
+            }
+        }
+        
+        self.lock.lock()
+        for (collectionID, objectIDs) in objectIDsPerCollection {
+            // The collection is not indexed if its controllers went away in the meantime
+            if index.controllers[collectionID] != nil {
+                index.setObjects(objectIDs, of: collectionID)
+            }
+        }
+        for collectionID in removedCollectionIDs {
+            index.removeObjects(of: collectionID)
+        }
+        
+        // Group the updated objects per collection, every controller gets the objects of its own collection
+        var updatedObjectsPerCollection = [NSManagedObjectID: Set<SyncObject>]()
+        for object in updatedObjects {
+            for collectionID in index.collectionsByObject[object.objectID] ?? [] {
+                updatedObjectsPerCollection[collectionID, default: Set<SyncObject>()].insert(object)
+            }
+        }
+        let changes = updatedObjectsPerCollection.flatMap { (collectionID, objects) in
+            return (index.controllers[collectionID]?.allObjects ?? []).map { (controller: $0, collectionID: collectionID, objects: objects) }
+        }
+        self.lock.unlock()
+        
+        for change in changes {
+            change.controller.collection(withID: change.collectionID, didUpdateObjects: change.objects)
+        }
+    }
+    
+}
@@ -74,6 +74,9 @@ public final class CollectionController: NSObject {
     public var query: CollectionQuery? {
         didSet {
             query?.collectionController = self
+            self.savedObjectIDsLock.lock()
+            self.savedObjectIDs.removeAll()
+            self.savedObjectIDsLock.unlock()
             do {
                 self.cancelFetching()
                 
@@ -103,12 +106,44 @@ public final class CollectionController: NSObject {
     /// The collection that is controlled by this controller.
     public var collectionID: NSManagedObjectID? {
         didSet {
+            if self.collectionID != oldValue {
+                CollectionChangeDispatcher.shared.register(self, context: self.managedObjectContext, from: oldValue, to: self.collectionID)
+                if let collectionID = self.collectionID {
+                    DataController.shared.storeCacheController.recordAccess(to: collectionID)
+                }
+            }
             self.delegate?.collectionController(self, collectionDidUpdateWithID: collectionID)
         }
     }
     
     public var filteredObjectIDs: [NSManagedObjectID]?
     
+    /// The priority of the requests of the controller. Lower the priority when the content is no longer visible, requests that are waiting are updated directly.
+    public var priority = RequestPriority.visibleContent {
+        didSet {
+            guard self.priority != oldValue else {
+                return
+            }
+            DataController.shared.requestScheduler.reprioritize(self.requests.allObjects, to: self.priority)
+        }
+    }
+    
+    /// The number of fetch requests that were needed to look up existing objects while parsing the last page.
+    public fileprivate(set) var fetchRequestCount = 0
+    
+    /// The number of bytes received for all pages the controller fetched.
+    public fileprivate(set) var receivedByteCount = 0
+    
+    /// The objects earlier pages saved, so they don't have to be fetched again while parsing the next page. A refresh and a load more can parse at the same time on different contexts, so every parse gets its own identity map seeded with these.
+    fileprivate var savedObjectIDs = [NSString: NSManagedObjectID]()
+    
+    fileprivate let savedObjectIDsLock = NSLock()
+    
+    /// The save operation of the fetch that is parsing a collection, by the key of the collection query. Parsing contexts that would both insert the collection wait for each other instead.
+    fileprivate static var parsingCollectionOperations = [String: (parseOperation: CollectionParsingOperation, saveOperation: Operation)]()
+    
+    fileprivate static let parsingCollectionOperationsLock = NSLock()
+    
     /// Whether or not the collection is expired. If so, the content should be reloaded. If this property is nil if there is no collection or the collection has no expiration date.
     public var isCollectionExpired: Bool? {
         var expirationDate: Date?
@@ -131,7 +166,8 @@ public final class CollectionController: NSObject {
     
     // MARK: - Private properties
     
-    fileprivate var requests = NSMutableSet(capacity: 2)
+    /// The requests that are fetching the collection. Finished requests are removed automatically.
+    fileprivate var requests = NSHashTable<RedditCollectionRequest>.weakObjects()
     
     /// The NSURLSession for the controller. This way, the controller has it's own request queue. We can still think about making this public or using a shared session within Snoo to support a shared queue with other controllers.
     fileprivate var urlSession: URLSession
@@ -152,14 +188,17 @@ public final class CollectionController: NSObject {
         super.init()
         
         NotificationCenter.default.addObserver(self, selector: #selector(CollectionController.userDidChange(_:)), name: AuthenticationController.UserDidChangeNotificationName, object: nil)
-        NotificationCenter.default.addObserver(self, selector: #selector(CollectionController.objectContextDidSave(_:)), name: NSNotification.Name.NSManagedObjectContextDidSave, object: context)
-        NotificationCenter.default.addObserver(self, selector: #selector(CollectionController.objectContextObjectsDidChange(_:)), name: NSNotification.Name.NSManagedObjectContextObjectsDidChange, object: context)
         NotificationCenter.default.addObserver(self, selector: #selector(CollectionController.persistentStoreDidChange(_: )), name: .DataControllerPersistentStoreDidChange, object: DataController.shared)
     }
     
     deinit {
         NotificationCenter.default.removeObserver(self)
+        CollectionChangeDispatcher.shared.register(self, context: self.managedObjectContext, from: self.collectionID, to: nil)
         self.urlSession.delegateQueue.cancelAllOperations()
+        // Nobody is waiting for the content anymore
+        for request in self.requests.allObjects {
+            request.cancel()
+        }
     }
     
     // MARK: - Fetching
@@ -169,41 +208,21 @@ public final class CollectionController: NSObject {
         self.filteredObjectIDs = nil
     }
     
-    @objc fileprivate func objectContextDidSave(_ notification: Notification) {
-        var changedObjects = Set<NSManagedObject>()
-        if let insertedObjects = (notification as NSNotification).userInfo?[NSInsertedObjectsKey] as? Set<NSManagedObject> {
-            changedObjects.formUnion(insertedObjects)
-        }
-        if let updatedObjects = (notification as NSNotification).userInfo?[NSUpdatedObjectsKey] as? Set<NSManagedObject> {
-            changedObjects.formUnion(updatedObjects)
-        }
-        if let deletedObjects = (notification as NSNotification).userInfo?[NSDeletedObjectsKey] as? Set<NSManagedObject> {
-            changedObjects.formUnion(deletedObjects)
-        }
-        
+    /// Called by the change dispatcher when the context saved the collection of the controller.
+    internal func collectionDidSave() {
         if let collectionID = self.collectionID {
-            let collections = changedObjects.filter({ $0 is ObjectCollection })
-            if collections.map({ ($0 as! ObjectCollection).objectID }).contains(collectionID) {
-                self.delegate?.collectionController(self, collectionDidUpdateWithID: collectionID)
-            }
+            self.delegate?.collectionController(self, collectionDidUpdateWithID: collectionID)
         }
     }
     
-    @objc fileprivate func objectContextObjectsDidChange(_ notification: Notification) {
-        guard notification.object as? NSManagedObjectContext == self.managedObjectContext else {
+    /// Called by the change dispatcher on the queue of the context, when objects in the collection of the controller have been updated. Only the updated objects are filtered again.
+    internal func collection(withID collectionID: NSManagedObjectID, didUpdateObjects updatedObjects: Set<SyncObject>) {
+        guard collectionID == self.collectionID, let contentPredicate = self.query?.compoundContentPredicate else {
             return
         }
-        
-        if let collectionID = self.collectionID, let query = self.query, let contentPredicate = query.compoundContentPredicate {
-            if let updatedObjects = (notification as NSNotification).userInfo?[NSUpdatedObjectsKey] as? Set<NSManagedObject> {
-                let updatedSyncObjects = updatedObjects.compactMap { (object) -> SyncObject? in
-                    return object as? SyncObject
-                }
-                let collection = self.managedObjectContext.object(with: collectionID) as? ObjectCollection
-                if collection?.objects?.contains( where: { updatedSyncObjects.contains($0 as! SyncObject) }) == true {
-                    collection?.objects = collection?.objects?.filtered(using: contentPredicate)
-                }
-            }
+        let filteredObjects = updatedObjects.filter { !contentPredicate.evaluate(with: $0) }
+        if !filteredObjects.isEmpty, let collection = self.managedObjectContext.object(with: collectionID) as? ObjectCollection {
+            collection.mutableOrderedSetValue(forKey: "objects").removeObjects(in: Array(filteredObjects))
         }
     }
     
@@ -263,10 +282,8 @@ public final class CollectionController: NSObject {
     }
     
     public func cancelFetching() {
-        for request in self.requests {
-            if let request = request as? RedditCollectionRequest {
-                request.cancel()
-            }
+        for request in self.requests.allObjects {
+            request.cancel()
         }
         
         self.requests.removeAllObjects()
@@ -298,11 +315,17 @@ public final class CollectionController: NSObject {
         let collectionRequest = RedditCollectionRequest(query: self.query!, authenticationController: authenticationController)
         collectionRequest.urlSession = self.authenticationController.userURLSession
         collectionRequest.after = after
+        collectionRequest.priority = self.priority
         operations.append(collectionRequest)
+        self.requests.add(collectionRequest)
         
         let parseOperation = CollectionParsingOperation(query: self.query!)
-        parseOperation.objectContext = DataController.shared.privateContext
+        // Collections are parsed on their own context when parsing is concurrent, so loading one collection doesn't wait for another
+        parseOperation.objectContext = DataController.shared.createParsingContext()
         parseOperation.shouldDeleteMissingMemoryObjects = after == nil
+        self.savedObjectIDsLock.lock()
+        parseOperation.identityMap = SyncObjectIdentityMap(objectIDs: self.savedObjectIDs)
+        self.savedObjectIDsLock.unlock()
         parseOperation.objectContext?.performAndWait { () -> Void in
             if let collectionID = self.collectionID, after != nil {
                 parseOperation.objectCollection = parseOperation.objectContext?.object(with: collectionID) as? ObjectCollection
@@ -324,8 +347,33 @@ public final class CollectionController: NSObject {
             }
         }
         
-        DataController.shared.executeAndSaveOperations(operations) { [weak self] (error: Error?) -> Void in
+        // Another controller might be parsing the same collection, which isn't in the store until it saved
+        let collectionKey = CollectionController.collectionKey(for: self.query!)
+        CollectionController.parsingCollectionOperationsLock.lock()
+        if let collectionKey = collectionKey, let parsingOperations = CollectionController.parsingCollectionOperations[collectionKey] {
+            parseOperation.addDependency(parsingOperations.saveOperation)
+        }
+        
+        let graph = DataController.shared.executeAndSaveOperations(operations, context: parseOperation.objectContext) { [weak self] (error: Error?) -> Void in
+            if let collectionKey = collectionKey {
+                CollectionController.finishParsingCollection(withKey: collectionKey, parseOperation: parseOperation)
+            }
+            
+            if error == nil, let objectContext = parseOperation.objectContext {
+                var savedObjectIDs = [NSString: NSManagedObjectID]()
+                objectContext.performAndWait {
+                    savedObjectIDs = parseOperation.identityMap.savedObjectIDs(in: objectContext)
+                }
+                if let strongSelf = self, strongSelf.query === parseOperation.query {
+                    strongSelf.savedObjectIDsLock.lock()
+                    strongSelf.savedObjectIDs.merge(savedObjectIDs, uniquingKeysWith: { $1 })
+                    strongSelf.savedObjectIDsLock.unlock()
+                }
+            }
+            
             self?.filteredObjectIDs = parseOperation.filteredObjects?.map({ $0.objectID })
+            self?.fetchRequestCount = parseOperation.fetchRequestCount
+            self?.receivedByteCount += collectionRequest.receivedByteCount
             
             //Only set the before and after if error is nil, otherwise we are going to have a very bad time
             if error == nil {
@@ -368,6 +416,27 @@ public final class CollectionController: NSObject {
                 }
             }
         }
+        if let collectionKey = collectionKey, !graph.isFinished, let saveOperation = graph.operations.last {
+            CollectionController.parsingCollectionOperations[collectionKey] = (parseOperation, saveOperation)
+        }
+        CollectionController.parsingCollectionOperationsLock.unlock()
+    }
+    
+    /// Identifies the stored collection of the query, nil if the collection of the query isn't stored.
+    fileprivate class func collectionKey(for query: CollectionQuery) -> String? {
+        guard let fetchRequest = query.fetchRequest(), let entityName = fetchRequest.entityName else {
+            return nil
+        }
+        return "\(entityName) \(fetchRequest.predicate?.predicateFormat ?? "")"
+    }
+    
+    /// Stops later fetches of the collection from waiting for the parse, unless a newer fetch of the collection is parsing.
+    fileprivate class func finishParsingCollection(withKey collectionKey: String, parseOperation: CollectionParsingOperation) {
+        CollectionController.parsingCollectionOperationsLock.lock()
+        if CollectionController.parsingCollectionOperations[collectionKey]?.parseOperation === parseOperation {
+            CollectionController.parsingCollectionOperations.removeValue(forKey: collectionKey)
+        }
+        CollectionController.parsingCollectionOperationsLock.unlock()
     }
     
     fileprivate func fetchLocalCollection(_ query: CollectionQuery) throws -> NSManagedObjectID? {
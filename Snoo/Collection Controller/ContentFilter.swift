@@ -0,0 +1,196 @@
+//
+//  ContentFilter.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import Foundation
+import CoreData
+
+/// Filters posts and comments on keywords in the title of the post and on the name of the subreddit.
+///
+/// The keywords are compiled into a single automaton, so a title is scanned once regardless of the number of keywords. Create a new filter when the keywords or subreddits change, the filter itself is immutable and can be shared between threads.
+public final class ContentFilter {
+    
+    /// The lowercased keywords, in the order they were given.
+    public let keywords: [String]
+    
+    /// The lowercased subreddit names, in the order they were given.
+    public let subreddits: [String]
+    
+    fileprivate let automaton: KeywordAutomaton?
+    
+    fileprivate let subredditNames: Set<String>
+    
+    /// Whether the title of a post matched a keyword, by the identifier of the post. Filled while parsing, so the views don't have to scan the titles again.
+    fileprivate let keywordMatches = NSCache<NSString, NSNumber>()
+    
+    public init(keywords: [String], subreddits: [String]) {
+        self.keywords = keywords.map { $0.lowercased() }
+        self.subreddits = subreddits.map { $0.lowercased() }
+        self.automaton = KeywordAutomaton(keywords: self.keywords)
+        self.subredditNames = Set(self.subreddits)
+    }
+    
+    public var isEmpty: Bool {
+        return self.automaton == nil && self.subredditNames.isEmpty
+    }
+    
+    /// Returns true if the string contains any of the keywords, ignoring case.
+    public func containsKeyword(_ string: String) -> Bool {
+        guard let automaton = self.automaton, !string.isEmpty else {
+            return false
+        }
+        return automaton.matches(string.lowercased())
+    }
+    
+    /// Returns true if the subreddit name is one of the filtered subreddits, ignoring case.
+    public func containsSubreddit(_ name: String) -> Bool {
+        guard !self.subredditNames.isEmpty, !name.isEmpty else {
+            return false
+        }
+        return self.subredditNames.contains(name.lowercased())
+    }
+    
+    /**
+     Returns true if the content should be hidden. For comments the title and subreddit of their post are used.
+     
+     - parameter content: The post or comment to check. Should be used on the queue of its object context.
+     - parameter filteringSubreddits: Whether the filtered subreddits apply, usually only for collections that combine subreddits.
+     */
+    public func shouldFilter(_ content: Content, filteringSubreddits: Bool) -> Bool {
+        guard let post = (content as? Post) ?? (content as? Comment)?.post else {
+            return false
+        }
+        if self.postTitleContainsKeyword(post) {
+            return true
+        }
+        if filteringSubreddits, let subredditName = post.subreddit?.displayName {
+            return self.containsSubreddit(subredditName)
+        }
+        return false
+    }
+    
+    /// Scans the titles of the posts in the objects ahead of time, while parsing a collection.
+    func prepare(_ objects: NSOrderedSet) {
+        guard self.automaton != nil else {
+            return
+        }
+        for object in objects {
+            if let post = (object as? Post) ?? (object as? Comment)?.post {
+                _ = self.postTitleContainsKeyword(post)
+            }
+        }
+    }
+    
+    fileprivate func postTitleContainsKeyword(_ post: Post) -> Bool {
+        guard self.automaton != nil, let title = post.title else {
+            return false
+        }
+        guard let identifier = post.identifier as NSString? else {
+            return self.containsKeyword(title)
+        }
+        if let match = self.keywordMatches.object(forKey: identifier) {
+            return match.boolValue
+        }
+        let match = self.containsKeyword(title)
+        self.keywordMatches.setObject(NSNumber(value: match), forKey: identifier)
+        return match
+    }
+    
+}
+
+/// An Aho-Corasick automaton over UTF-8 bytes. The failure links are resolved into a complete transition table, so matching is a single table lookup per byte.
+private struct KeywordAutomaton {
+    
+    /// The column in the transition table for every byte. Bytes that don't occur in any keyword share column 0.
+    private let byteClasses: [Int]
+    
+    private let classCount: Int
+    
+    /// The next state for every state and byte class, stored row by row.
+    private let transitions: [Int32]
+    
+    /// Whether a keyword ends in the state, either directly or through its failure links.
+    private let isMatch: [Bool]
+    
+    init?(keywords: [String]) {
+        let patterns = keywords.map { Array($0.utf8) }.filter { !$0.isEmpty }
+        guard !patterns.isEmpty else {
+            return nil
+        }
+        
+        var byteClasses = [Int](repeating: 0, count: 256)
+        var classCount = 1
+        for pattern in patterns {
+            for byte in pattern where byteClasses[Int(byte)] == 0 {
+                byteClasses[Int(byte)] = classCount
+                classCount += 1
+            }
+        }
+        
+        // Build the trie, -1 marks a missing transition
+        var transitions = [Int32](repeating: -1, count: classCount)
+        var isMatch = [false]
+        for pattern in patterns {
+            var state = 0
+            for byte in pattern {
+                let index = state * classCount + byteClasses[Int(byte)]
+                if transitions[index] < 0 {
+                    transitions[index] = Int32(isMatch.count)
+                    isMatch.append(false)
+                    transitions.append(contentsOf: repeatElement(-1, count: classCount))
+                }
+                state = Int(transitions[index])
+            }
+            isMatch[state] = true
+        }
+        
+        // Resolve the failure links breadth first, so the failure state of a state is always complete before the state itself
+        var failure = [Int](repeating: 0, count: isMatch.count)
+        var queue = [Int]()
+        for byteClass in 0..<classCount {
+            if transitions[byteClass] < 0 {
+                transitions[byteClass] = 0
+            } else {
+                queue.append(Int(transitions[byteClass]))
+            }
+        }
+        var head = 0
+        while head < queue.count {
+            let state = queue[head]
+            head += 1
+            isMatch[state] = isMatch[state] || isMatch[failure[state]]
+            for byteClass in 0..<classCount {
+                let index = state * classCount + byteClass
+                let fallback = transitions[failure[state] * classCount + byteClass]
+                if transitions[index] < 0 {
+                    transitions[index] = fallback
+                } else {
+                    let next = Int(transitions[index])
+                    failure[next] = Int(fallback)
+                    queue.append(next)
+                }
+            }
+        }
+        
+        self.byteClasses = byteClasses
+        self.classCount = classCount
+        self.transitions = transitions
+        self.isMatch = isMatch
+    }
+    
+    func matches(_ string: String) -> Bool {
+        var state = 0
+        for byte in string.utf8 {
+            state = Int(self.transitions[state * self.classCount + self.byteClasses[Int(byte)]])
+            if self.isMatch[state] {
+                return true
+            }
+        }
+        return false
+    }
+    
+}
@@ -15,6 +15,8 @@ public class CollectionQuery {
     /// Should be non-nil if this is a search query, otherwise it should be left nil.
     public var searchKeywords: String?
     public var contentPredicate: NSPredicate?
+    /// Filters content on keywords and subreddits. The titles are scanned while parsing, the filter itself is applied by the views so changing it doesn't require a new collection.
+    public var contentFilter: ContentFilter?
     public var sortType = CollectionSortType.none
     
     var apiPath: String {
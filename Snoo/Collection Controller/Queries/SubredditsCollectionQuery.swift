@@ -68,9 +68,9 @@ public final class SubredditsCollectionQuery: CollectionQuery {
             return try super.prepopulate(context)
         }
         
-        let frontpage = try Subreddit.frontpageSubreddit()
+        let frontpage = try Subreddit.frontpageSubreddit(in: context)
         
-        let all = try Subreddit.allSubreddit()
+        let all = try Subreddit.allSubreddit(in: context)
         
         return try super.prepopulate(context) + [frontpage, all]
     }
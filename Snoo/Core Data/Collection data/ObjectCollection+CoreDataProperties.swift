@@ -14,6 +14,7 @@ extension ObjectCollection {
     @NSManaged public var sortType: String?
     @NSManaged public var objects: NSOrderedSet?
     @NSManaged public var lastRefresh: Date?
+    @NSManaged public var lastAccessDate: Date?
     @NSManaged public var searchKeywords: String?
     @NSManaged public var expirationDate: Date?
     @NSManaged public var isBookmarked: NSNumber?
@@ -60,7 +60,7 @@ public class Comment: InteractiveContent {
                 postID = SyncObject.identifierWithObjectName(linkID)
             }
             
-            if let postID: String = postID, let post: Post = try Post.objectWithIdentifier(postID, cache: nil, context: self.managedObjectContext!) as? Post {
+            if let postID: String = postID, let post: Post = try Post.objectWithIdentifier(postID, cache: cache, context: self.managedObjectContext!) as? Post {
                 if let postTitle: String = json["link_title"] as? String {
                     post.title = postTitle.stringByUnescapeHTMLEntities()
                 }
@@ -69,7 +69,7 @@ public class Comment: InteractiveContent {
                 }
                 if let subredditID: String = json["subreddit_id"] as? String, let subreddit: String = json["subreddit"] as? String {
                     let subredditDictionary: [String: String] = ["name": subredditID, "display_name": subreddit]
-                    if let subreddit: Subreddit = try Subreddit.objectWithDictionary(subredditDictionary as NSDictionary, cache: nil, context: self.managedObjectContext!) as? Subreddit {
+                    if let subreddit: Subreddit = try Subreddit.objectWithDictionary(subredditDictionary as NSDictionary, cache: cache, context: self.managedObjectContext!) as? Subreddit {
                         try subreddit.parseObject(subredditDictionary as NSDictionary, cache: nil)
                         post.subreddit = subreddit
                     }
@@ -87,7 +87,7 @@ public class Comment: InteractiveContent {
         
         if let parentID: String = json["parent_id"] as? String, parentID.range(of: "t1_") != nil {
             let parentCommentID: String = parentID.replacingOccurrences(of: "t1_", with: "")
-            if let parentComment: Comment = try Comment.objectWithIdentifier(parentCommentID, cache: nil, context: self.managedObjectContext!) as? Comment {
+            if let parentComment: Comment = try Comment.objectWithIdentifier(parentCommentID, cache: cache, context: self.managedObjectContext!) as? Comment {
                 self.parent = parentComment
             }
         }
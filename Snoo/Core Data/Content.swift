@@ -77,6 +77,8 @@ public class Content: SyncObject {
         if let likes = json["likes"] as? NSNumber {
             self.voteStatus = NSNumber(value: VoteStatus.statusFromBool(likes.boolValue).rawValue)
         }
+        //Votes and saves that haven't been sent yet are newer than the state reddit returned
+        UserActivityController.shared.applyPendingActions([.vote, .save], to: self)
      
         if let creationEpoch = json["created_utc"] as? NSNumber, self.creationDate == nil {
             self.creationDate = Date(timeIntervalSince1970: creationEpoch.doubleValue)
@@ -55,6 +55,11 @@ public class InteractiveContent: Content {
             let parsingOperation = CollectionParsingOperation(query: CollectionQuery())
             parsingOperation.data = replyData as NSDictionary?
             parsingOperation.objectContext = context
+            if let identityMap = cache as? SyncObjectIdentityMap {
+                // The objects in the replies have been prefetched together with this object
+                parsingOperation.identityMap = identityMap
+                parsingOperation.prefetchesObjects = false
+            }
             
             let replies = (try parsingOperation.parseListing(replyData as NSDictionary)).filtered(using: NSPredicate(format: "self isKindOfClass: %@", argumentArray: [InteractiveContent.self]))
             self.replies = replies
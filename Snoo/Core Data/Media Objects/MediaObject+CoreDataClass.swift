@@ -41,35 +41,45 @@ public class MediaObject: NSManagedObject, SyncableObject {
         return "MediaObject"
     }
     
+    // MARK: - Thumbnails
+    
+    /// The decoded ladder and the data it was decoded from, so the data is only decoded again when it changes, for example after merging changes from another context.
+    fileprivate var cachedThumbnailLadder: (data: Data?, ladder: ThumbnailLadder)?
+    
+    /// The thumbnails of the media object sorted by width. Objects stored before the ladder existed build it from their thumbnails.
+    public var thumbnailLadder: ThumbnailLadder {
+        let data = self.thumbnailLadderData
+        if let cached = self.cachedThumbnailLadder, cached.data == data {
+            return cached.ladder
+        }
+        let ladder = data.flatMap { ThumbnailLadder(data: $0) } ?? ThumbnailLadder(thumbnails: self.thumbnails ?? [])
+        self.cachedThumbnailLadder = (data, ladder)
+        return ladder
+    }
+    
+    /// Stores the ladder for the current thumbnails. Call this after changing the thumbnails of the media object.
+    public func updateThumbnailLadder() {
+        let ladder = ThumbnailLadder(thumbnails: self.thumbnails ?? [])
+        let data = ladder.isEmpty ? nil : ladder.data
+        self.thumbnailLadderData = data
+        self.cachedThumbnailLadder = (data, ladder)
+    }
+    
+    /// The URL of the best thumbnail for a view of the size, in points. This doesn't fetch anything from the store.
+    open func thumbnailURL(for size: CGSize) -> URL? {
+        return self.thumbnailLadder.url(for: size)
+    }
+    
     open func thumbnailWithSize(_ size: CGSize) -> Thumbnail? {
-        let widerImageFetchRequest = NSFetchRequest<Thumbnail>(entityName: Thumbnail.entityName())
-        let scale: CGFloat = min(2.0, UIScreen.main.scale)
-        widerImageFetchRequest.predicate = NSPredicate(format: "mediaObject == %@ && pixelWidth >= %f", self, size.width * scale)
-        widerImageFetchRequest.sortDescriptors = [NSSortDescriptor(key: "pixelWidth", ascending: true)]
-        
-        do {
-            if let biggerThumb = (try self.managedObjectContext?.fetch(widerImageFetchRequest))?.first {
-                return biggerThumb
-            } else {
-                let smallerImageFetchRequest = NSFetchRequest<Thumbnail>(entityName: Thumbnail.entityName())
-                smallerImageFetchRequest.predicate = NSPredicate(format: "mediaObject == %@ && pixelWidth <= %f", self, size.width * scale)
-                smallerImageFetchRequest.sortDescriptors = [NSSortDescriptor(key: "pixelWidth", ascending: false)]
-                if let biggerThumb = (try self.managedObjectContext?.fetch(smallerImageFetchRequest))?.first {
-                    return biggerThumb
-                } else {
-                    let anyImageFetchRequest = NSFetchRequest<Thumbnail>(entityName: Thumbnail.entityName())
-                    anyImageFetchRequest.predicate = NSPredicate(format: "mediaObject == %@", self)
-                    anyImageFetchRequest.sortDescriptors = [NSSortDescriptor(key: "pixelWidth", ascending: false)]
-                    if let thumbnail = (try self.managedObjectContext?.fetch(anyImageFetchRequest))?.first {
-                        return thumbnail
-                    }
-                    return nil
-                }
-            }
-        } catch {
-            NSLog("Could not fetch thumbnails for media object %@: \(error)", self)
+        guard let url = self.thumbnailURL(for: size) else {
             return nil
         }
+        return self.thumbnails?.first(where: { $0.url == url })
+    }
+    
+    public override func didTurnIntoFault() {
+        super.didTurnIntoFault()
+        self.cachedThumbnailLadder = nil
     }
     
     internal func parseRedditResolutionThumbnails(forImage image: [String: Any], json: NSDictionary) {
@@ -88,6 +98,7 @@ public class MediaObject: NSManagedObject, SyncableObject {
             return thumbnail
         })
         self.thumbnails = Set(thumbnails)
+        self.updateThumbnailLadder()
     }
     
 }
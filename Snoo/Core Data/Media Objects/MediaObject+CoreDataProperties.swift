@@ -26,6 +26,7 @@ extension MediaObject {
     @NSManaged public var content: Content?
     @NSManaged public var thumbnails: Set<Thumbnail>?
     @NSManaged internal var isNSFWNumber: NSNumber?
+    @NSManaged internal var thumbnailLadderData: Data?
 
 }
 
@@ -0,0 +1,79 @@
+//
+//  ThumbnailLadder.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import UIKit
+
+/// The thumbnails of a media object sorted by width, so the thumbnail for a size can be picked without fetching the thumbnails from the store.
+///
+/// The ladder is a value type, once it has been read from a media object it can be used on any thread.
+public struct ThumbnailLadder: Codable, Equatable {
+    
+    public struct Rung: Codable, Equatable {
+        public let url: URL
+        public let pixelWidth: Int
+        public let pixelHeight: Int
+    }
+    
+    /// The thumbnails sorted by width, narrowest first.
+    public let rungs: [Rung]
+    
+    public init(rungs: [Rung]) {
+        self.rungs = rungs.sorted(by: { $0.pixelWidth < $1.pixelWidth })
+    }
+    
+    /// Creates a ladder from thumbnails, thumbnails without a URL are skipped.
+    public init<S: Sequence>(thumbnails: S) where S.Element == Thumbnail {
+        self.init(rungs: thumbnails.compactMap { (thumbnail) -> Rung? in
+            guard let url = thumbnail.url else {
+                return nil
+            }
+            return Rung(url: url, pixelWidth: thumbnail.pixelWidth?.intValue ?? 0, pixelHeight: thumbnail.pixelHeight?.intValue ?? 0)
+        })
+    }
+    
+    public var isEmpty: Bool {
+        return self.rungs.isEmpty
+    }
+    
+    /// Returns the narrowest thumbnail that is at least as wide as the pixel width, or the widest thumbnail if none of them is wide enough.
+    public func rung(forPixelWidth pixelWidth: CGFloat) -> Rung? {
+        var lowerBound = 0
+        var upperBound = self.rungs.count
+        while lowerBound < upperBound {
+            let middle = (lowerBound + upperBound) / 2
+            if CGFloat(self.rungs[middle].pixelWidth) < pixelWidth {
+                lowerBound = middle + 1
+            } else {
+                upperBound = middle
+            }
+        }
+        return lowerBound < self.rungs.count ? self.rungs[lowerBound] : self.rungs.last
+    }
+    
+    /// Returns the URL of the best thumbnail to show in a view of the size, in points.
+    public func url(for size: CGSize) -> URL? {
+        let scale: CGFloat = min(2.0, UIScreen.main.scale)
+        return self.rung(forPixelWidth: size.width * scale)?.url
+    }
+    
+    // MARK: - Storage
+    
+    init?(data: Data) {
+        guard let ladder = try? PropertyListDecoder().decode(ThumbnailLadder.self, from: data) else {
+            return nil
+        }
+        self = ladder
+    }
+    
+    var data: Data? {
+        let encoder = PropertyListEncoder()
+        encoder.outputFormat = .binary
+        return try? encoder.encode(self)
+    }
+    
+}
@@ -16,9 +16,14 @@ extension Notification.Name {
 extension Content {
 
     public func voteOperation(_ direction: VoteStatus, authenticationController: AuthenticationController) -> Operation {
+        return Content.voteRequest(direction, objectName: self.objectName!, authenticationController: authenticationController)
+    }
+    
+    /// The request that votes on the post or comment with the object name, for when the object itself isn't available.
+    class func voteRequest(_ direction: VoteStatus, objectName: String, authenticationController: AuthenticationController) -> RedditRequest {
         let request = RedditRequest(authenticationController: authenticationController)
         request.urlSession = authenticationController.userURLSession
-        var urlRequest = URLRequest(url: URL(string: "/api/vote?dir=\(direction.rawValue)&id=\(self.objectName!)", relativeTo: request.baseURL as URL)!)
+        var urlRequest = URLRequest(url: URL(string: "/api/vote?dir=\(direction.rawValue)&id=\(objectName)", relativeTo: request.baseURL as URL)!)
         urlRequest.httpMethod = "POST"
         request.urlRequest = urlRequest
         return request
@@ -96,23 +101,28 @@ extension Content {
     }
     
     public func saveToRedditOperation(_ save: Bool, authenticationController: AuthenticationController) -> Operation {
+        let request = Content.saveRequest(save, objectName: self.objectName!, authenticationController: authenticationController)
+        request.completionBlock = { [weak self] () in
+            self?.managedObjectContext?.perform({ () -> Void in
+                self?.isSaved = NSNumber(value: save as Bool)
+            })
+        }
+        
+        return request
+    }
+    
+    /// The request that saves or unsaves the post or comment with the object name, for when the object itself isn't available.
+    class func saveRequest(_ save: Bool, objectName: String, authenticationController: AuthenticationController) -> RedditRequest {
         let request = RedditRequest(authenticationController: authenticationController)
         request.urlSession = authenticationController.userURLSession
         let command = save ? "save" : "unsave"
         let url = URL(string: "/api/\(command)", relativeTo: request.baseURL as URL)!
         var urlComponents = URLComponents(url: url, resolvingAgainstBaseURL: true)!
-        urlComponents.queryItems = [URLQueryItem(name: "id", value: self.objectName)]
+        urlComponents.queryItems = [URLQueryItem(name: "id", value: objectName)]
         
         var urlRequest = URLRequest(url: urlComponents.url!)
         urlRequest.httpMethod = "POST"
         request.urlRequest = urlRequest
-        
-        request.completionBlock = { [weak self] () in
-            self?.managedObjectContext?.perform({ () -> Void in
-                self?.isSaved = NSNumber(value: save as Bool)
-            })
-        }
-        
         return request
     }
     
@@ -11,12 +11,99 @@ import CoreData
 
 extension MoreComment {
     
+    /// The number of children reddit returns for a single morechildren request.
+    public static let maximumChildrenPerRequest = 100
+    
+    /// The identifiers of the comments the placeholder stands for. Empty for a "continue this thread" placeholder, which can't be expanded.
+    public var childIdentifiers: [String] {
+        return self.children?.components(separatedBy: ",").filter { !$0.isEmpty } ?? []
+    }
+    
     public func moreChildrenOperation(_ post: Post, sort: CollectionSortType, commentsCollectionID: NSManagedObjectID, authenticationcontroller: AuthenticationController) -> [Operation]? {
-        guard post.objectName != nil && self.children != nil else {
+        guard post.objectName != nil && self.children != nil, let context = self.managedObjectContext else {
             return nil
         }
-        let redditRequest = RedditRequest(authenticationController: authenticationcontroller)
-        redditRequest.urlSession = authenticationcontroller.userURLSession
+        // The user is waiting for the comments to expand
+        return MoreComment.expandOperations([self], post: post, commentsCollectionID: commentsCollectionID, context: context, priority: .visibleContent, authenticationController: authenticationcontroller)
+    }
+    
+    /**
+     Creates the operations that replace the placeholders with the comments they stand for.
+     
+     The children of all placeholders are requested in chunks of `maximumChildrenPerRequest` and parsed by `ThingsParsingOperation`. Reddit only allows one morechildren request at a time, so every request waits for the previous one. Once all chunks are parsed, the new comments are grouped by their parent and the replies of every parent are changed once. Only the placeholders of which all children arrived are replaced. The others stay, so they can be expanded again, and the comments that did arrive for them are removed again.
+     
+     - parameter moreComments: The placeholders to expand, they should belong to the context.
+     - parameter context: The context the comments are parsed into.
+     - returns: The operations, or an empty array if none of the placeholders can be expanded.
+     */
+    public class func expandOperations(_ moreComments: [MoreComment], post: Post, commentsCollectionID: NSManagedObjectID, context: NSManagedObjectContext, priority: RequestPriority, authenticationController: AuthenticationController) -> [Operation] {
+        guard let linkName = post.objectName else {
+            return []
+        }
+        var placeholders = [(objectID: NSManagedObjectID, childIdentifiers: [String])]()
+        var childIdentifiers = [String]()
+        context.performAndWait {
+            var addedIdentifiers = Set<String>()
+            for moreComment in moreComments {
+                let identifiers = moreComment.childIdentifiers.filter { addedIdentifiers.insert($0).inserted }
+                if !identifiers.isEmpty {
+                    placeholders.append((moreComment.objectID, identifiers))
+                    childIdentifiers.append(contentsOf: identifiers)
+                }
+            }
+        }
+        guard !childIdentifiers.isEmpty else {
+            return []
+        }
+        
+        var operations = [Operation]()
+        var chunks = [[String]]()
+        var requests = [RedditRequest]()
+        var parsingOperations = [ThingsParsingOperation]()
+        for chunkStart in stride(from: 0, to: childIdentifiers.count, by: MoreComment.maximumChildrenPerRequest) {
+            let chunk = Array(childIdentifiers[chunkStart..<min(chunkStart + MoreComment.maximumChildrenPerRequest, childIdentifiers.count)])
+            let redditRequest = MoreComment.moreChildrenRequest(chunk, linkName: linkName, priority: priority, authenticationController: authenticationController)
+            if let previousRequest = requests.last {
+                // Concurrent morechildren requests are rejected by reddit
+                redditRequest.addDependency(previousRequest)
+            }
+            let parsingOperation = ThingsParsingOperation(request: redditRequest, context: context)
+            parsingOperation.addDependency(redditRequest)
+            operations.append(contentsOf: [redditRequest, parsingOperation])
+            chunks.append(chunk)
+            requests.append(redditRequest)
+            parsingOperations.append(parsingOperation)
+        }
+        
+        let applyOperation = BlockOperation(block: { () -> Void in
+            var arrivedIdentifiers = Set<String>()
+            var arrivedComments = [Comment]()
+            var failedComments = [Comment]()
+            for (index, parsingOperation) in parsingOperations.enumerated() {
+                let comments = parsingOperation.things?.compactMap { $0 as? Comment } ?? []
+                if requests[index].isCancelled || requests[index].error != nil || parsingOperation.isCancelled {
+                    // A cancelled parse can have parsed a part of the chunk
+                    failedComments.append(contentsOf: comments)
+                } else {
+                    arrivedIdentifiers.formUnion(chunks[index])
+                    arrivedComments.append(contentsOf: comments)
+                }
+            }
+            context.performAndWait({
+                MoreComment.replacePlaceholders(placeholders, arrivedIdentifiers: arrivedIdentifiers, with: arrivedComments, failedComments: failedComments, commentsCollectionID: commentsCollectionID, context: context)
+            })
+        })
+        for parsingOperation in parsingOperations {
+            applyOperation.addDependency(parsingOperation)
+        }
+        operations.append(applyOperation)
+        return operations
+    }
+    
+    fileprivate class func moreChildrenRequest(_ childIdentifiers: [String], linkName: String, priority: RequestPriority, authenticationController: AuthenticationController) -> RedditRequest {
+        let redditRequest = RedditRequest(authenticationController: authenticationController)
+        redditRequest.urlSession = authenticationController.userURLSession
+        redditRequest.priority = priority
         let commentURL = URL(string: "/api/morechildren", relativeTo: redditRequest.baseURL as URL)!
         var commentURLComponents = URLComponents(url: commentURL, resolvingAgainstBaseURL: true)
         var queryItems = [URLQueryItem]()
@@ -26,48 +113,78 @@ extension MoreComment {
         if let url = commentURLComponents?.url {
             var urlRequest = URLRequest(url: url)
             urlRequest.httpMethod = "POST"
-            urlRequest.httpBody = DataRequest.formPOSTDataWithParameters(["children": self.children!, "link_id": post.objectName!, "api_type": "json"])
+            urlRequest.httpBody = DataRequest.formPOSTDataWithParameters(["children": childIdentifiers.joined(separator: ","), "link_id": linkName, "api_type": "json"])
             redditRequest.urlRequest = urlRequest
         }
+        return redditRequest
+    }
+    
+    /// Removes the placeholders of which all children arrived and adds the comments to their parents, or to the collection for top level comments. The replies of every parent are set once, instead of once per comment.
+    ///
+    /// The comments of the placeholders that stay, and their replies, are not added. They are deleted if they were new, so they don't stay behind in the store without a parent.
+    fileprivate class func replacePlaceholders(_ expandedPlaceholders: [(objectID: NSManagedObjectID, childIdentifiers: [String])], arrivedIdentifiers: Set<String>, with arrivedComments: [Comment], failedComments: [Comment], commentsCollectionID: NSManagedObjectID, context: NSManagedObjectContext) {
+        var placeholders = [MoreComment]()
+        var pendingIdentifiers = Set<String>()
+        for placeholder in expandedPlaceholders {
+            if arrivedIdentifiers.isSuperset(of: placeholder.childIdentifiers) {
+                if let moreComment = context.object(with: placeholder.objectID) as? MoreComment {
+                    placeholders.append(moreComment)
+                }
+            } else {
+                pendingIdentifiers.formUnion(placeholder.childIdentifiers)
+            }
+        }
         
-        if let context = self.managedObjectContext {
-            let parsingOperation = ThingsParsingOperation(request: redditRequest, context: context)
-            parsingOperation.addDependency(redditRequest)
-            
-            let blockOperation = BlockOperation(block: { () -> Void in
-                guard let things = parsingOperation.things, things.count > 0 else {
-                    return
+        // Replies come after their parent, so the replies of a dropped comment are dropped as well
+        var comments = [Comment]()
+        var droppedComments = failedComments
+        var droppedCommentIDs = Set(failedComments.map { $0.objectID })
+        for comment in arrivedComments {
+            if pendingIdentifiers.contains(comment.identifier ?? "") || (comment.parent.map { droppedCommentIDs.contains($0.objectID) } ?? false) {
+                droppedComments.append(comment)
+                droppedCommentIDs.insert(comment.objectID)
+            } else {
+                comments.append(comment)
+            }
+        }
+        for comment in droppedComments where comment.isInserted && !comment.isDeleted {
+            context.delete(comment)
+        }
+        
+        var parents = [InteractiveContent]()
+        var repliesByParent = [InteractiveContent: [Comment]]()
+        var topLevelComments = [Comment]()
+        for placeholder in placeholders {
+            if let parent = placeholder.parent, repliesByParent[parent] == nil {
+                parents.append(parent)
+                repliesByParent[parent] = []
+            }
+        }
+        for comment in comments {
+            if let parent = comment.parent {
+                if repliesByParent[parent] == nil {
+                    parents.append(parent)
                 }
-                self.managedObjectContext?.performAndWait({
-                    let commentsCollection = self.managedObjectContext?.object(with: commentsCollectionID) as? ObjectCollection
-                    let commentsCollectionSet = commentsCollection?.objects?.mutableCopy() as? NSMutableOrderedSet ?? NSMutableOrderedSet()
-                    if let replies = self.parent?.replies as? NSMutableOrderedSet {
-                        replies.remove(self)
-                        self.parent?.replies = replies
-                    } else {
-                        commentsCollectionSet.remove(self)
-                    }
-                    
-                    if let comments = parsingOperation.things as? [Comment] {
-                        
-                        for comment in comments {
-                            if let parent = comment.parent {
-                                let replies = parent.replies?.mutableCopy() as? NSMutableOrderedSet ?? NSMutableOrderedSet(capacity: 1)
-                                replies.add(comment)
-                                parent.replies = replies
-                            } else {
-                                commentsCollectionSet.add(comment)
-                            }
-                        }
-                    }
-                    commentsCollection?.objects = commentsCollectionSet
-                })
-            })
-            blockOperation.addDependency(parsingOperation)
-            
-            return [redditRequest, parsingOperation, blockOperation]
-        } else {
-            return nil
+                repliesByParent[parent, default: []].append(comment)
+            } else {
+                topLevelComments.append(comment)
+            }
+        }
+        
+        let placeholderSet = Set<AnyHashable>(placeholders)
+        for parent in parents {
+            let replies = parent.replies?.mutableCopy() as? NSMutableOrderedSet ?? NSMutableOrderedSet()
+            replies.minusSet(placeholderSet)
+            replies.addObjects(from: repliesByParent[parent] ?? [])
+            parent.replies = replies
+        }
+        
+        if let commentsCollection = context.object(with: commentsCollectionID) as? ObjectCollection {
+            let commentsCollectionSet = commentsCollection.objects?.mutableCopy() as? NSMutableOrderedSet ?? NSMutableOrderedSet()
+            commentsCollectionSet.minusSet(placeholderSet)
+            commentsCollectionSet.addObjects(from: topLevelComments)
+            commentsCollection.objects = commentsCollectionSet
         }
     }
+    
 }
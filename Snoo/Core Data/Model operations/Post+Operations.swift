@@ -27,17 +27,7 @@ extension Post {
     
     public func markHiddenOperation(_ hidden: Bool, authenticationController: AuthenticationController) -> Operation {
         if authenticationController.isAuthenticated {
-            let request = RedditRequest(authenticationController: authenticationController)
-            request.urlSession = authenticationController.userURLSession
-            let command = hidden ? "hide" : "unhide"
-            let url = URL(string: "/api/\(command)", relativeTo: request.baseURL as URL)!
-            var urlComponents = URLComponents(url: url, resolvingAgainstBaseURL: true)!
-            urlComponents.queryItems = [URLQueryItem(name: "id", value: self.objectName)]
-            
-            var urlRequest = URLRequest(url: urlComponents.url!)
-            urlRequest.httpMethod = "POST"
-            request.urlRequest = urlRequest
-            
+            let request = Post.markHiddenRequest(hidden, objectNames: [self.objectName!], authenticationController: authenticationController)
             request.completionBlock = { [weak self] () in
                 self?.managedObjectContext?.perform({ () -> Void in
                     self?.isHidden = NSNumber(value: hidden as Bool)
@@ -53,4 +43,19 @@ extension Post {
 
     }
     
+    /// The request that hides or unhides all posts with the object names at once.
+    class func markHiddenRequest(_ hidden: Bool, objectNames: [String], authenticationController: AuthenticationController) -> RedditRequest {
+        let request = RedditRequest(authenticationController: authenticationController)
+        request.urlSession = authenticationController.userURLSession
+        let command = hidden ? "hide" : "unhide"
+        let url = URL(string: "/api/\(command)", relativeTo: request.baseURL as URL)!
+        var urlComponents = URLComponents(url: url, resolvingAgainstBaseURL: true)!
+        urlComponents.queryItems = [URLQueryItem(name: "id", value: objectNames.joined(separator: ","))]
+        
+        var urlRequest = URLRequest(url: urlComponents.url!)
+        urlRequest.httpMethod = "POST"
+        request.urlRequest = urlRequest
+        return request
+    }
+    
 }
@@ -76,6 +76,7 @@ public final class Post: Content {
         
         self.title = (json["title"] as? String)?.stringByUnescapeHTMLEntities() ?? self.title
         self.isHidden = json["hidden"] as? NSNumber ?? self.isHidden
+        UserActivityController.shared.applyPendingActions([.hide], to: self)
         self.isSelfText = json["is_self"] as? NSNumber ?? self.isSelfText
         self.content = (json["selftext"] as? String)?.stringByUnescapeHTMLEntities() ?? self.content
         self.commentCount = json["num_comments"] as? NSNumber ?? self.commentCount
@@ -147,7 +148,7 @@ public final class Post: Content {
     /// Marks the post as visited and sends this to the reddit API if needed.
     /// This can not be undone
     ///
-    /// - Parameter save: If the object context should be saved and the state change should be sent to the reddit server. Defaults to true
+    /// - Parameter save: If the state change should be sent to the reddit server. The object context is saved together with the other actions of the user. Defaults to true
     public func markVisited(save: Bool = true) {
         var postMetadata: PostMetadata?
         if let existingMetadata = self.postMetadata {
@@ -166,9 +167,6 @@ public final class Post: Content {
         metadata.visited = NSNumber(value: true)
         
         if visitedChanged && save {
-            //We don't care if there was an error, since isVisited is just an extra feature and not important
-            ((try? self.managedObjectContext?.save()) as ()??)
-            
             NotificationCenter.default.post(name: .PostDidChangeVisitedState, object: self)
             //Send the visit of to the server queue for goldmembers
             UserActivityController.shared.addVisit(self)
@@ -176,9 +176,9 @@ public class Subreddit: SyncObject {
         NotificationCenter.default.post(name: .SubredditBookmarkDidChange, object: self)
     }
     
-    //Returns the frontpage subreddit. If it doesn't already exist in the context it will be created. This method is always done on the DataController's private context!
-    public class func frontpageSubreddit() throws -> Subreddit {
-        return try prepopulatedSubreddit(identifier: Subreddit.frontpageIdentifier, customization: { subreddit in
+    //Returns the frontpage subreddit. If it doesn't already exist in the context it will be created. Without a context this is done on the DataController's private context!
+    public class func frontpageSubreddit(in context: NSManagedObjectContext? = nil) throws -> Subreddit {
+        return try prepopulatedSubreddit(identifier: Subreddit.frontpageIdentifier, context: context, customization: { subreddit in
             subreddit.permalink = ""
             subreddit.sectionName = ""
             subreddit.order = NSNumber(value: 0)
@@ -188,9 +188,9 @@ public class Subreddit: SyncObject {
         })
     }
     
-    //Returns the /r/all subreddit. If it doesn't already exist in the context it will be created. This method is always done on the DataController's private context!
-    public class func allSubreddit() throws -> Subreddit {
-        return try prepopulatedSubreddit(identifier: Subreddit.allIdentifier) { subreddit in
+    //Returns the /r/all subreddit. If it doesn't already exist in the context it will be created. Without a context this is done on the DataController's private context!
+    public class func allSubreddit(in context: NSManagedObjectContext? = nil) throws -> Subreddit {
+        return try prepopulatedSubreddit(identifier: Subreddit.allIdentifier, context: context) { subreddit in
             subreddit.permalink = "/r/all"
             subreddit.sectionName = ""
             subreddit.order = NSNumber(value: 1)
@@ -200,8 +200,8 @@ public class Subreddit: SyncObject {
         }
     }
     
-    private class func prepopulatedSubreddit(identifier: String, customization block: (Subreddit) throws -> Void) throws -> Subreddit {
-        guard let context: NSManagedObjectContext = DataController.shared.privateContext else {
+    private class func prepopulatedSubreddit(identifier: String, context: NSManagedObjectContext?, customization block: (Subreddit) throws -> Void) throws -> Subreddit {
+        guard let context: NSManagedObjectContext = context ?? DataController.shared.privateContext else {
             throw NSError.snooError(localizedDescription: "Unable to obtain private managed object context")
         }
         var subreddit: Subreddit!
@@ -89,22 +89,13 @@ public class SyncObject: NSManagedObject {
         /*
         We have the following strategy here:
         1:  Check the cache whether it contains an NSManagedObjectID related to the identifier. If so, return the corresponding NSManagedObject.
-        2:  Fetch the database for the identifier and return the result.
+        2:  Fetch the database for the identifier and return the result. Skipped if an identity map already knows the object doesn't exist.
         3:  Insert the object and return the newly created one.
         */
         
         //Only do these checks if we sould check for an existing object
-        if checkForExisting {
-            // Strategy 1: Get it from cache
-            if let objectId = cache?.object(forKey: self.cacheIdentifier(identifier)), let object = context.object(with: objectId) as? SyncObject {
-                return object
-            }
-            
-            // Strategy 2: Fetch it manually (and add to cache so we don't need to fetch the next time)
-            if let fetchedObject = try fetchObjectWithIdentifier(identifier, context: context) {
-                cache?.setObject(fetchedObject.objectID, forKey: self.cacheIdentifier(identifier))
-                return fetchedObject
-            }
+        if checkForExisting, let existingObject = try self.existingObjectWithIdentifier(identifier, cache: cache, context: context) {
+            return existingObject
         }
         
         // Strategy 3: Insert it
@@ -117,6 +108,35 @@ public class SyncObject: NSManagedObject {
         return insertedObject
     }
     
+    /**
+    Returns the existing object with the given identifier, using the cache first. If the object does not exist, the method will return nil.
+    - parameter identifier: The identifier of the object to return.
+    - parameter cache: The parsing cache, or an identity map that has prefetched the object.
+    - parameter context: The Core Data context to use for fetching.
+    - returns: The object or nil if it does not exist.
+    */
+    class func existingObjectWithIdentifier(_ identifier: String, cache: NSCache<NSString, NSManagedObjectID>?, context: NSManagedObjectContext) throws -> SyncObject? {
+        let cacheIdentifier = self.cacheIdentifier(identifier)
+        
+        // Strategy 1: Get it from cache. The object might have been deleted if the cache is kept between parses.
+        if let objectId = cache?.object(forKey: cacheIdentifier), let object = (try? context.existingObject(with: objectId)) as? SyncObject, !object.isDeleted {
+            return object
+        }
+        
+        let identityMap = cache as? SyncObjectIdentityMap
+        if identityMap?.isMissingObject(forKey: cacheIdentifier) == true {
+            return nil
+        }
+        
+        // Strategy 2: Fetch it manually (and add to cache so we don't need to fetch the next time)
+        identityMap?.didFetchObject()
+        if let fetchedObject = try fetchObjectWithIdentifier(identifier, context: context) {
+            cache?.setObject(fetchedObject.objectID, forKey: cacheIdentifier)
+            return fetchedObject
+        }
+        return nil
+    }
+    
     /**
     Fetches an object with the given identifier from the given object context. If the object does not exist, the method will return nil.
     - parameter identifier: The identifier of the object to fetch.
@@ -204,13 +224,9 @@ public class SyncObject: NSManagedObject {
     Parses an object type and identifier from a Reddit 'fullname'.
     */
     public class func identifierAndTypeWithObjectName(_ name: String) throws -> (identifier: String, type: SyncObjectType)? {
-        let regex: NSRegularExpression = try NSRegularExpression(pattern: "(.*)_(.*)", options: [])
-        if let match: NSTextCheckingResult = regex.firstMatch(in: name, options: [], range: NSRange(location: 0, length: name.count)), match.numberOfRanges == 3 {
-            let identifier: NSString = (name as NSString).substring(with: match.range(at: 2)) as NSString
-            let kind: NSString = (name as NSString).substring(with: match.range(at: 1)) as NSString
-            if let type: SyncObjectType = SyncObjectType(rawValue: kind as String) {
-                return (identifier: identifier as String, type: type)
-            }
+        // The kind is everything before the last underscore. This is called for every object while parsing, so no regular expression is used.
+        if let separatorRange = name.range(of: "_", options: .backwards), let type = SyncObjectType(rawValue: String(name[..<separatorRange.lowerBound])) {
+            return (identifier: String(name[separatorRange.upperBound...]), type: type)
         }
         let userInfo: [String: String] = [NSLocalizedDescriptionKey: "Object name '\(name)' has an incorrect format."]
         throw NSError(domain: SnooErrorDomain, code: 500, userInfo: userInfo)
@@ -0,0 +1,140 @@
+//
+//  SyncObjectIdentityMap.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import Foundation
+import CoreData
+
+/// A parsing cache that can resolve the objects for a batch of full names up front, using a single fetch request per entity. After prefetching, looking up any of those objects doesn't need the store anymore, not even when the object doesn't exist yet and has to be inserted.
+///
+/// The identity map can be kept between parses of the same collection, as long as `prepareForParsing()` is called before every parse. Only use it on the queue of a single object context. Parses that can run at the same time on different contexts should each get their own identity map, seeded with the `savedObjectIDs(in:)` of earlier parses.
+public final class SyncObjectIdentityMap: NSCache<NSString, NSManagedObjectID> {
+    
+    /// The number of fetch requests done to look up objects using this identity map.
+    public fileprivate(set) var fetchRequestCount = 0
+    
+    /// The keys of objects that were not in the store while prefetching.
+    fileprivate var missingKeys = Set<NSString>()
+    
+    /// The keys of objects that were inserted, and only have a temporary object ID.
+    fileprivate var temporaryKeys = Set<NSString>()
+    
+    /// The keys of objects with a permanent object ID.
+    fileprivate var permanentKeys = Set<NSString>()
+    
+    /// Creates an identity map that already knows the objects, for example the objects an earlier parse saved.
+    public convenience init(objectIDs: [NSString: NSManagedObjectID]) {
+        self.init()
+        for (key, objectID) in objectIDs {
+            self.setObject(objectID, forKey: key)
+        }
+    }
+    
+    /// Removes everything that might have become invalid since the last parse. Other operations might have inserted objects, and temporary object IDs can't be used anymore after a save.
+    public func prepareForParsing() {
+        self.missingKeys.removeAll()
+        for key in self.temporaryKeys {
+            self.removeObject(forKey: key)
+        }
+        self.temporaryKeys.removeAll()
+    }
+    
+    override public func setObject(_ obj: NSManagedObjectID, forKey key: NSString) {
+        super.setObject(obj, forKey: key)
+        self.missingKeys.remove(key)
+        if obj.isTemporaryID {
+            self.temporaryKeys.insert(key)
+            self.permanentKeys.remove(key)
+        } else {
+            self.temporaryKeys.remove(key)
+            self.permanentKeys.insert(key)
+        }
+    }
+    
+    override public func removeAllObjects() {
+        super.removeAllObjects()
+        self.missingKeys.removeAll()
+        self.temporaryKeys.removeAll()
+        self.permanentKeys.removeAll()
+    }
+    
+    /**
+     Returns the object IDs of the objects that are in the store. Objects that were deleted, like inserted objects that were replaced by an object another context saved, are left out.
+     
+     Should be called on the queue of the context, after the context saved.
+     */
+    public func savedObjectIDs(in context: NSManagedObjectContext) -> [NSString: NSManagedObjectID] {
+        var objectIDs = [NSString: NSManagedObjectID]()
+        for key in self.permanentKeys {
+            guard let objectID = self.object(forKey: key), let object = context.registeredObject(for: objectID), !object.isDeleted, !object.isInserted else {
+                continue
+            }
+            objectIDs[key] = objectID
+        }
+        return objectIDs
+    }
+    
+    /// Updates the object ID of the object, for example after obtaining a permanent object ID.
+    func register(_ object: SyncObject) {
+        guard let identifier = object.identifier else {
+            return
+        }
+        self.setObject(object.objectID, forKey: type(of: object).cacheIdentifier(identifier))
+    }
+    
+    /// Returns true if the object for the cache identifier was prefetched and did not exist in the store.
+    func isMissingObject(forKey key: NSString) -> Bool {
+        return self.missingKeys.contains(key)
+    }
+    
+    /// Counts a fetch request that was done because the object was not in the identity map.
+    func didFetchObject() {
+        self.fetchRequestCount += 1
+    }
+    
+    /**
+     Resolves the objects for the given full names with a single fetch request per entity. Names that are already in the identity map are skipped.
+     
+     - parameter names: The full names of the objects, for example "t3_abc123".
+     - parameter context: The Core Data context to fetch the objects in.
+     */
+    public func prefetchObjects(withNames names: [String], context: NSManagedObjectContext) throws {
+        var identifiersPerType = [SyncObjectType: Set<String>]()
+        for name in names {
+            guard let (identifier, type) = try? SyncObject.identifierAndTypeWithObjectName(name), type.itemClass.entityName() != SyncObject.entityName() else {
+                continue
+            }
+            let key = type.itemClass.cacheIdentifier(identifier)
+            if self.object(forKey: key) == nil && !self.missingKeys.contains(key) {
+                identifiersPerType[type, default: Set<String>()].insert(identifier)
+            }
+        }
+        
+        for (type, identifiers) in identifiersPerType {
+            let itemClass = type.itemClass
+            let fetchRequest = NSFetchRequest<SyncObject>(entityName: itemClass.entityName())
+            fetchRequest.predicate = NSPredicate(format: "identifier IN %@", Array(identifiers))
+            // The objects are about to be parsed into, so there is no need to fire a fault for every object
+            fetchRequest.returnsObjectsAsFaults = false
+            let objects = try context.fetch(fetchRequest)
+            self.fetchRequestCount += 1
+            
+            var missingIdentifiers = identifiers
+            for object in objects {
+                guard let identifier = object.identifier else {
+                    continue
+                }
+                self.setObject(object.objectID, forKey: itemClass.cacheIdentifier(identifier))
+                missingIdentifiers.remove(identifier)
+            }
+            for identifier in missingIdentifiers {
+                self.missingKeys.insert(itemClass.cacheIdentifier(identifier))
+            }
+        }
+    }
+    
+}
@@ -34,10 +34,12 @@ final class BatchDeleteOperation: DataOperation {
                         break
                     }
                     let deleteRequest = NSBatchDeleteRequest(fetchRequest: fetchRequest)
-                    deleteRequest.resultType = .resultTypeCount
-                    if let result = try context.execute(deleteRequest) as? NSBatchDeleteResult, let deletedCount = result.result as? Int {
+                    deleteRequest.resultType = .resultTypeObjectIDs
+                    if let result = try context.execute(deleteRequest) as? NSBatchDeleteResult, let deletedObjectIDs = result.result as? [NSManagedObjectID] {
+                        // The batch delete bypasses the contexts, objects that are already in memory are removed from them
+                        DataController.shared.mergeStoreChanges([NSDeletedObjectsKey: deletedObjectIDs])
 #if DEBUG
-                        print("Deleted \(deletedCount) (\(fetchRequest.entityName!)) objects.")
+                        print("Deleted \(deletedObjectIDs.count) (\(fetchRequest.entityName!)) objects.")
 #endif
                     }
                 }
@@ -20,12 +20,21 @@ public final class CollectionParsingOperation: DataOperation {
     /// The source that that needs to be parsed
     internal var data: NSDictionary?
     
+    /// The raw response that needs to be parsed, if the data dictionary is not available. Listings are decoded from the response while parsing.
+    internal var responseBody: Data?
+    
     /// The query for which this response is parsed
     public var query: CollectionQuery
     
     /// In case this property is set to true, the operation will delete existing objects in the collection that are not present in the data dictionary
     var shouldDeleteMissingMemoryObjects = false
     
+    /// The identity map used to look up existing objects. Seed it with the objects earlier pages of the collection saved, so they don't have to be fetched again. Only used on the queue of the object context.
+    public var identityMap = SyncObjectIdentityMap()
+    
+    /// If the objects in a listing, including the objects they refer to and their replies, should be prefetched before parsing the listing.
+    var prefetchesObjects = true
+    
     // Output
     
     /// The resulting parsed object collection (in the private object context)
@@ -39,6 +48,9 @@ public final class CollectionParsingOperation: DataOperation {
     /// The first object identifier, to be used for a new previous request
     var before: String?
     
+    /// The number of fetch requests that were needed to look up existing objects while parsing
+    public fileprivate(set) var fetchRequestCount = 0
+    
     var requestOperation: RedditRequest? {
         let requestOperation = self.dependencies.first(where: { (operation) -> Bool in
             return operation is RedditRequest
@@ -63,18 +75,16 @@ public final class CollectionParsingOperation: DataOperation {
                 }
                 do {
                     try self.parseObjects(self.data!, context: self.objectContext!)
-                    self.objectCollection!.configureQuery(self.query)
-                    if self.objectCollection!.objectID.isTemporaryID {
-                        try self.objectContext?.obtainPermanentIDs(for: [self.objectCollection!])
-                    }
-                    
-                    if let objects = self.objectCollection!.objects {
-                        self.query.postProcessObjects(objects)
-                    }
+                    try self.configureObjectCollection()
                 } catch {
                     self.error = error
                 }
             }
+        } else if self.responseBody != nil {
+            self.parseResponseBody()
+        } else if let requestOperation = self.requestOperation, let responseBody = requestOperation.responseBody {
+            self.responseBody = responseBody
+            self.parseResponseBody()
         } else if let requestOperation = self.requestOperation, let data = requestOperation.result {
             self.data = data
             self.objectContext?.performAndWait { () -> Void in
@@ -83,14 +93,7 @@ public final class CollectionParsingOperation: DataOperation {
                 }
                 do {
                     try self.parseObjects(self.data!, context: self.objectContext!)
-                    self.objectCollection!.configureQuery(self.query)
-                    if self.objectCollection!.objectID.isTemporaryID {
-                        try self.objectContext?.obtainPermanentIDs(for: [self.objectCollection!])
-                    }
-                    
-                    if let objects = self.objectCollection!.objects {
-                        self.query.postProcessObjects(objects)
-                    }
+                    try self.configureObjectCollection()
                 } catch {
                     self.error = error
                 }
@@ -109,10 +112,60 @@ public final class CollectionParsingOperation: DataOperation {
         
     }
     
+    fileprivate func parseResponseBody() {
+        self.objectContext?.performAndWait { () -> Void in
+            guard self.isCancelled == false else {
+                return
+            }
+            do {
+                try self.parseObjects(responseBody: self.responseBody!, context: self.objectContext!)
+                try self.configureObjectCollection()
+            } catch {
+                self.error = error
+            }
+        }
+    }
+    
+    fileprivate func configureObjectCollection() throws {
+        self.objectCollection!.configureQuery(self.query)
+        if self.objectCollection!.objectID.isTemporaryID {
+            try self.objectContext?.obtainPermanentIDs(for: [self.objectCollection!])
+        }
+        
+        if let objects = self.objectCollection!.objects {
+            self.query.postProcessObjects(objects)
+        }
+    }
+    
     // MARK: - Parsing
     
     /// Parse all objects in the given Reddit API json response, in the given object context. This will set the objectCollection property and makes sure it is set. Otherwise, an error will be thrown.
     internal func parseObjects(_ json: AnyObject, context: NSManagedObjectContext) throws {
+        try self.parseObjectCollection { (collection) in
+            if let jsonDict = json as? NSDictionary, let data = jsonDict["data"] as? NSDictionary {
+                try self.parseRootData(data, inCollection: collection)
+            } else if let jsonArray = json as? NSArray {
+                let lastRootObject = jsonArray[jsonArray.count - 1]
+                try self.parseRootData(lastRootObject as! NSDictionary, inCollection: collection)
+            }
+        }
+    }
+    
+    /// Parse all objects in the given raw Reddit API response. Listings are decoded while parsing, so the complete response is never deserialized into dictionaries. Other responses are deserialized and parsed like a json response.
+    internal func parseObjects(responseBody: Data, context: NSManagedObjectContext) throws {
+        let decoder = ListingDecoder(data: responseBody)
+        guard let listing = decoder.decodeListing() else {
+            let json = try JSONSerialization.jsonObject(with: responseBody, options: [])
+            try self.parseObjects(json as AnyObject, context: context)
+            return
+        }
+        try self.parseObjectCollection { (collection) in
+            try self.parseRootListing(listing, decoder: decoder, inCollection: collection)
+        }
+    }
+    
+    /// Makes sure the objectCollection is set and parses the response into the collection using the given closure.
+    fileprivate func parseObjectCollection(_ parse: (ObjectCollection) throws -> Void) throws {
         
         if self.objectCollection == nil {
             self.objectCollection = try self.fetchLocalCollection(self.query)
@@ -127,15 +180,17 @@ public final class CollectionParsingOperation: DataOperation {
         }
         
         self.objectCollection!.lastRefresh = Date()
+        self.objectCollection!.lastAccessDate = self.objectCollection!.lastRefresh
         self.objectCollection!.sortType = query.sortType.rawValue
         
-        if let jsonDict = json as? NSDictionary, let data = jsonDict["data"] as? NSDictionary {
-            try self.parseRootData(data, inCollection: self.objectCollection!)
-        } else if let jsonArray = json as? NSArray {
-            let lastRootObject = jsonArray[jsonArray.count - 1]
-            try self.parseRootData(lastRootObject as! NSDictionary, inCollection: self.objectCollection!)
+        self.identityMap.prepareForParsing()
+        let initialFetchRequestCount = self.identityMap.fetchRequestCount
+        defer {
+            self.fetchRequestCount = self.identityMap.fetchRequestCount - initialFetchRequestCount
         }
         
+        try parse(self.objectCollection!)
+        
         // don't cache empty collections
         if self.objectCollection!.objects?.count ?? 0 == 1 {
             self.objectCollection?.expirationDate = nil
@@ -144,43 +199,10 @@ public final class CollectionParsingOperation: DataOperation {
     }
     
     func parseListing(_ data: NSDictionary) throws -> NSOrderedSet {
-        let cache = NSCache<NSString, NSManagedObjectID>()
-        
         if let children = data["children"] as? NSArray {
             
-            var fullNames = [String]()
-            for child in children {
-                if let childInfo = child as? NSDictionary, let childData = childInfo["data"] as? NSDictionary, let fullName = childData["name"] as? String {
-                    fullNames.append(fullName)
-                }
-            }
-            
-            var types = [SyncObjectType]()
-            for fullName in fullNames {
-                if let identifierAndType = ((try? SyncObject.identifierAndTypeWithObjectName(fullName)) as (identifier: String, type: SyncObjectType)??), let type = identifierAndType?.type, !types.contains(type) {
-                    types.append(type)
-                }
-            }
-            
-            var fetchRequests = [NSFetchRequest<SyncObject>]()
-            for type in types {
-                let identifiers = fullNames.filter({ $0.hasPrefix(type.rawValue) }).map({ return SyncObject.identifierWithObjectName($0)! })
-                if identifiers.count > 0 {
-                    let entityName = type.itemClass.entityName()
-                    let fetchRequest = NSFetchRequest<SyncObject>(entityName: entityName)
-                    fetchRequest.resultType = NSFetchRequestResultType()
-                    fetchRequest.predicate = NSPredicate(format: "identifier IN %@", identifiers)
-                    fetchRequests.append(fetchRequest)
-                }
-            }
-            
-            var objectPerFullName = [String: SyncObject]()
-            for fetchRequest in fetchRequests {
-                let objects = try self.objectContext.fetch(fetchRequest)
-                for object in objects {
-                    objectPerFullName[object.objectName!] = object
-                }
-
+            if self.prefetchesObjects {
+                try self.identityMap.prefetchObjects(withNames: self.referencedNames(inChildren: children), context: self.objectContext)
             }
             
             let childObjects = NSMutableOrderedSet(capacity: children.count)
@@ -198,7 +220,7 @@ public final class CollectionParsingOperation: DataOperation {
                 }
                 
                 // we have the kind enum and the itemClass as separate variabled, because we can have a message that references to for example a post. In this case kind is post, while itemClass is a message.
-                if let childObject = try self.parseChild(child as! NSDictionary, cache: cache, objectsCache: objectPerFullName) {
+                if let childObject = try self.parseChild(child as! NSDictionary) {
                     childObjects.add(childObject)
                 }
                 
@@ -210,6 +232,56 @@ public final class CollectionParsingOperation: DataOperation {
         throw NSError(domain: SnooErrorDomain, code: 500, userInfo: [NSLocalizedDescriptionKey: "Unexpected server response: listing data is nil"])
     }
     
+    /// Parses a listing decoded from the raw response. The full names of the children are collected while decoding, every child is only deserialized right before it is parsed.
+    func parseListing(_ listing: ListingDecoder.Listing, decoder: ListingDecoder) throws -> NSOrderedSet {
+        if self.prefetchesObjects {
+            try self.identityMap.prefetchObjects(withNames: listing.allNames, context: self.objectContext)
+        }
+        
+        let childObjects = NSMutableOrderedSet(capacity: listing.children.count)
+        
+        for (childIdx, child) in listing.children.enumerated() {
+            if child.kind == "Listing" && childIdx == listing.children.count - 1 {
+                guard let childListing = decoder.decodeListing(of: child) else {
+                    throw NSError(domain: SnooErrorDomain, code: 500, userInfo: [NSLocalizedDescriptionKey: "Unexpected server response: listing data is nil"])
+                }
+                return try self.parseListing(childListing, decoder: decoder)
+            }
+            
+            // Children of an unknown kind are not parsed, so there is no need to deserialize them
+            guard let kind = child.kind, SyncObjectType(rawValue: kind) != nil else {
+                continue
+            }
+            
+            try autoreleasepool {
+                if let childObject = try self.parseChild(try decoder.dictionary(for: child)) {
+                    childObjects.add(childObject)
+                }
+            }
+        }
+        
+        return childObjects
+    }
+    
+    /// The full names of the children, the objects they refer to and all objects in their replies.
+    fileprivate func referencedNames(inChildren children: NSArray) -> [String] {
+        var names = [String]()
+        for child in children {
+            guard let data = (child as? NSDictionary)?["data"] as? NSDictionary else {
+                continue
+            }
+            for key in ListingDecoder.referenceKeys {
+                if let name = data[key] as? String {
+                    names.append(name)
+                }
+            }
+            if let replyChildren = ((data["replies"] as? NSDictionary)?["data"] as? NSDictionary)?["children"] as? NSArray {
+                names.append(contentsOf: self.referencedNames(inChildren: replyChildren))
+            }
+        }
+        return names
+    }
+    
     fileprivate func isChildMoreType(_ child: NSDictionary) -> Bool? {
         if let childKind = child["kind"] as? String,
             let kind = SyncObjectType(rawValue: childKind) {
@@ -225,7 +297,7 @@ public final class CollectionParsingOperation: DataOperation {
                 do {
                     if let parentFullName = data["parent_id"] as? String,
                         let (parentIdentifier, parentType) = try SyncObject.identifierAndTypeWithObjectName(parentFullName),
-                        let parent = try CollectionQuery.objectType(parentType.rawValue)?.fetchObjectWithIdentifier(parentIdentifier, context: self.objectContext) as? InteractiveContent {
+                        let parent = try CollectionQuery.objectType(parentType.rawValue)?.existingObjectWithIdentifier(parentIdentifier, cache: self.identityMap, context: self.objectContext) as? InteractiveContent {
                             return (count.intValue, parent)
                     }
                 } catch {
@@ -236,23 +308,16 @@ public final class CollectionParsingOperation: DataOperation {
         return nil
     }
     
-    fileprivate func parseChild(_ child: NSDictionary, cache: NSCache<NSString, NSManagedObjectID>?, objectsCache: [String: SyncObject]? = nil) throws -> SyncObject? {
+    fileprivate func parseChild(_ child: NSDictionary) throws -> SyncObject? {
         
         if let childKind = child["kind"] as? String,
             let kind = SyncObjectType(rawValue: childKind),
             let data = child["data"] as? NSDictionary,
             let itemClass = CollectionQuery.objectType(childKind) {
             
-            var object: SyncObject!
-            if let objectsCache = objectsCache {
-                if let fullName = data["name"] as? String, let existingObject = objectsCache[fullName] {
-                    object = existingObject
-                } else {
-                    object = try itemClass.objectWithDictionary(data, cache: cache, context: self.objectContext, checkForExisting: false)
-                }
-            } else {
-                object = try itemClass.objectWithDictionary(data, cache: cache, context: self.objectContext)
-            }
+            // The existing objects have been prefetched into the identity map, so this doesn't need to fetch
+            let cache = self.identityMap
+            let object = try itemClass.objectWithDictionary(data, cache: cache, context: self.objectContext)
             
             do {
                 try object.parseObject(data, cache: cache)
@@ -265,6 +330,7 @@ public final class CollectionParsingOperation: DataOperation {
                     
                     if message.objectID.isTemporaryID {
                         try self.objectContext.obtainPermanentIDs(for: [message])
+                        cache.register(message)
                     }
                     
                     return message
@@ -272,6 +338,7 @@ public final class CollectionParsingOperation: DataOperation {
                 
                 if object.objectID.isTemporaryID {
                     try self.objectContext?.obtainPermanentIDs(for: [object])
+                    cache.register(object)
                 }
                 
                 return object
@@ -291,40 +358,22 @@ public final class CollectionParsingOperation: DataOperation {
         self.after = data["after"] as? String
         self.before = data["before"] as? String
         
-        let parsingContext: NSManagedObjectContext! = DataController.shared.privateContext
+        let parsingContext: NSManagedObjectContext! = self.objectContext
         
         // Parse objects and prepopulate with data given by the query.
         var parsedObjects = collection.objects?.mutableCopy() as? NSMutableOrderedSet ?? NSMutableOrderedSet()
         
-        var shouldUnionSet = true
-        if let collectionRequest = self.requestOperation as? RedditCollectionRequest {
-            shouldUnionSet = collectionRequest.after != nil
-        }
-        
         // Listing
         if data["children"] != nil {
             
             let responseObjects = try self.parseListing(data)
-            
-            if let oldObjects = collection.objects?.array as? [SyncObject], self.shouldDeleteMissingMemoryObjects {
-                for oldObject in oldObjects {
-                    if !responseObjects.contains(oldObject) {
-                        parsedObjects.remove(oldObject)
-                    }
-                }
-            }
-            
-            if shouldUnionSet {
-                parsedObjects.union(responseObjects)
-            } else {
-                parsedObjects = responseObjects.mutableCopy() as! NSMutableOrderedSet
-            }
+            parsedObjects = self.mergeResponseObjects(responseObjects, into: parsedObjects, collection: collection)
             
             // Single Subreddit object
         } else if query is MultiredditQuery {
             let parsedObject = try Multireddit.objectWithDictionary(data, cache: nil, context: parsingContext) as! Multireddit
             try parsedObject.parseObject(data, cache: nil)
-            if shouldUnionSet {
+            if self.shouldUnionObjects {
                 parsedObjects.union(NSOrderedSet(object: parsedObject))
             } else {
                 parsedObjects = NSOrderedSet(object: parsedObject).mutableCopy() as! NSMutableOrderedSet
@@ -332,13 +381,55 @@ public final class CollectionParsingOperation: DataOperation {
         } else if query is SubredditQuery {
             let parsedObject = try Subreddit.objectWithDictionary(data, cache: nil, context: parsingContext) as! Subreddit
             try parsedObject.parseObject(data, cache: nil)
-            if shouldUnionSet {
+            if self.shouldUnionObjects {
                 parsedObjects.union(NSOrderedSet(object: parsedObject))
             } else {
                 parsedObjects = NSOrderedSet(object: parsedObject).mutableCopy() as! NSMutableOrderedSet
             }
         }
         
+        try self.finishParsedObjects(parsedObjects, inCollection: collection)
+    }
+    
+    fileprivate func parseRootListing(_ listing: ListingDecoder.Listing, decoder: ListingDecoder, inCollection collection: ObjectCollection) throws {
+        
+        self.after = listing.after
+        self.before = listing.before
+        
+        let parsedObjects = collection.objects?.mutableCopy() as? NSMutableOrderedSet ?? NSMutableOrderedSet()
+        let responseObjects = try self.parseListing(listing, decoder: decoder)
+        try self.finishParsedObjects(self.mergeResponseObjects(responseObjects, into: parsedObjects, collection: collection), inCollection: collection)
+    }
+    
+    /// Whether the objects of the response should be added to the existing objects of the collection, instead of replacing them.
+    fileprivate var shouldUnionObjects: Bool {
+        if let collectionRequest = self.requestOperation as? RedditCollectionRequest {
+            return collectionRequest.after != nil
+        }
+        return true
+    }
+    
+    fileprivate func mergeResponseObjects(_ responseObjects: NSOrderedSet, into parsedObjects: NSMutableOrderedSet, collection: ObjectCollection) -> NSMutableOrderedSet {
+        if let oldObjects = collection.objects?.array as? [SyncObject], self.shouldDeleteMissingMemoryObjects {
+            for oldObject in oldObjects {
+                if !responseObjects.contains(oldObject) {
+                    parsedObjects.remove(oldObject)
+                }
+            }
+        }
+        
+        if self.shouldUnionObjects {
+            parsedObjects.union(responseObjects)
+            return parsedObjects
+        } else {
+            return responseObjects.mutableCopy() as! NSMutableOrderedSet
+        }
+    }
+    
+    /// Prepopulates and filters the parsed objects and sets them on the collection.
+    fileprivate func finishParsedObjects(_ parsedObjects: NSMutableOrderedSet, inCollection collection: ObjectCollection) throws {
+        let parsingContext: NSManagedObjectContext! = self.objectContext
+        
         // Prepopulate
         parsedObjects.addObjects(from: try self.query.prepopulate(parsingContext))
         
@@ -349,6 +440,7 @@ public final class CollectionParsingOperation: DataOperation {
             let distraction = (allObjects?.subtracting(parsedObjects.array as? [NSManagedObject] ?? [NSManagedObject]())) ?? Set<NSManagedObject>()
             self.filteredObjects = distraction
         }
+        self.query.contentFilter?.prepare(parsedObjects)
         
         collection.objects = parsedObjects
     }
@@ -0,0 +1,359 @@
+//
+//  ListingDecoder.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import Foundation
+
+/// Decodes a reddit listing response by scanning the raw JSON, without deserializing the complete response into dictionaries.
+///
+/// A single scan finds the children of the listing, together with their kind and full name. The children can then be deserialized one by one while they are parsed, so only a single child is in memory as dictionaries at a time.
+internal struct ListingDecoder {
+    
+    struct Child {
+        /// The byte range of the child object in the response data.
+        let range: Range<Int>
+        let kind: String?
+        /// The full name of the object (`data.name`), for example "t3_abc123".
+        let name: String?
+        /// The full names of the objects the child refers to, like its subreddit, post and parent, and of all objects in its replies.
+        let referencedNames: [String]
+    }
+    
+    struct Listing {
+        let after: String?
+        let before: String?
+        let children: [Child]
+        
+        /// The full names of all children and the objects they refer to.
+        var allNames: [String] {
+            var names = [String]()
+            for child in self.children {
+                if let name = child.name {
+                    names.append(name)
+                }
+                names.append(contentsOf: child.referencedNames)
+            }
+            return names
+        }
+    }
+    
+    /// The keys in the data of a child that contain the full name of the child or an object it refers to.
+    static let referenceKeys = ["name", "subreddit_id", "link_id", "parent_id"]
+    
+    let data: Data
+    
+    init(data: Data) {
+        self.data = data
+    }
+    
+    /// Scans the response for the listing. A response that is an array (like the post and comments of a thread) is returned as a listing with every item as a child. Returns nil if the response is not a listing or not valid JSON.
+    func decodeListing() -> Listing? {
+        return self.decodeListing(in: nil)
+    }
+    
+    /// Scans a child that is a listing itself.
+    func decodeListing(of child: Child) -> Listing? {
+        return self.decodeListing(in: child.range)
+    }
+    
+    /// Deserializes a single child into a dictionary, the same dictionary JSONSerialization would create for it as part of the complete response.
+    func dictionary(for child: Child) throws -> NSDictionary {
+        let range = self.data.startIndex + child.range.lowerBound..<self.data.startIndex + child.range.upperBound
+        guard let dictionary = try JSONSerialization.jsonObject(with: self.data.subdata(in: range), options: []) as? NSDictionary else {
+            throw NSError.snooError(500, localizedDescription: "Unexpected server response: listing child is not an object")
+        }
+        return dictionary
+    }
+    
+    // MARK: - Scanning
+    
+    private func decodeListing(in range: Range<Int>?) -> Listing? {
+        return self.data.withUnsafeBytes { (bytes: UnsafeRawBufferPointer) -> Listing? in
+            let scanner = JSONByteScanner(bytes: bytes, range: range ?? 0..<bytes.count)
+            switch scanner.peek() {
+            case JSONByteScanner.arrayStart:
+                guard let children = self.scanChildren(scanner) else {
+                    return nil
+                }
+                return Listing(after: nil, before: nil, children: children)
+            case JSONByteScanner.objectStart:
+                return self.scanListingObject(scanner)
+            default:
+                return nil
+            }
+        }
+    }
+    
+    private func scanListingObject(_ scanner: JSONByteScanner) -> Listing? {
+        var listing: Listing?
+        let isValid = scanner.scanObject { (key) -> Bool in
+            guard scanner.key(key, equals: ListingDecoder.dataKey), scanner.peek() == JSONByteScanner.objectStart else {
+                return scanner.skipValue()
+            }
+            listing = self.scanListingData(scanner)
+            return listing != nil
+        }
+        return isValid ? listing : nil
+    }
+    
+    private func scanListingData(_ scanner: JSONByteScanner) -> Listing? {
+        var after: String?
+        var before: String?
+        var children: [Child]?
+        let isValid = scanner.scanObject { (key) -> Bool in
+            if scanner.key(key, equals: ListingDecoder.afterKey) && scanner.peek() == JSONByteScanner.quote {
+                after = scanner.scanString()
+                return after != nil
+            } else if scanner.key(key, equals: ListingDecoder.beforeKey) && scanner.peek() == JSONByteScanner.quote {
+                before = scanner.scanString()
+                return before != nil
+            } else if scanner.key(key, equals: ListingDecoder.childrenKey) && scanner.peek() == JSONByteScanner.arrayStart {
+                children = self.scanChildren(scanner)
+                return children != nil
+            }
+            return scanner.skipValue()
+        }
+        guard isValid, let listingChildren = children else {
+            return nil
+        }
+        return Listing(after: after, before: before, children: listingChildren)
+    }
+    
+    private func scanChildren(_ scanner: JSONByteScanner) -> [Child]? {
+        var children = [Child]()
+        let isValid = scanner.scanArray { () -> Bool in
+            guard scanner.peek() == JSONByteScanner.objectStart else {
+                return false
+            }
+            let start = scanner.index
+            var kind: String?
+            var name: String?
+            var referencedNames = [String]()
+            let isValidChild = scanner.scanObject { (key) -> Bool in
+                if scanner.key(key, equals: ListingDecoder.kindKey) && scanner.peek() == JSONByteScanner.quote {
+                    kind = scanner.scanString()
+                    return kind != nil
+                } else if scanner.key(key, equals: ListingDecoder.dataKey) && scanner.peek() == JSONByteScanner.objectStart {
+                    return scanner.scanObject { (memberKey) -> Bool in
+                        if scanner.key(memberKey, equals: ListingDecoder.nameKey) && scanner.peek() == JSONByteScanner.quote {
+                            name = scanner.scanString()
+                            return name != nil
+                        } else if scanner.peek() == JSONByteScanner.quote, ListingDecoder.referenceKeyBytes.contains(where: { scanner.key(memberKey, equals: $0) }) {
+                            guard let referencedName = scanner.scanString() else {
+                                return false
+                            }
+                            referencedNames.append(referencedName)
+                            return true
+                        } else if scanner.key(memberKey, equals: ListingDecoder.repliesKey) && scanner.peek() == JSONByteScanner.objectStart {
+                            guard let replies = self.scanListingObject(scanner) else {
+                                return false
+                            }
+                            referencedNames.append(contentsOf: replies.allNames)
+                            return true
+                        }
+                        return scanner.skipValue()
+                    }
+                }
+                return scanner.skipValue()
+            }
+            guard isValidChild else {
+                return false
+            }
+            children.append(Child(range: start..<scanner.index, kind: kind, name: name, referencedNames: referencedNames))
+            return true
+        }
+        return isValid ? children : nil
+    }
+    
+    private static let dataKey = Array("data".utf8)
+    private static let afterKey = Array("after".utf8)
+    private static let beforeKey = Array("before".utf8)
+    private static let childrenKey = Array("children".utf8)
+    private static let kindKey = Array("kind".utf8)
+    private static let nameKey = Array("name".utf8)
+    private static let repliesKey = Array("replies".utf8)
+    private static let referenceKeyBytes = ListingDecoder.referenceKeys.map { Array($0.utf8) }
+    
+}
+
+/// A minimal scanner over UTF-8 encoded JSON. Values that are not needed are skipped without decoding them. Only valid while the bytes are.
+private final class JSONByteScanner {
+    
+    static let quote: UInt8 = 0x22
+    static let backslash: UInt8 = 0x5C
+    static let colon: UInt8 = 0x3A
+    static let comma: UInt8 = 0x2C
+    static let objectStart: UInt8 = 0x7B
+    static let objectEnd: UInt8 = 0x7D
+    static let arrayStart: UInt8 = 0x5B
+    static let arrayEnd: UInt8 = 0x5D
+    
+    private let bytes: UnsafeRawBufferPointer
+    private let end: Int
+    private(set) var index: Int
+    
+    init(bytes: UnsafeRawBufferPointer, range: Range<Int>) {
+        self.bytes = bytes
+        self.index = range.lowerBound
+        self.end = min(range.upperBound, bytes.count)
+    }
+    
+    /// Returns the next byte that is not whitespace, without consuming it.
+    func peek() -> UInt8? {
+        while self.index < self.end {
+            switch self.bytes[self.index] {
+            case 0x20, 0x09, 0x0A, 0x0D:
+                self.index += 1
+            default:
+                return self.bytes[self.index]
+            }
+        }
+        return nil
+    }
+    
+    private func consume(_ byte: UInt8) -> Bool {
+        guard self.peek() == byte else {
+            return false
+        }
+        self.index += 1
+        return true
+    }
+    
+    /// Scans over a string, returns the byte range of its contents and whether it contains escaped characters.
+    private func scanStringRange() -> (range: Range<Int>, isEscaped: Bool)? {
+        guard self.consume(JSONByteScanner.quote) else {
+            return nil
+        }
+        let start = self.index
+        var isEscaped = false
+        while self.index < self.end {
+            switch self.bytes[self.index] {
+            case JSONByteScanner.backslash:
+                isEscaped = true
+                self.index += 2
+            case JSONByteScanner.quote:
+                let range = start..<self.index
+                self.index += 1
+                return (range, isEscaped)
+            default:
+                self.index += 1
+            }
+        }
+        return nil
+    }
+    
+    func scanString() -> String? {
+        guard let string = self.scanStringRange() else {
+            return nil
+        }
+        guard string.isEscaped else {
+            return String(decoding: UnsafeRawBufferPointer(rebasing: self.bytes[string.range]), as: UTF8.self)
+        }
+        // Let JSONSerialization handle the (rare) escaped strings, including the quotes
+        let data = Data(self.bytes[string.range.lowerBound - 1..<string.range.upperBound + 1])
+        return (try? JSONSerialization.jsonObject(with: data, options: [.allowFragments])) as? String
+    }
+    
+    func key(_ key: Range<Int>, equals expectedKey: [UInt8]) -> Bool {
+        guard key.count == expectedKey.count else {
+            return false
+        }
+        for (offset, byte) in expectedKey.enumerated() where self.bytes[key.lowerBound + offset] != byte {
+            return false
+        }
+        return true
+    }
+    
+    /// Scans the object at the current position. The member handler is called with the range of every key and should scan or skip its value. Returns false if the JSON is invalid or a handler returned false.
+    func scanObject(_ member: (_ key: Range<Int>) -> Bool) -> Bool {
+        guard self.consume(JSONByteScanner.objectStart) else {
+            return false
+        }
+        if self.consume(JSONByteScanner.objectEnd) {
+            return true
+        }
+        while true {
+            guard let key = self.scanStringRange(), self.consume(JSONByteScanner.colon), member(key.range) else {
+                return false
+            }
+            if self.consume(JSONByteScanner.objectEnd) {
+                return true
+            }
+            guard self.consume(JSONByteScanner.comma) else {
+                return false
+            }
+        }
+    }
+    
+    /// Scans the array at the current position. The element handler should scan or skip every element. Returns false if the JSON is invalid or a handler returned false.
+    func scanArray(_ element: () -> Bool) -> Bool {
+        guard self.consume(JSONByteScanner.arrayStart) else {
+            return false
+        }
+        if self.consume(JSONByteScanner.arrayEnd) {
+            return true
+        }
+        while true {
+            guard element() else {
+                return false
+            }
+            if self.consume(JSONByteScanner.arrayEnd) {
+                return true
+            }
+            guard self.consume(JSONByteScanner.comma) else {
+                return false
+            }
+        }
+    }
+    
+    /// Skips the value at the current position. Nested objects and arrays are skipped by counting brackets outside of strings.
+    func skipValue() -> Bool {
+        guard let byte = self.peek() else {
+            return false
+        }
+        switch byte {
+        case JSONByteScanner.quote:
+            return self.scanStringRange() != nil
+        case JSONByteScanner.objectStart, JSONByteScanner.arrayStart:
+            var depth = 0
+            while self.index < self.end {
+                switch self.bytes[self.index] {
+                case JSONByteScanner.quote:
+                    guard self.scanStringRange() != nil else {
+                        return false
+                    }
+                    continue
+                case JSONByteScanner.objectStart, JSONByteScanner.arrayStart:
+                    depth += 1
+                case JSONByteScanner.objectEnd, JSONByteScanner.arrayEnd:
+                    depth -= 1
+                    if depth == 0 {
+                        self.index += 1
+                        return true
+                    }
+                default:
+                    break
+                }
+                self.index += 1
+            }
+            return false
+        default:
+            // Numbers, true, false and null
+            let start = self.index
+            while self.index < self.end {
+                switch self.bytes[self.index] {
+                case JSONByteScanner.comma, JSONByteScanner.objectEnd, JSONByteScanner.arrayEnd, 0x20, 0x09, 0x0A, 0x0D:
+                    return self.index > start
+                default:
+                    self.index += 1
+                }
+            }
+            return self.index > start
+        }
+    }
+    
+}
@@ -28,7 +28,11 @@ public final class SaveOperation: DataOperation {
         }
         
         do {
-            try DataController.shared.saveContext(self.objectContext)
+            if DataController.shared.isParsingContext(self.objectContext) {
+                try DataController.shared.saveParsingContext(self.objectContext)
+            } else {
+                try DataController.shared.saveContext(self.objectContext)
+            }
         } catch {
             self.error = error as NSError
         }
@@ -0,0 +1,117 @@
+//
+//  StoreEvictionOperation.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import CoreData
+
+/// Evicts the least recently used collections when the store is over the budget of the cache controller. A collection is evicted together with the content that no other collection refers to, including the replies of that content.
+final class StoreEvictionOperation: DataOperation {
+    
+    let cacheController: StoreCacheController
+    
+    init(cacheController: StoreCacheController) {
+        self.cacheController = cacheController
+        super.init()
+    }
+    
+    override func start() {
+        super.start()
+        
+        // The objects are deleted in their own context, so the deletions can be merged into the live contexts like any other save
+        let context = DataController.shared.createBackgroundContext(name: "eviction")
+        context.performAndWait {
+            guard self.isCancelled == false else {
+                return
+            }
+            do {
+                self.cacheController.writeAccessDates(in: context)
+                
+                let storeSize = self.cacheController.storeSize
+                let targetSize = Int64(Double(self.cacheController.byteBudget) * self.cacheController.evictionTarget)
+                // The file doesn't shrink until it is compacted, evicting again would evict the same bytes twice
+                if storeSize > self.cacheController.byteBudget && !self.cacheController.isCompactionPending {
+                    try self.evictCollections(freeing: storeSize - targetSize, storeSize: storeSize, context: context)
+                }
+            } catch {
+                self.error = error
+            }
+        }
+        
+        if self.error == nil {
+            do {
+                try DataController.shared.saveContext(context)
+            } catch {
+                self.error = error
+            }
+        }
+        
+        self.finishOperation()
+    }
+    
+    fileprivate func evictCollections(freeing bytesToFree: Int64, storeSize: Int64, context: NSManagedObjectContext) throws {
+        // Rows differ in size, the size of a collection is estimated using the average size of an object in the store
+        let entityNames = [SyncObject.entityName(), ObjectCollection.entityName(), MediaObject.entityName(), Thumbnail.entityName(), PostMetadata.entityName()]
+        let objectCount = try entityNames.reduce(0) { (count, entityName) -> Int in
+            return count + (try context.count(for: NSFetchRequest<NSFetchRequestResult>(entityName: entityName)))
+        }
+        let bytesPerObject = storeSize / Int64(max(1, objectCount))
+        
+        // Collections that are on screen are never evicted, subreddit and message collections are small and always needed
+        let fetchRequest = NSFetchRequest<ObjectCollection>(entityName: ContentCollection.entityName())
+        fetchRequest.predicate = NSPredicate(format: "isBookmarked != YES && NOT (self IN %@)", Array(CollectionChangeDispatcher.shared.shownCollectionIDs))
+        fetchRequest.sortDescriptors = [NSSortDescriptor(key: "lastAccessDate", ascending: true), NSSortDescriptor(key: "lastRefresh", ascending: true)]
+        fetchRequest.fetchBatchSize = 20
+        
+        var freedBytes: Int64 = 0
+        var evictedCollectionCount = 0
+        var evictedObjectCount = 0
+        for collection in try context.fetch(fetchRequest) {
+            guard freedBytes < bytesToFree, self.isCancelled == false else {
+                break
+            }
+            let objects = self.objectGraph(of: collection)
+            for object in objects {
+                context.delete(object)
+            }
+            // Media objects and thumbnails are deleted by the cascade rules, count them as well
+            let mediaObjectCount = objects.reduce(0) { $0 + (($1 as? Content)?.mediaObjects?.count ?? 0) * 2 }
+            freedBytes += Int64(objects.count + mediaObjectCount) * bytesPerObject
+            evictedCollectionCount += 1
+            evictedObjectCount += objects.count
+        }
+        
+        self.cacheController.didEvict(collectionCount: evictedCollectionCount, objectCount: evictedObjectCount)
+#if DEBUG
+        print("Evicted \(evictedCollectionCount) collections with \(evictedObjectCount) objects, about \(ByteCountFormatter().string(fromByteCount: freedBytes)).")
+#endif
+    }
+    
+    /// The collection and the content that is only in this collection. Replies are included, unless another collection refers to them.
+    fileprivate func objectGraph(of collection: ObjectCollection) -> Set<NSManagedObject> {
+        var objects: Set<NSManagedObject> = [collection]
+        var candidates = collection.objects?.array as? [SyncObject] ?? []
+        while let candidate = candidates.popLast() {
+            guard candidate is Content, !objects.contains(candidate), candidate.isBookmarked.boolValue == false else {
+                continue
+            }
+            // Collections that were evicted before are deleted, but still refer to their objects until the context processes the changes
+            let isInOtherCollection = candidate.collections?.contains(where: { (otherCollection) -> Bool in
+                let otherCollection = otherCollection as! NSManagedObject
+                return otherCollection !== collection && !otherCollection.isDeleted
+            }) ?? false
+            guard !isInOtherCollection else {
+                continue
+            }
+            objects.insert(candidate)
+            if let replies = (candidate as? InteractiveContent)?.replies?.array as? [SyncObject] {
+                candidates.append(contentsOf: replies)
+            }
+        }
+        return objects
+    }
+    
+}
@@ -18,6 +18,14 @@ extension Notification.Name {
     
 }
 
+/// How collections are parsed.
+public enum ParsingConcurrency {
+    /// Collections are parsed one at a time, on the private context.
+    case serial
+    /// Every collection is parsed on its own background context, so independent collections are parsed in parallel. The changes are merged into the private and view context when the parsing context is saved.
+    case concurrent
+}
+
 public final class DataController: NSObject {
     
     // MARK: - Static
@@ -60,8 +68,10 @@ public final class DataController: NSObject {
         
         self.viewContext = NSManagedObjectContext(concurrencyType: .mainQueueConcurrencyType)
         self.viewContext.parent = self.privateContext
+        self.mainContexts.add(self.viewContext)
         
         NotificationCenter.default.addObserver(self, selector: #selector(authenticationSessionsChangedNotification(_: )), name: AuthenticationController.AuthenticationSessionsChangedNotificationName, object: nil)
+        NotificationCenter.default.addObserver(self, selector: #selector(backgroundContextDidSave(_:)), name: NSNotification.Name.NSManagedObjectContextDidSave, object: nil)
     }
     
     deinit {
@@ -185,9 +195,109 @@ public final class DataController: NSObject {
     public func createMainContext() -> NSManagedObjectContext {
         let mainContext = NSManagedObjectContext(concurrencyType: NSManagedObjectContextConcurrencyType.mainQueueConcurrencyType)
         mainContext.parent = self.privateContext
+        self.mainContextsLock.lock()
+        self.mainContexts.add(mainContext)
+        self.mainContextsLock.unlock()
         return mainContext
     }
     
+    /// The view context and the contexts created with createMainContext, changes made outside of the private context are merged into these contexts.
+    fileprivate let mainContexts = NSHashTable<NSManagedObjectContext>.weakObjects()
+    
+    fileprivate let mainContextsLock = NSLock()
+    
+    // MARK: - Background contexts
+    
+    public var parsingConcurrency = ParsingConcurrency.concurrent
+    
+    fileprivate static let backgroundContextNamePrefix = "nl.madeawkward.snoo.background."
+    
+    fileprivate static let parsingContextName = DataController.backgroundContextNamePrefix + "parsing"
+    
+    /// Parsing contexts save one at a time, so a context can check which objects other parsing contexts saved before it saves itself.
+    fileprivate let parsingContextSaveLock = NSLock()
+    
+    /// Returns the context to parse a collection in. In concurrent mode this is a new background context that is connected to the persistent store coordinator, in serial mode it is the private context.
+    public func createParsingContext() -> NSManagedObjectContext {
+        guard self.parsingConcurrency == .concurrent else {
+            return self.privateContext
+        }
+        return self.createBackgroundContext(name: "parsing")
+    }
+    
+    /// Returns a new context on a private queue that is connected to the persistent store coordinator. When the context saves, the changes are merged into the private context and the main contexts.
+    internal func createBackgroundContext(name: String) -> NSManagedObjectContext {
+        let context = NSManagedObjectContext(concurrencyType: .privateQueueConcurrencyType)
+        context.persistentStoreCoordinator = self.storeCoordinator
+        context.name = DataController.backgroundContextNamePrefix + name
+        context.undoManager = nil
+        context.mergePolicy = NSMergePolicy(merge: NSMergePolicyType.mergeByPropertyObjectTrumpMergePolicyType)
+        return context
+    }
+    
+    internal func isParsingContext(_ context: NSManagedObjectContext?) -> Bool {
+        return context?.name == DataController.parsingContextName
+    }
+    
+    /// Saves a parsing context. Objects that another parsing context saved while this context was parsing are not inserted again.
+    internal func saveParsingContext(_ context: NSManagedObjectContext) throws {
+        self.parsingContextSaveLock.lock()
+        defer {
+            self.parsingContextSaveLock.unlock()
+        }
+        var thrownError: Error?
+        context.performAndWait {
+            do {
+                try context.replaceDuplicateInsertedObjects()
+            } catch {
+                thrownError = error
+            }
+        }
+        if let error = thrownError {
+            throw error
+        }
+        try self.saveContext(context)
+    }
+    
+    /// Merges the changes of a background context into the private context before the save returns, so a refresh in a child context of the private context shows the changes. The main contexts merge the changes on the main queue.
+    @objc fileprivate func backgroundContextDidSave(_ notification: Notification) {
+        guard let context = notification.object as? NSManagedObjectContext, context.name?.hasPrefix(DataController.backgroundContextNamePrefix) == true, context.persistentStoreCoordinator === self.storeCoordinator else {
+            return
+        }
+        self.privateContext.performAndWait {
+            self.privateContext.mergeChanges(fromContextDidSave: notification)
+        }
+        for mainContext in self.currentMainContexts {
+            mainContext.perform {
+                mainContext.mergeChanges(fromContextDidSave: notification)
+            }
+        }
+    }
+    
+    /**
+     Merges changes that were made directly in the store, like the results of a batch delete, into the private context and the main contexts. Objects that were deleted in the store are removed from the contexts, so they don't fail to fulfill their faults later.
+     
+     - parameter changes: The object IDs of the changes, by NSInsertedObjectsKey, NSUpdatedObjectsKey or NSDeletedObjectsKey.
+     */
+    internal func mergeStoreChanges(_ changes: [AnyHashable: Any]) {
+        self.privateContext.performAndWait {
+            NSManagedObjectContext.mergeChanges(fromRemoteContextSave: changes, into: [self.privateContext])
+        }
+        for mainContext in self.currentMainContexts {
+            mainContext.perform {
+                NSManagedObjectContext.mergeChanges(fromRemoteContextSave: changes, into: [mainContext])
+            }
+        }
+    }
+    
+    fileprivate var currentMainContexts: [NSManagedObjectContext] {
+        self.mainContextsLock.lock()
+        defer {
+            self.mainContextsLock.unlock()
+        }
+        return self.mainContexts.allObjects
+    }
+    
     fileprivate func databaseNameForUserIdentifier(_ userIdentifier: String?) -> String {
         return userIdentifier ?? "anonymous"
     }
@@ -268,6 +378,10 @@ public final class DataController: NSObject {
         //Clear the expired content before switching stores
         let expiredContentOperation = DataController.clearExpiredContentOperation()
         updateOperation.addDependency(expiredContentOperation)
+        // Collections that are parsed in parallel should also be done before switching stores
+        for parsingOperation in self.parsingQueue.operations {
+            expiredContentOperation.addDependency(parsingOperation)
+        }
         self.executeOperations([expiredContentOperation, updateOperation], handler: nil)
     }
     
@@ -289,6 +403,7 @@ public final class DataController: NSObject {
                 //Update the URL to the new URL
                 let currentDatabaseURL = self.databaseURLForName(currentIdentifier)
                 storeCoordinator.setURL(currentDatabaseURL, for: anonymousPersistentStore)
+                self.storeCacheController.storeURL = currentDatabaseURL
                 //Update the store identifier
                 anonymousPersistentStore.identifier = currentIdentifier
                 
@@ -331,13 +446,22 @@ public final class DataController: NSObject {
     
     fileprivate func addPersistentStore(_ databaseName: String) throws {
         let databaseURL = self.databaseURLForName(databaseName)
-        let options = [NSPersistentStoreFileProtectionKey: FileProtectionType.completeUntilFirstUserAuthentication,
+        var options = [NSPersistentStoreFileProtectionKey: FileProtectionType.completeUntilFirstUserAuthentication,
                        NSInferMappingModelAutomaticallyOption: NSNumber(value: true as Bool),
                        NSMigratePersistentStoresAutomaticallyOption: NSNumber(value: true as Bool)] as [String: Any]
+        // No objects of the store are in use yet, so this is the moment to give the space of evicted content back to the system
+        let compacts = FileManager.default.fileExists(atPath: databaseURL.path) && self.storeCacheController.needsCompaction
+        if compacts {
+            options[NSSQLiteManualVacuumOption] = NSNumber(value: true as Bool)
+        }
         
         do {
             let persistentStore = try self.storeCoordinator?.addPersistentStore(ofType: NSSQLiteStoreType, configurationName: nil, at: databaseURL, options: options)
             persistentStore?.identifier = databaseName
+            self.storeCacheController.storeURL = databaseURL
+            if compacts {
+                self.storeCacheController.didCompact()
+            }
         } catch let error as NSError {
             NSLog("Incompatible Core Data database found. Removing it...")
             if error.code == 134100 {
@@ -346,6 +470,7 @@ public final class DataController: NSObject {
 
                     // Try again
                     try self.storeCoordinator?.addPersistentStore(ofType: NSSQLiteStoreType, configurationName: nil, at: databaseURL, options: options)
+                    self.storeCacheController.storeURL = databaseURL
                     NSLog("Succesfully deleted old database instead of migrating.")
                 } catch {
                     fatalError("Core Data migration failed, could not resolve by deleting database.")
@@ -356,15 +481,19 @@ public final class DataController: NSObject {
         }
     }
     
+    // MARK: - Cache
+    
+    /// Keeps the store within its size budget by evicting the least recently used collections.
+    public let storeCacheController = StoreCacheController()
+    
     // MARK: - Operation Queues
     
-    lazy var networkingQueue: OperationQueue = {
-        let queue = OperationQueue()
-        queue.maxConcurrentOperationCount = 2
-        queue.name = "nl.madeawkward.snoo.networking"
-        queue.qualityOfService = QualityOfService.default
-        return queue
-    }()
+    /// Runs the network requests by priority and coalesces identical GET requests.
+    public let requestScheduler = RequestScheduler()
+    
+    var networkingQueue: OperationQueue {
+        return self.requestScheduler.queue
+    }
     
     lazy var operationQueue: OperationQueue = {
         let queue = OperationQueue()
@@ -374,21 +503,29 @@ public final class DataController: NSObject {
         return queue
     }()
     
-    lazy fileprivate var operationCompletionHandlerQueue: DispatchQueue = {
-        return DispatchQueue(label: "nl.madeawkward.snoo.operation-completion-handler", attributes: DispatchQueue.Attributes.concurrent)
+    /// Runs collections that are parsed on their own context, including the operations that depend on the parsing.
+    lazy var parsingQueue: OperationQueue = {
+        let queue = OperationQueue()
+        queue.maxConcurrentOperationCount = max(2, ProcessInfo.processInfo.activeProcessorCount)
+        queue.name = "nl.madeawkward.snoo.concurrent-parsing"
+        queue.qualityOfService = QualityOfService.userInitiated
+        return queue
     }()
     
-    lazy fileprivate var operationExecutionHandlerQueue: DispatchQueue = {
-        return DispatchQueue(label: "nl.madeawkward.snoo.operation-execution-handler", attributes: DispatchQueue.Attributes.concurrent)
+    /// Runs the completion operations of the operation graphs. They only become ready when their graph has finished, so no thread waits for a graph.
+    lazy fileprivate var completionQueue: OperationQueue = {
+        let queue = OperationQueue()
+        queue.name = "nl.madeawkward.snoo.operation-completion-handler"
+        return queue
     }()
     
     /// Returns the operations in the queue that return true for the given predicate handler. The order is undefined, because Snoo uses different queues internally.
     public func filterQueue(_ predicate: (Operation) -> Bool) -> [Operation] {
-        return (self.networkingQueue.operations + self.operationQueue.operations).filter(predicate)
+        return (self.networkingQueue.operations + self.operationQueue.operations + self.parsingQueue.operations).filter(predicate)
     }
     
-    fileprivate func operationsByAddingAuthentication(_ operations: [Operation]) -> [Operation] {
-        var operationsToAdd = operations
+    /// Returns the operations that make sure the requests are authenticated, the first reddit request depends on the last of them.
+    fileprivate func authenticationOperations(for operations: [Operation]) -> [Operation] {
         let redditOperations = operations.filter({ $0 is RedditRequest }) as! [RedditRequest]
         if let firstRedditOperation = redditOperations.first {
             let authenticationController = firstRedditOperation.authenticationController
@@ -398,74 +535,51 @@ public final class DataController: NSObject {
                 firstRedditOperation.addDependency(lastAuthenticationOperation)
             }
             
-            operationsToAdd.insert(contentsOf: authenticationOperations, at: 0)
+            return authenticationOperations
         }
-        return operationsToAdd
+        return [Operation]()
     }
     
-    public func executeOperations(_ operations: [Operation], handler: ((Error?) -> Void)?) {
-        
-        let allOperations = self.operationsByAddingAuthentication(operations)
+    /**
+     Executes the operations and their authentication, and calls the handler with the first error once all operations have finished. No thread waits for the operations while they run.
+     
+     - parameter handler: Called on a background queue when all operations have finished, also when they have been cancelled.
+     - returns: The graph of the operations, which can be used to cancel all of them.
+     */
+    @discardableResult
+    public func executeOperations(_ operations: [Operation], handler: ((Error?) -> Void)?) -> OperationGraph {
+        let authenticationOperations = self.authenticationOperations(for: operations)
+        let allOperations = authenticationOperations + operations
         let networkOperations = allOperations.filter({ $0 is DataRequest })
         let otherOperations = allOperations.filter({ !($0 is DataRequest) })
         
-        let dispatchGroup = DispatchGroup()
-        
-        var errors = [Error]()
+        // Authentication operations can be shared with other graphs, while a refresh of the session is in flight
+        let graph = OperationGraph(operations: allOperations, sharedOperations: authenticationOperations, handler: handler)
+        graph.propagateQualityOfService()
         
         if networkOperations.count > 0 {
-            dispatchGroup.enter()
-            self.addOperations(networkOperations, toQueue: self.networkingQueue, handler: { (error) -> Void in
-                if let error = error {
-                    errors.append(error)
-                }
-                dispatchGroup.leave()
-            })
+            self.requestScheduler.coalesce(networkOperations as! [DataRequest])
+            self.networkingQueue.addOperations(networkOperations, waitUntilFinished: false)
         }
         
         if otherOperations.count > 0 {
-            dispatchGroup.enter()
-            self.addOperations(otherOperations, toQueue: self.operationQueue, handler: { (error) -> Void in
-                if let error = error {
-                    errors.append(error)
-                }
-                dispatchGroup.leave()
-            })
+            // Operations that work on their own parsing context don't have to wait for other parsing
+            let usesParsingContext = otherOperations.contains(where: { self.isParsingContext(($0 as? CollectionParsingOperation)?.objectContext) })
+            (usesParsingContext ? self.parsingQueue : self.operationQueue).addOperations(otherOperations, waitUntilFinished: false)
         }
         
-        dispatchGroup.notify(queue: self.operationCompletionHandlerQueue, execute: {
-            if errors.count > 0 {
-                handler?(errors.first!)
-            } else {
-                handler?(nil)
-            }
-        })
-    }
-    
-    fileprivate func addOperations(_ operations: [Operation], toQueue queue: OperationQueue, handler: ((Error?) -> Void)?) {
-        self.operationExecutionHandlerQueue.async { () -> Void in
-           queue.addOperations(operations, waitUntilFinished: true)
-            
-            var error: Error?
-            for operation in operations {
-                if let dataOperation = operation as? DataOperation, error == nil {
-                    error = dataOperation.error
-                }
-                if let requestOperation = operation as? DataRequest, error == nil {
-                    error = requestOperation.error
-                }
-            }
-            handler?(error)
-        }
+        self.completionQueue.addOperation(graph.completionOperation)
+        return graph
     }
     
-    public func executeAndSaveOperations(_ operations: [Operation], context: NSManagedObjectContext? = nil, handler: ((Error?) -> Void)?) {
+    @discardableResult
+    public func executeAndSaveOperations(_ operations: [Operation], context: NSManagedObjectContext? = nil, handler: ((Error?) -> Void)?) -> OperationGraph {
         let objectContext = context ?? self.privateContext!
         let saveOperations = persistentSaveOperations(objectContext)
         if let lastOperation = operations.last {
             saveOperations.first?.addDependency(lastOperation)
         }
-        executeOperations(operations + saveOperations, handler: handler)
+        return executeOperations(operations + saveOperations, handler: handler)
     }
     
     /// Cancels all the current operations, waits for them to complete and then calls the completion handler
@@ -474,9 +588,11 @@ public final class DataController: NSObject {
     public func cancelAllOperations(completionHandler: (() -> Void)?) {
         self.networkingQueue.cancelAllOperations()
         self.operationQueue.cancelAllOperations()
+        self.parsingQueue.cancelAllOperations()
         DispatchQueue.global(qos: .userInitiated).async {
             self.networkingQueue.waitUntilAllOperationsAreFinished()
             self.operationQueue.waitUntilAllOperationsAreFinished()
+            self.parsingQueue.waitUntilAllOperationsAreFinished()
             completionHandler?()
         }
     }
@@ -0,0 +1,105 @@
+//
+//  NSManagedObjectContextExtensions.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import CoreData
+
+extension NSManagedObjectContext {
+    
+    /**
+     Replaces the sync objects this context inserted by the objects another context saved for the same identifier since they were inserted. Parsing contexts that run at the same time can both insert the same post or subreddit, this keeps a single object in the store.
+     
+     The values the context set on an inserted object are moved to the stored object, objects that refer to the inserted object will refer to the stored object instead. Should be called on the queue of the context, right before saving.
+     
+     - returns: The number of inserted objects that were replaced.
+     */
+    @discardableResult
+    func replaceDuplicateInsertedObjects() throws -> Int {
+        var insertedObjectsPerEntity = [String: [String: SyncObject]]()
+        for case let object as SyncObject in self.insertedObjects {
+            guard let entityName = object.entity.name, let identifier = object.identifier else {
+                continue
+            }
+            insertedObjectsPerEntity[entityName, default: [String: SyncObject]()][identifier] = object
+        }
+        
+        var replacedCount = 0
+        for (entityName, insertedObjects) in insertedObjectsPerEntity {
+            let fetchRequest = NSFetchRequest<SyncObject>(entityName: entityName)
+            fetchRequest.predicate = NSPredicate(format: "identifier IN %@", Array(insertedObjects.keys))
+            fetchRequest.includesSubentities = false
+            // Only objects that are in the store, the inserted objects themselves are pending changes
+            fetchRequest.includesPendingChanges = false
+            for storedObject in try self.fetch(fetchRequest) {
+                guard let identifier = storedObject.identifier, let insertedObject = insertedObjects[identifier], insertedObject !== storedObject else {
+                    continue
+                }
+                self.replace(insertedObject, with: storedObject)
+                replacedCount += 1
+            }
+        }
+        return replacedCount
+    }
+    
+    fileprivate func replace(_ insertedObject: NSManagedObject, with storedObject: NSManagedObject) {
+        let changedValues = insertedObject.changedValues()
+        
+        // The values that were parsed are newer than the stored values
+        for (name, _) in insertedObject.entity.attributesByName {
+            if let value = changedValues[name] {
+                storedObject.setValue(value is NSNull ? nil : value, forKey: name)
+            }
+        }
+        
+        for (name, relationship) in insertedObject.entity.relationshipsByName where changedValues[name] != nil {
+            let relatedObjects: [NSManagedObject]
+            if let orderedSet = insertedObject.value(forKey: name) as? NSOrderedSet {
+                relatedObjects = orderedSet.array as? [NSManagedObject] ?? []
+            } else if let set = insertedObject.value(forKey: name) as? NSSet {
+                relatedObjects = set.allObjects as? [NSManagedObject] ?? []
+            } else if let object = insertedObject.value(forKey: name) as? NSManagedObject {
+                relatedObjects = [object]
+            } else {
+                relatedObjects = []
+            }
+            
+            guard let inverseRelationship = relationship.inverseRelationship else {
+                storedObject.setValue(insertedObject.value(forKey: name), forKey: name)
+                continue
+            }
+            
+            if relationship.isToMany && !inverseRelationship.isToMany && !relatedObjects.isEmpty {
+                // Children like replies or thumbnails are replaced as a whole, like a parse of the stored object would do
+                storedObject.setValue(relationship.isOrdered ? NSOrderedSet() : NSSet(), forKey: name)
+            }
+            
+            // Update the other side in place, so the stored object takes the position of the inserted object in ordered relationships
+            for relatedObject in relatedObjects {
+                if !inverseRelationship.isToMany {
+                    relatedObject.setValue(storedObject, forKey: inverseRelationship.name)
+                } else if inverseRelationship.isOrdered {
+                    let objects = relatedObject.mutableOrderedSetValue(forKey: inverseRelationship.name)
+                    let index = objects.index(of: insertedObject)
+                    if index == NSNotFound {
+                        objects.add(storedObject)
+                    } else if objects.contains(storedObject) {
+                        objects.removeObject(at: index)
+                    } else {
+                        objects.replaceObject(at: index, with: storedObject)
+                    }
+                } else {
+                    let objects = relatedObject.mutableSetValue(forKey: inverseRelationship.name)
+                    objects.remove(insertedObject)
+                    objects.add(storedObject)
+                }
+            }
+        }
+        
+        self.delete(insertedObject)
+    }
+    
+}
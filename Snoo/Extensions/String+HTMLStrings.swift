@@ -274,12 +274,203 @@ private let characterEntities : [String: Character] = [
     
 ]
 
+/// A trie of the named character entities, so entities can be decoded while scanning the UTF-8 code units, without creating a string for every entity.
+private struct HTMLEntityTrie {
+    
+    private struct Node {
+        var children = [(character: UInt8, node: Int)]()
+        var scalar: UInt32?
+    }
+    
+    static let shared = HTMLEntityTrie(entities: characterEntities)
+    
+    private var nodes = [Node()]
+    
+    /// The length of the longest entity name, scanning for a name stops after this length.
+    private(set) var maximumNameLength = 0
+    
+    private init(entities: [String: Character]) {
+        for (entity, character) in entities {
+            guard let scalar = character.unicodeScalars.first else {
+                continue
+            }
+            // Remove the "&" and ";" from the entity
+            let name = Array(entity.utf8.dropFirst().dropLast())
+            var node = 0
+            for byte in name {
+                if let child = self.nodes[node].children.first(where: { $0.character == byte }) {
+                    node = child.node
+                } else {
+                    self.nodes.append(Node())
+                    self.nodes[node].children.append((byte, self.nodes.count - 1))
+                    node = self.nodes.count - 1
+                }
+            }
+            self.nodes[node].scalar = scalar.value
+            self.maximumNameLength = max(self.maximumNameLength, name.count)
+        }
+    }
+    
+    /// Looks up the entity name starting at the given index, up to a semicolon. Returns the decoded scalar value and the index after the semicolon.
+    func lookup(_ bytes: UnsafeBufferPointer<UInt8>, at start: Int) -> (scalar: UInt32, end: Int)? {
+        var node = 0
+        var index = start
+        while index < bytes.count && index - start <= self.maximumNameLength {
+            let byte = bytes[index]
+            if byte == HTMLEntityDecoder.semicolon {
+                guard let scalar = self.nodes[node].scalar else {
+                    return nil
+                }
+                return (scalar, index + 1)
+            }
+            guard let child = self.nodes[node].children.first(where: { $0.character == byte }) else {
+                return nil
+            }
+            node = child.node
+            index += 1
+        }
+        return nil
+    }
+    
+}
+
+/// Decodes HTML character entity references in a single pass over the UTF-8 code units of a string.
+internal enum HTMLEntityDecoder {
+    
+    static let ampersand: UInt8 = 0x26
+    static let semicolon: UInt8 = 0x3B
+    static let numberSign: UInt8 = 0x23
+    
+    /// Numeric entities never need more digits than this ("&#x10FFFF;" or "&#1114111;").
+    private static let maximumDigitCount = 7
+    
+    /// Returns the decoded UTF-8 code units, or nil if the bytes don't contain any entities.
+    static func decode(_ bytes: UnsafeBufferPointer<UInt8>) -> [UInt8]? {
+        var output = [UInt8]()
+        var containsEntities = false
+        var segmentStart = 0
+        var index = 0
+        
+        while index < bytes.count {
+            guard bytes[index] == HTMLEntityDecoder.ampersand, var entity = self.decodeEntity(bytes, nameStart: index + 1) else {
+                index += 1
+                continue
+            }
+            
+            // Reddit sometimes escapes twice, so an escaped ampersand can be the start of another entity. For example "&amp;lt;" becomes "<".
+            if entity.scalar == UInt32(HTMLEntityDecoder.ampersand), let doubleEscapedEntity = self.decodeEntity(bytes, nameStart: entity.end) {
+                entity = doubleEscapedEntity
+            }
+            
+            if containsEntities == false {
+                containsEntities = true
+                output.reserveCapacity(bytes.count)
+            }
+            output.append(contentsOf: bytes[segmentStart..<index])
+            self.appendUTF8(entity.scalar, to: &output)
+            index = entity.end
+            segmentStart = entity.end
+        }
+        
+        guard containsEntities else {
+            return nil
+        }
+        output.append(contentsOf: bytes[segmentStart..<bytes.count])
+        return output
+    }
+    
+    /// Decodes the entity of which the name (after the ampersand) starts at the given index.
+    private static func decodeEntity(_ bytes: UnsafeBufferPointer<UInt8>, nameStart: Int) -> (scalar: UInt32, end: Int)? {
+        guard nameStart < bytes.count else {
+            return nil
+        }
+        guard bytes[nameStart] == HTMLEntityDecoder.numberSign else {
+            return HTMLEntityTrie.shared.lookup(bytes, at: nameStart)
+        }
+        
+        // Numeric entity, like "&#64;" or "&#x20ac;"
+        var index = nameStart + 1
+        var radix: UInt32 = 10
+        if index < bytes.count && (bytes[index] == 0x78 || bytes[index] == 0x58) {
+            radix = 16
+            index += 1
+        }
+        let digitsStart = index
+        var value: UInt32 = 0
+        while index < bytes.count && index - digitsStart <= HTMLEntityDecoder.maximumDigitCount {
+            let byte = bytes[index]
+            if byte == HTMLEntityDecoder.semicolon {
+                guard index > digitsStart, UnicodeScalar(value) != nil else {
+                    return nil
+                }
+                return (value, index + 1)
+            }
+            guard let digit = self.digitValue(byte), digit < radix else {
+                return nil
+            }
+            value = value * radix + digit
+            index += 1
+        }
+        return nil
+    }
+    
+    private static func digitValue(_ byte: UInt8) -> UInt32? {
+        switch byte {
+        case 0x30...0x39:
+            return UInt32(byte - 0x30)
+        case 0x41...0x46:
+            return UInt32(byte - 0x41 + 10)
+        case 0x61...0x66:
+            return UInt32(byte - 0x61 + 10)
+        default:
+            return nil
+        }
+    }
+    
+    private static func appendUTF8(_ scalar: UInt32, to output: inout [UInt8]) {
+        switch scalar {
+        case 0..<0x80:
+            output.append(UInt8(scalar))
+        case 0x80..<0x800:
+            output.append(UInt8(0xC0 | (scalar >> 6)))
+            output.append(UInt8(0x80 | (scalar & 0x3F)))
+        case 0x800..<0x10000:
+            output.append(UInt8(0xE0 | (scalar >> 12)))
+            output.append(UInt8(0x80 | ((scalar >> 6) & 0x3F)))
+            output.append(UInt8(0x80 | (scalar & 0x3F)))
+        default:
+            output.append(UInt8(0xF0 | (scalar >> 18)))
+            output.append(UInt8(0x80 | ((scalar >> 12) & 0x3F)))
+            output.append(UInt8(0x80 | ((scalar >> 6) & 0x3F)))
+            output.append(UInt8(0x80 | (scalar & 0x3F)))
+        }
+    }
+    
+}
+
 extension String {
     
     /// Returns a new string made by replacing in the `String`
     /// all HTML character entity references with the corresponding
-    /// character.
+    /// character. Strings without entities are returned as is.
     func stringByUnescapeHTMLEntities() -> String {
+        guard self.utf8.contains(HTMLEntityDecoder.ampersand) else {
+            return self
+        }
+        
+        let decodedBytes = self.utf8.withContiguousStorageIfAvailable { (bytes) -> [UInt8]? in
+            return HTMLEntityDecoder.decode(bytes)
+        } ?? Array(self.utf8).withUnsafeBufferPointer { (bytes) -> [UInt8]? in
+            return HTMLEntityDecoder.decode(bytes)
+        }
+        guard let bytes = decodedBytes else {
+            return self
+        }
+        return String(decoding: bytes, as: UTF8.self)
+    }
+    
+    /// The previous implementation of stringByUnescapeHTMLEntities(), which unescapes the complete string twice. Only used as a reference in tests and benchmarks.
+    internal func referenceStringByUnescapeHTMLEntities() -> String {
         //The second unescaping is specificly for reddit. Reddit seems to escape twice sometimes, causing the & character to be escaped when it was used in the first escaping.
         return self.unescapeHTMLEntities().unescapeHTMLEntities()
     }
@@ -0,0 +1,101 @@
+//
+//  OperationGraph.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import Foundation
+
+/// The operations of a single `executeOperations` call and their dependencies.
+///
+/// A graph doesn't occupy a thread while it runs. Its completion operation depends on every operation in the graph, so it only becomes ready, and calls the handler, once the last operation has finished. The parsing and saving run with the quality of service of the most urgent request, and cancelling the graph cancels all of its own operations.
+public final class OperationGraph {
+    
+    /// All operations in the graph, including the operations that are shared with other graphs.
+    public let operations: [Operation]
+    
+    /// Operations the graph waits for, but doesn't cancel, because other graphs wait for them as well. For example a refresh of the access token.
+    fileprivate let sharedOperations: [Operation]
+    
+    /// The quality of service of the most urgent request in the graph, or of the most urgent operation if the graph has no requests.
+    public let qualityOfService: QualityOfService
+    
+    /// Calls the handler once all operations have finished.
+    let completionOperation: BlockOperation
+    
+    init(operations: [Operation], sharedOperations: [Operation] = [], handler: ((Error?) -> Void)?) {
+        self.operations = operations
+        self.sharedOperations = sharedOperations
+        self.qualityOfService = OperationGraph.qualityOfService(of: operations)
+        
+        self.completionOperation = BlockOperation()
+        self.completionOperation.qualityOfService = self.qualityOfService
+        for operation in operations {
+            self.completionOperation.addDependency(operation)
+        }
+        self.completionOperation.addExecutionBlock {
+            handler?(OperationGraph.firstError(of: operations))
+        }
+    }
+    
+    /// Whether all operations have finished and the handler has been called.
+    public var isFinished: Bool {
+        return self.completionOperation.isFinished
+    }
+    
+    /// The first error of the operations in the graph.
+    public var error: Error? {
+        return OperationGraph.firstError(of: self.operations)
+    }
+    
+    fileprivate class func firstError(of operations: [Operation]) -> Error? {
+        for operation in operations {
+            if let error = (operation as? DataOperation)?.error ?? (operation as? DataRequest)?.error {
+                return error
+            }
+        }
+        return nil
+    }
+    
+    /// Cancels the operations of the graph that have not finished yet. The handler is still called, once the cancelled operations have finished.
+    public func cancel() {
+        for operation in self.operations where !operation.isFinished && !self.sharedOperations.contains(operation) {
+            operation.cancel()
+        }
+    }
+    
+    /// Runs the operations that only prepare or process the content of the graph, like parsing and saving, at the quality of service of the graph. The requests keep the quality of service of their own priority.
+    func propagateQualityOfService() {
+        for operation in self.operations where !(operation is DataRequest) && !self.sharedOperations.contains(operation) {
+            operation.qualityOfService = self.qualityOfService
+        }
+    }
+    
+    // MARK: - Quality of service
+    
+    /// Returns the most urgent quality of service of the requests, which follows the priority of the content they load. Operations without a priority only count if there are no requests.
+    class func qualityOfService(of operations: [Operation]) -> QualityOfService {
+        let requests = operations.filter { $0 is DataRequest }
+        return (requests.isEmpty ? operations : requests).map({ $0.qualityOfService }).max(by: { OperationGraph.urgency(of: $0) < OperationGraph.urgency(of: $1) }) ?? .default
+    }
+    
+    fileprivate class func urgency(of qualityOfService: QualityOfService) -> Int {
+        switch qualityOfService {
+        case .background:
+            return 0
+        case .utility:
+            return 1
+        case .default:
+            return 2
+        case .userInitiated:
+            return 3
+        case .userInteractive:
+            return 4
+        @unknown default:
+            return 2
+        }
+    }
+    
+}
@@ -0,0 +1,171 @@
+//
+//  StoreCacheController.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import Foundation
+import CoreData
+
+/// Keeps the Snoo database within a size budget. Collections that have not been shown for the longest time are evicted first, together with the content only they refer to.
+///
+/// Evicting rows frees pages inside the database file, but doesn't shrink the file. The file is compacted the next time the store is added, after enough content has been evicted or when the last compaction is too long ago. Until then the size of the file still counts the evicted content, so no more collections are evicted while a compaction is pending.
+///
+/// The dates collections were shown are kept in memory, and written to the store when the app goes to the background and before every eviction.
+public final class StoreCacheController {
+    
+    public struct Statistics: CustomStringConvertible {
+        /// The size of the database file, including the write-ahead log, in bytes.
+        public var storeSize: Int64 = 0
+        /// The number of collections that have been evicted since launch.
+        public var evictedCollectionCount = 0
+        /// The number of objects that have been evicted since launch, including the collections.
+        public var evictedObjectCount = 0
+        public var lastEvictionDate: Date?
+        public var lastCompactionDate: Date?
+        
+        public var description: String {
+            let formatter = ByteCountFormatter()
+            return "Store: \(formatter.string(fromByteCount: self.storeSize)), evicted \(self.evictedCollectionCount) collections with \(self.evictedObjectCount) objects since launch, last compacted \(self.lastCompactionDate?.description ?? "never")"
+        }
+    }
+    
+    fileprivate static let lastCompactionDateKey = "SnooStoreLastCompactionDate"
+    fileprivate static let needsCompactionKey = "SnooStoreNeedsCompaction"
+    
+    /// The number of bytes the database may use before collections are evicted.
+    public var byteBudget: Int64 = 150 * 1024 * 1024
+    
+    /// Eviction continues until the database is below this fraction of the budget, so it doesn't have to run again right after the next page is parsed.
+    public var evictionTarget = 0.8
+    
+    /// The store is compacted at least this often, even if little content has been evicted.
+    public var compactionInterval: TimeInterval = 7 * 24 * 60 * 60
+    
+    /// The URL of the store that is currently in use.
+    internal var storeURL: URL?
+    
+    fileprivate var currentStatistics = Statistics()
+    
+    /// The collections that have been shown since the access dates were last written to the store.
+    fileprivate var accessDates = [NSManagedObjectID: Date]()
+    
+    fileprivate let lock = NSLock()
+    
+    init() {
+        self.currentStatistics.lastCompactionDate = UserDefaults.standard.object(forKey: StoreCacheController.lastCompactionDateKey) as? Date
+    }
+    
+    public var statistics: Statistics {
+        self.lock.lock()
+        var statistics = self.currentStatistics
+        self.lock.unlock()
+        statistics.storeSize = self.storeSize
+        return statistics
+    }
+    
+    /// The size of the store on disk in bytes, including the write-ahead log and shared memory files.
+    public var storeSize: Int64 {
+        guard let storeURL = self.storeURL else {
+            return 0
+        }
+        return ["", "-wal", "-shm"].reduce(Int64(0)) { (size, suffix) -> Int64 in
+            let attributes = try? FileManager.default.attributesOfItem(atPath: storeURL.path + suffix)
+            return size + ((attributes?[FileAttributeKey.size] as? NSNumber)?.int64Value ?? 0)
+        }
+    }
+    
+    // MARK: - Access tracking
+    
+    /// Marks the collection as recently used. The date is kept in memory and written to the store later by `accessDatesOperation()` or the next eviction, so showing a collection doesn't need a save.
+    public func recordAccess(to collectionID: NSManagedObjectID) {
+        guard !collectionID.isTemporaryID else {
+            return
+        }
+        self.lock.lock()
+        self.accessDates[collectionID] = Date()
+        self.lock.unlock()
+    }
+    
+    /// Writes the recorded access dates to the collections in the context. Should be called on the queue of the context.
+    internal func writeAccessDates(in context: NSManagedObjectContext) {
+        self.lock.lock()
+        let accessDates = self.accessDates
+        self.accessDates.removeAll()
+        self.lock.unlock()
+        
+        for (collectionID, accessDate) in accessDates {
+            guard let collection = (try? context.existingObject(with: collectionID)) as? ObjectCollection else {
+                continue
+            }
+            if collection.lastAccessDate == nil || collection.lastAccessDate! < accessDate {
+                collection.lastAccessDate = accessDate
+            }
+        }
+    }
+    
+    /// Returns an operation that writes the access dates recorded since they were last written to the store. Run it when the app goes to the background, so an eviction at the next launch knows which collections were shown.
+    public func accessDatesOperation() -> Operation {
+        return BlockOperation {
+            let context = DataController.shared.createBackgroundContext(name: "access-dates")
+            context.performAndWait {
+                self.writeAccessDates(in: context)
+            }
+            do {
+                try DataController.shared.saveContext(context)
+            } catch {
+                NSLog("Failed to write the access dates of collections: %@", (error as NSError))
+            }
+        }
+    }
+    
+    // MARK: - Eviction
+    
+    /// Returns an operation that evicts the least recently used collections if the store is over its budget.
+    public func evictionOperation() -> Operation {
+        return StoreEvictionOperation(cacheController: self)
+    }
+    
+    internal func didEvict(collectionCount: Int, objectCount: Int) {
+        self.lock.lock()
+        self.currentStatistics.evictedCollectionCount += collectionCount
+        self.currentStatistics.evictedObjectCount += objectCount
+        self.currentStatistics.lastEvictionDate = Date()
+        self.lock.unlock()
+        if collectionCount > 0 {
+            UserDefaults.standard.set(true, forKey: StoreCacheController.needsCompactionKey)
+        }
+    }
+    
+    // MARK: - Compaction
+    
+    /// Whether content has been evicted since the store was last compacted. The file only shrinks when it is compacted, so it can't tell how much content is left until then.
+    internal var isCompactionPending: Bool {
+        return UserDefaults.standard.bool(forKey: StoreCacheController.needsCompactionKey)
+    }
+    
+    /// Whether the store should be compacted when it is added. This is the case after eviction, or when the store hasn't been compacted for the compaction interval.
+    internal var needsCompaction: Bool {
+        if UserDefaults.standard.bool(forKey: StoreCacheController.needsCompactionKey) {
+            return true
+        }
+        guard let lastCompactionDate = UserDefaults.standard.object(forKey: StoreCacheController.lastCompactionDateKey) as? Date else {
+            // Start counting from the first time the store is added
+            UserDefaults.standard.set(Date(), forKey: StoreCacheController.lastCompactionDateKey)
+            return false
+        }
+        return Date().timeIntervalSince(lastCompactionDate) > self.compactionInterval
+    }
+    
+    internal func didCompact() {
+        let date = Date()
+        UserDefaults.standard.set(date, forKey: StoreCacheController.lastCompactionDateKey)
+        UserDefaults.standard.set(false, forKey: StoreCacheController.needsCompactionKey)
+        self.lock.lock()
+        self.currentStatistics.lastCompactionDate = date
+        self.lock.unlock()
+    }
+    
+}
@@ -11,10 +11,25 @@ import CoreData
 
 private var _sharedUserActivityControllerInstance = UserActivityController()
 
+extension Notification.Name {
+    
+    /// Posted on the main thread when reddit rejected a vote, save or hide. The object is the content, its state has been changed back. The `JournalAction.Kind` of the action is in the user info under `UserActivityController.FailedActionKindKey`.
+    public static let UserActivityActionDidFail = Notification.Name(rawValue: "UserActivityActionDidFailNotification")
+    
+}
+
+/// Sends the votes, saves, hides and visits of the user to reddit.
+///
+/// Changes are applied to the content right away and written to an `ActionJournal`. The journal is flushed in batches: on a timer, when enough actions are waiting, when reddit becomes reachable, when the app goes to the background and before the user changes. Actions that couldn't be sent stay in the journal and are sent again, also after a relaunch. When reddit rejects an action, the content is changed back.
 public final class UserActivityController: NSObject {
     
-    static let VisitsFlushInterval: TimeInterval = 60 // 1 minute
-    static let VisitsTriggeredFlushCount = 30 //The number visits that is done to trigger a flush
+    static let FlushInterval: TimeInterval = 30
+    static let TriggeredFlushCount = 30 //The number of actions that is recorded to trigger a flush
+    static let MaximumBatchSize = 25 //The number of hides or visits that is sent in one request
+    static let InactiveUserActionLifetime: TimeInterval = 7 * 24 * 60 * 60 //Actions of an account that isn't active are dropped after a week
+    
+    /// The key of the kind of the rejected action in the user info of `UserActivityActionDidFail`.
+    public static let FailedActionKindKey = "UserActivityFailedActionKind"
     
     public class var shared: UserActivityController {
         return _sharedUserActivityControllerInstance
@@ -22,22 +37,37 @@ public final class UserActivityController: NSObject {
     
     public var authenticationController: AuthenticationController? {
         didSet {
-            //Flush visits in case there are any
-            self.flushVisits()
+            //Flush the actions of a previous launch in case there are any
+            self.flushActions()
         }
     }
     
-    fileprivate var visitedPostNames = Set<String>()
-    fileprivate var flushingVisits = false
+    internal let journal: ActionJournal
+    
+    fileprivate var flushingActions = false
     fileprivate var flushTimer: Timer?
     
-    override init() {
+    fileprivate static var journalURL: URL? {
+        let urls = FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask)
+        guard let appSupportURL = urls.last, let bundleIdentifier = Bundle.main.bundleIdentifier else {
+            return nil
+        }
+        return appSupportURL.appendingPathComponent(bundleIdentifier).appendingPathComponent("ActionJournal.json")
+    }
+    
+    override convenience init() {
+        self.init(journal: ActionJournal(fileURL: UserActivityController.journalURL))
+    }
+    
+    init(journal: ActionJournal) {
+        self.journal = journal
         super.init()
         
         NotificationCenter.default.addObserver(self, selector: #selector(UserActivityController.userSessionWillChange(_:)), name: AuthenticationController.UserSessionWillChangeNotificationName, object: nil)
         NotificationCenter.default.addObserver(self, selector: #selector(UserActivityController.applicationDidEnterBackground(_:)), name: UIApplication.didEnterBackgroundNotification, object: nil)
-        self.flushTimer = Timer.scheduledTimer(timeInterval: UserActivityController.VisitsFlushInterval, target: self, selector: #selector(UserActivityController.flushTimerFired(_:)), userInfo: nil, repeats: true)
-        self.flushTimer!.tolerance = 30 //30 seconds of tolerance
+        NotificationCenter.default.addObserver(self, selector: #selector(UserActivityController.reachabilityChanged(_:)), name: ReachabilityChangedNotification, object: nil)
+        self.flushTimer = Timer.scheduledTimer(timeInterval: UserActivityController.FlushInterval, target: self, selector: #selector(UserActivityController.flushTimerFired(_:)), userInfo: nil, repeats: true)
+        self.flushTimer!.tolerance = 10 //10 seconds of tolerance
     }
     
     deinit {
@@ -46,70 +76,262 @@ public final class UserActivityController: NSObject {
         NotificationCenter.default.removeObserver(self)
     }
     
-    fileprivate func flushVisits() {
+    // MARK: - Actions
+    
+    /// Changes the vote of the user on the post or comment, including its score, and sends it to reddit later.
+    public func vote(_ content: Content, direction: VoteStatus) {
+        let previousDirection = VoteStatus(rawValue: content.voteStatus?.intValue ?? 0) ?? VoteStatus.neutral
+        content.updateScore(direction, oldVoteStatus: previousDirection)
+        content.voteStatus = NSNumber(value: direction.rawValue)
+        self.record(.vote, content: content, value: direction.rawValue, originalValue: previousDirection.rawValue)
+    }
+    
+    /// Saves or unsaves the post or comment, and sends it to reddit later.
+    public func save(_ content: Content, saved: Bool) {
+        let wasSaved = content.isSaved.boolValue
+        content.isSaved = NSNumber(value: saved)
+        NotificationCenter.default.post(name: .ContentDidChangeSavedState, object: content)
+        self.record(.save, content: content, value: saved ? 1 : 0, originalValue: wasSaved ? 1 : 0)
+    }
+    
+    /// Hides or unhides the post, and sends it to reddit later.
+    public func hide(_ post: Post, hidden: Bool) {
+        let wasHidden = post.isHidden.boolValue
+        post.isHidden = NSNumber(value: hidden)
+        NotificationCenter.default.post(name: .PostDidChangeHiddenState, object: post)
+        self.record(.hide, content: post, value: hidden ? 1 : 0, originalValue: wasHidden ? 1 : 0)
+    }
+    
+    internal func addVisit(_ post: Post) {
+        //Only gold members can store their visits, there is no need to journal them for other users
+        guard let context = post.managedObjectContext, self.authenticationController?.activeUser(context)?.isGold.boolValue == true else {
+            return
+        }
+        self.record(.visit, content: post, value: 1, originalValue: 0)
+    }
+    
+    fileprivate func record(_ kind: JournalAction.Kind, content: Content, value: Int, originalValue: Int) {
+        guard let objectName = content.objectName, let userIdentifier = self.authenticationController?.activeUserIdentifier else {
+            return
+        }
+        self.journal.record(kind, objectName: objectName, userIdentifier: userIdentifier, value: value, originalValue: originalValue)
+        
+        if self.journal.pendingActions(for: userIdentifier).count >= UserActivityController.TriggeredFlushCount {
+            DispatchQueue.main.async {
+                self.flushActions()
+            }
+        }
+    }
+    
+    // MARK: - Parsing
+    
+    /**
+     Changes parsed content to the state the user chose, for the actions that haven't been sent yet. Until reddit received an action, it still returns the state from before the action, which would undo the vote, save or hide in the app.
+     
+     Should be called while parsing the content, on the queue of its context.
+     */
+    internal func applyPendingActions(_ kinds: [JournalAction.Kind], to content: Content) {
+        guard let objectName = content.objectName, let userIdentifier = self.authenticationController?.activeUserIdentifier else {
+            return
+        }
+        for kind in kinds {
+            guard let action = self.journal.pendingAction(kind, objectName: objectName, userIdentifier: userIdentifier) else {
+                continue
+            }
+            switch action.kind {
+            case .vote:
+                let direction = VoteStatus(rawValue: action.value) ?? VoteStatus.neutral
+                //The parsed score still counts the vote reddit knows about
+                content.updateScore(direction, oldVoteStatus: VoteStatus(rawValue: action.originalValue) ?? VoteStatus.neutral)
+                content.voteStatus = NSNumber(value: direction.rawValue)
+            case .save:
+                content.isSaved = NSNumber(value: action.value == 1)
+            case .hide:
+                (content as? Post)?.isHidden = NSNumber(value: action.value == 1)
+            case .visit:
+                break
+            }
+        }
+    }
+    
+    // MARK: - Flushing
+    
+    fileprivate func flushActions() {
         assert(Thread.isMainThread)
         
-        guard self.authenticationController?.isAuthenticated == true else {
+        guard let authenticationController = self.authenticationController, authenticationController.isAuthenticated, let userIdentifier = authenticationController.activeUserIdentifier else {
             return
         }
-        guard self.authenticationController?.activeUser(DataController.shared.viewContext)?.isGold == true else {
+        guard self.flushingActions == false else {
             return
         }
-        guard self.visitedPostNames.count > 0 else {
+        self.expireInactiveUserActions(activeUserIdentifier: userIdentifier, authenticationController: authenticationController)
+        var actions = self.journal.pendingActions(for: userIdentifier)
+        let visits = actions.filter { $0.kind == .visit }
+        if visits.count > 0 && authenticationController.activeUser(DataController.shared.viewContext)?.isGold.boolValue != true {
+            //Only gold members can store their visits
+            self.journal.remove(visits)
+            actions = actions.filter { $0.kind != .visit }
+        }
+        guard actions.count > 0 else {
             return
         }
-        guard self.flushingVisits == false else {
+        self.flushingActions = true
+        
+        let batches = self.requests(for: actions, authenticationController: authenticationController)
+        let dispatchGroup = DispatchGroup()
+        for batch in batches {
+            //Every request gets its own authentication, the refresh of the session is shared between them
+            dispatchGroup.enter()
+            DataController.shared.executeOperations([batch.request], handler: { (_) in
+                dispatchGroup.leave()
+            })
+        }
+        dispatchGroup.notify(queue: DispatchQueue.main) {
+            self.flushingActions = false
+            for batch in batches {
+                self.request(batch.request, didFinishWith: batch.actions)
+            }
+            //Store the state of the content that changed since the last flush
+            DataController.shared.executeAndSaveOperations([], context: DataController.shared.viewContext, handler: nil)
+        }
+    }
+    
+    /**
+     Drops the actions of accounts that are not active. Requests can only be sent with the session of the active account, so the actions of another account are sent once it is active again. They are dropped when the account has been removed, or when it hasn't been active for a week.
+     */
+    fileprivate func expireInactiveUserActions(activeUserIdentifier: String, authenticationController: AuthenticationController) {
+        guard self.journal.pendingActions.contains(where: { $0.userIdentifier != activeUserIdentifier }) else {
             return
         }
-        self.flushingVisits = true
+        let signedInUserIdentifiers = Set(authenticationController.fetchAllAuthenticationSessions().compactMap { $0.userIdentifier })
+        let expirationDate = Date(timeIntervalSinceNow: -UserActivityController.InactiveUserActionLifetime)
+        let droppedActions = self.journal.removeActions(where: { (action) -> Bool in
+            guard action.userIdentifier != activeUserIdentifier else {
+                return false
+            }
+            return !signedInUserIdentifiers.contains(action.userIdentifier) || (action.recordDate ?? Date.distantPast) < expirationDate
+        })
+        if droppedActions.count > 0 {
+            NSLog("Dropped %d actions of inactive accounts", droppedActions.count)
+        }
+    }
+    
+    /// Returns the requests that send the actions. Hides and visits of multiple posts are sent in a single request.
+    fileprivate func requests(for actions: [JournalAction], authenticationController: AuthenticationController) -> [(request: RedditRequest, actions: [JournalAction])] {
+        var batches = [(request: RedditRequest, actions: [JournalAction])]()
+        for action in actions {
+            switch action.kind {
+            case .vote:
+                batches.append((Content.voteRequest(VoteStatus(rawValue: action.value) ?? VoteStatus.neutral, objectName: action.objectName, authenticationController: authenticationController), [action]))
+            case .save:
+                batches.append((Content.saveRequest(action.value == 1, objectName: action.objectName, authenticationController: authenticationController), [action]))
+            case .hide, .visit:
+                break
+            }
+        }
         
-        let request = RedditRequest(authenticationController: self.authenticationController!)
-        request.urlSession = self.authenticationController!.userURLSession
-        let url = Foundation.URL(string: "/api/store_visits", relativeTo: request.baseURL as URL)!
+        for hidden in [true, false] {
+            let hides = actions.filter { $0.kind == .hide && ($0.value == 1) == hidden }
+            for batch in hides.chunked(UserActivityController.MaximumBatchSize) {
+                batches.append((Post.markHiddenRequest(hidden, objectNames: batch.map { $0.objectName }, authenticationController: authenticationController), batch))
+            }
+        }
         
-        let visitedLinks = Array(self.visitedPostNames)
+        let visits = actions.filter { $0.kind == .visit }
+        for batch in visits.chunked(UserActivityController.MaximumBatchSize) {
+            batches.append((self.storeVisitsRequest(batch.map { $0.objectName }, authenticationController: authenticationController), batch))
+        }
+        return batches
+    }
+    
+    fileprivate func storeVisitsRequest(_ objectNames: [String], authenticationController: AuthenticationController) -> RedditRequest {
+        let request = RedditRequest(authenticationController: authenticationController)
+        request.urlSession = authenticationController.userURLSession
+        let url = Foundation.URL(string: "/api/store_visits", relativeTo: request.baseURL as URL)!
         
         var urlRequest = URLRequest(url: url)
         urlRequest.httpMethod = "POST"
-        urlRequest.httpBody = DataRequest.formPOSTDataWithParameters(["links": visitedLinks.joined(separator: ",")])
+        urlRequest.httpBody = DataRequest.formPOSTDataWithParameters(["links": objectNames.joined(separator: ",")])
         request.urlRequest = urlRequest
-        
-        DataController.shared.executeAndSaveOperations([request]) { (error) in
-            self.flushingVisits = false
-            if let error = error as NSError? {
-                if error.code == 403 {
-                    //The user is no longer a gold member, however still clear the qeue!
-                    self.visitedPostNames.removeAll()
-                }
-            } else {
-                //Remove the visits
-                for link in visitedLinks {
-                    self.visitedPostNames.remove(link)
-                }
-            }
-        }
+        return request
     }
     
-    internal func addVisit(_ post: Post) {
-        guard let objectName = post.objectName else {
+    fileprivate func request(_ request: RedditRequest, didFinishWith actions: [JournalAction]) {
+        guard request.isCancelled == false, let error = request.error as NSError? else {
+            if request.isCancelled {
+                self.journal.retryLater(actions)
+            } else {
+                self.journal.complete(actions)
+            }
             return
         }
-        self.visitedPostNames.insert(objectName)
         
-        if self.visitedPostNames.count >= UserActivityController.VisitsTriggeredFlushCount {
-            self.flushVisits()
+        if error.domain == NSURLErrorDomain || (error.domain == SnooErrorDomain && (error.code >= 500 || error.code == 429 || error.code == 401)) {
+            //Offline, or reddit is having trouble, try again with the next flush
+            self.revertActions(self.journal.retryLater(actions))
+        } else {
+            NSLog("Reddit rejected %d actions: %@", actions.count, error)
+            self.revertActions(self.journal.remove(actions))
         }
     }
     
+    /// Changes the content of the actions back to the state reddit knows about.
+    fileprivate func revertActions(_ actions: [JournalAction]) {
+        let context = DataController.shared.viewContext
+        for action in actions where action.kind != .visit {
+            guard let identifier = action.objectName.components(separatedBy: "_").last, let content = (try? Content.fetchObjectWithIdentifier(identifier, context: context)) as? Content else {
+                continue
+            }
+            switch action.kind {
+            case .vote:
+                let originalDirection = VoteStatus(rawValue: action.originalValue) ?? VoteStatus.neutral
+                content.updateScore(originalDirection, oldVoteStatus: nil)
+                content.voteStatus = NSNumber(value: originalDirection.rawValue)
+            case .save:
+                content.isSaved = NSNumber(value: action.originalValue == 1)
+                NotificationCenter.default.post(name: .ContentDidChangeSavedState, object: content)
+            case .hide:
+                if let post = content as? Post {
+                    post.isHidden = NSNumber(value: action.originalValue == 1)
+                    NotificationCenter.default.post(name: .PostDidChangeHiddenState, object: post)
+                }
+            case .visit:
+                break
+            }
+            NotificationCenter.default.post(name: .UserActivityActionDidFail, object: content, userInfo: [UserActivityController.FailedActionKindKey: action.kind])
+        }
+    }
+    
+    // MARK: - Notifications
+    
     @objc fileprivate func flushTimerFired(_ timer: Timer) {
-        self.flushVisits()
+        self.flushActions()
     }
     
     @objc fileprivate func userSessionWillChange(_ notification: Notification) {
-        self.flushVisits()
+        self.flushActions()
     }
     
     @objc fileprivate func applicationDidEnterBackground(_ notification: Notification) {
-        self.flushVisits()
+        self.flushActions()
+        DataController.shared.executeAndSaveOperations([], context: DataController.shared.viewContext, handler: nil)
     }
+    
+    @objc fileprivate func reachabilityChanged(_ notification: Notification) {
+        guard (notification.object as? Reachability)?.isReachable == true else {
+            return
+        }
+        DispatchQueue.main.async {
+            self.flushActions()
+        }
+    }
+}
+
+extension Array {
+    
+    fileprivate func chunked(_ size: Int) -> [[Element]] {
+        return stride(from: 0, to: self.count, by: size).map { Array(self[$0..<Swift.min($0 + size, self.count)]) }
+    }
+    
 }
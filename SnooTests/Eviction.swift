@@ -0,0 +1,105 @@
+//
+//  Eviction.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import XCTest
+import CoreData
+@testable import Snoo
+
+class Eviction: XCTestCase {
+    
+    func insert<T: NSManagedObject>(_ type: T.Type, entityName: String, context: NSManagedObjectContext) -> T {
+        return T(entity: NSEntityDescription.entity(forEntityName: entityName, in: context)!, insertInto: context)
+    }
+    
+    func insertContent<T: Content>(_ type: T.Type, identifier: String, context: NSManagedObjectContext) -> T {
+        let content = self.insert(type, entityName: type.entityName(), context: context)
+        content.identifier = identifier
+        return content
+    }
+    
+    func testEvictLeastRecentlyUsedCollections() {
+        let context = DataController.shared.createBackgroundContext(name: "eviction-test")
+        var shownCollectionID: NSManagedObjectID!
+        context.performAndWait {
+            let evictedPost = self.insertContent(Post.self, identifier: "eviction-post-1", context: context)
+            let sharedPost = self.insertContent(Post.self, identifier: "eviction-post-2", context: context)
+            let comment = self.insertContent(Comment.self, identifier: "eviction-comment-1", context: context)
+            let reply = self.insertContent(Comment.self, identifier: "eviction-comment-2", context: context)
+            reply.parent = comment
+            
+            let oldCollection = self.insert(PostCollection.self, entityName: PostCollection.entityName(), context: context)
+            oldCollection.objects = NSOrderedSet(array: [evictedPost, sharedPost])
+            oldCollection.lastAccessDate = Date(timeIntervalSinceNow: -3600)
+            let commentCollection = self.insert(ContentCollection.self, entityName: ContentCollection.entityName(), context: context)
+            commentCollection.objects = NSOrderedSet(array: [comment])
+            let shownCollection = self.insert(PostCollection.self, entityName: PostCollection.entityName(), context: context)
+            shownCollection.objects = NSOrderedSet(array: [sharedPost])
+            
+            try! context.save()
+            shownCollectionID = shownCollection.objectID
+        }
+        
+        let collectionController = CollectionController(authentication: TestController.sharedController.authenticationController, context: TestController.sharedController.managedObjectContext)
+        collectionController.collectionID = shownCollectionID
+        
+        // Without a budget everything that isn't shown is evicted
+        let cacheController = StoreCacheController()
+        cacheController.storeURL = DataController.shared.storeCacheController.storeURL
+        cacheController.byteBudget = 0
+        cacheController.didCompact()
+        XCTAssertGreaterThan(cacheController.storeSize, 0)
+        let operation = cacheController.evictionOperation()
+        OperationQueue().addOperations([operation], waitUntilFinished: true)
+        XCTAssertNil((operation as? DataOperation)?.error)
+        XCTAssertGreaterThanOrEqual(cacheController.statistics.evictedCollectionCount, 2)
+        let evictedCollectionCount = cacheController.statistics.evictedCollectionCount
+        
+        context.performAndWait {
+            context.reset()
+            let request = NSFetchRequest<SyncObject>(entityName: Content.entityName())
+            request.predicate = NSPredicate(format: "identifier BEGINSWITH %@", "eviction-")
+            let identifiers = Set(((try? context.fetch(request)) ?? []).compactMap { $0.identifier })
+            // The post that is also in the shown collection stays, the reply goes together with its parent
+            XCTAssertEqual(identifiers, ["eviction-post-2"])
+            XCTAssertNotNil(try? context.existingObject(with: shownCollectionID))
+        }
+        
+        collectionController.collectionID = nil
+        
+        // The file still has the size from before the eviction, nothing more is evicted until it has been compacted
+        XCTAssertTrue(cacheController.isCompactionPending)
+        let secondOperation = cacheController.evictionOperation()
+        OperationQueue().addOperations([secondOperation], waitUntilFinished: true)
+        XCTAssertEqual(cacheController.statistics.evictedCollectionCount, evictedCollectionCount)
+        cacheController.didCompact()
+    }
+    
+    func testAccessDatesAreWritten() {
+        let context = DataController.shared.createBackgroundContext(name: "eviction-test")
+        var collectionID: NSManagedObjectID!
+        context.performAndWait {
+            let collection = self.insert(PostCollection.self, entityName: PostCollection.entityName(), context: context)
+            collection.lastAccessDate = Date(timeIntervalSinceNow: -3600)
+            try! context.save()
+            collectionID = collection.objectID
+        }
+        
+        let cacheController = StoreCacheController()
+        cacheController.recordAccess(to: collectionID)
+        OperationQueue().addOperations([cacheController.accessDatesOperation()], waitUntilFinished: true)
+        
+        context.performAndWait {
+            context.reset()
+            let collection = try! context.existingObject(with: collectionID) as! ObjectCollection
+            XCTAssertGreaterThan(collection.lastAccessDate!, Date(timeIntervalSinceNow: -60))
+            context.delete(collection)
+            try! context.save()
+        }
+    }
+    
+}
@@ -0,0 +1,163 @@
+//
+//  Executing.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import XCTest
+@testable import Snoo
+
+/// Answers every request after a delay, so the batches of requests overlap.
+private final class DelayedURLProtocol: URLProtocol {
+    
+    static let responseDelay: TimeInterval = 0.05
+    
+    override class func canInit(with request: URLRequest) -> Bool {
+        return true
+    }
+    
+    override class func canonicalRequest(for request: URLRequest) -> URLRequest {
+        return request
+    }
+    
+    override func startLoading() {
+        let url = self.request.url!
+        DispatchQueue.global().asyncAfter(deadline: .now() + DelayedURLProtocol.responseDelay) {
+            let response = HTTPURLResponse(url: url, statusCode: 200, httpVersion: "HTTP/1.1", headerFields: ["Content-Type": "application/json"])!
+            self.client?.urlProtocol(self, didReceive: response, cacheStoragePolicy: .notAllowed)
+            self.client?.urlProtocol(self, didLoad: "{}".data(using: .utf8)!)
+            self.client?.urlProtocolDidFinishLoading(self)
+        }
+    }
+    
+    override func stopLoading() {
+        
+    }
+    
+}
+
+/// Samples the number of threads of the process while the batches run.
+private final class ThreadCountSampler {
+    
+    fileprivate(set) var peakThreadCount = 0
+    
+    fileprivate var timer: DispatchSourceTimer?
+    
+    func start() {
+        self.peakThreadCount = ThreadCountSampler.threadCount()
+        let timer = DispatchSource.makeTimerSource(queue: DispatchQueue(label: "nl.madeawkward.snoo.thread-count-sampler"))
+        timer.schedule(deadline: .now(), repeating: 0.005)
+        timer.setEventHandler { [unowned self] in
+            self.peakThreadCount = max(self.peakThreadCount, ThreadCountSampler.threadCount())
+        }
+        self.timer = timer
+        timer.resume()
+    }
+    
+    func stop() {
+        self.timer?.cancel()
+        self.timer = nil
+    }
+    
+    class func threadCount() -> Int {
+        var threads: thread_act_array_t?
+        var count: mach_msg_type_number_t = 0
+        guard task_threads(mach_task_self_, &threads, &count) == KERN_SUCCESS, let threadList = threads else {
+            return 0
+        }
+        vm_deallocate(mach_task_self_, vm_address_t(UInt(bitPattern: threadList)), vm_size_t(Int(count) * MemoryLayout<thread_t>.stride))
+        return Int(count)
+    }
+    
+}
+
+class Executing: XCTestCase {
+    
+    let batchCount = 50
+    
+    let urlSession: URLSession = {
+        let configuration = URLSessionConfiguration.ephemeral
+        configuration.protocolClasses = [DelayedURLProtocol.self]
+        return URLSession(configuration: configuration)
+    }()
+    
+    /// A request and the operation that processes its response, like the operations of a collection.
+    func batch(_ index: Int) -> [Operation] {
+        let request = DataRequest()
+        request.urlSession = self.urlSession
+        request.urlRequest = URLRequest(url: URL(string: "https://reddit.test/batch/\(index)")!)
+        let processing = BlockOperation {
+            _ = request.result
+        }
+        processing.addDependency(request)
+        return [request, processing]
+    }
+    
+    /// Runs the batches and returns the peak number of threads and the time until the last handler was called.
+    func measure(_ execute: (_ operations: [Operation], _ handler: @escaping (Error?) -> Void) -> Void) -> (peakThreadCount: Int, duration: TimeInterval) {
+        let sampler = ThreadCountSampler()
+        let expectation = self.expectation(description: "All handlers are called")
+        expectation.expectedFulfillmentCount = self.batchCount
+        
+        sampler.start()
+        let startDate = Date()
+        for index in 0..<self.batchCount {
+            execute(self.batch(index), { (error) in
+                XCTAssertNil(error)
+                expectation.fulfill()
+            })
+        }
+        self.wait(for: [expectation], timeout: 30)
+        let duration = Date().timeIntervalSince(startDate)
+        sampler.stop()
+        return (sampler.peakThreadCount, duration)
+    }
+    
+    /// Compares the operation graphs against the previous strategy, which blocked a thread on every queue a batch was added to until the batch had finished.
+    func testConcurrentBatchesDontBlockThreads() {
+        let networkingQueue = RequestScheduler().queue
+        let operationQueue = OperationQueue()
+        let executionQueue = DispatchQueue(label: "nl.madeawkward.snoo.blocking-execution", attributes: .concurrent)
+        let blocking = self.measure { (operations, handler) in
+            let group = DispatchGroup()
+            for (queue, queueOperations) in [(networkingQueue, operations.filter { $0 is DataRequest }), (operationQueue, operations.filter { !($0 is DataRequest) })] {
+                group.enter()
+                executionQueue.async {
+                    queue.addOperations(queueOperations, waitUntilFinished: true)
+                    group.leave()
+                }
+            }
+            group.notify(queue: DispatchQueue.global()) {
+                handler(nil)
+            }
+        }
+        
+        // Let the threads of the blocking strategy go away
+        Thread.sleep(forTimeInterval: 1)
+        
+        var graphs = [OperationGraph]()
+        let graph = self.measure { (operations, handler) in
+            graphs.append(DataController.shared.executeOperations(operations, handler: handler))
+        }
+        XCTAssertEqual(graphs.count, self.batchCount)
+        
+        print("Blocking: peak of \(blocking.peakThreadCount) threads, \(Int(blocking.duration * 1000))ms")
+        print("Operation graphs: peak of \(graph.peakThreadCount) threads, \(Int(graph.duration * 1000))ms")
+        XCTAssertLessThanOrEqual(graph.peakThreadCount, blocking.peakThreadCount)
+    }
+    
+    func testCancellingGraphCallsHandler() {
+        let expectation = self.expectation(description: "The handler is called")
+        let operations = self.batch(0)
+        let graph = DataController.shared.executeOperations(operations, handler: { (_) in
+            expectation.fulfill()
+        })
+        graph.cancel()
+        self.wait(for: [expectation], timeout: 5)
+        XCTAssertTrue(operations.allSatisfy { $0.isCancelled })
+        XCTAssertTrue(operations.allSatisfy { $0.isFinished })
+    }
+    
+}
@@ -0,0 +1,103 @@
+//
+//  Filtering.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import XCTest
+import CoreData
+@testable import Snoo
+
+class Filtering: XCTestCase {
+    
+    let titles = [
+        "What is the best way to learn Swift in 2026?",
+        "My cat discovered the Christmas tree",
+        "Spoilers for the season finale [SPOILER]",
+        "TIL about Aho-Corasick",
+        "Café au lait recipe",
+        ""
+    ]
+    
+    func testKeywordMatching() {
+        let keywords = ["swift", "spoiler", "hers", "café", "s"]
+        for keywordCount in 1...keywords.count {
+            let filter = ContentFilter(keywords: Array(keywords.prefix(keywordCount)), subreddits: [])
+            for title in self.titles {
+                let expected = keywords.prefix(keywordCount).contains(where: { title.lowercased().contains($0) })
+                XCTAssertEqual(filter.containsKeyword(title), expected, "Matching differs for '\(title)' with \(keywordCount) keywords")
+            }
+        }
+        
+        // Keywords that are a suffix of another keyword are only found through the failure links
+        let filter = ContentFilter(keywords: ["she", "he", "hers", "his"], subreddits: [])
+        XCTAssertTrue(filter.containsKeyword("USHERS"))
+        XCTAssertTrue(filter.containsKeyword("this"))
+        XCTAssertFalse(filter.containsKeyword("shoe"))
+        XCTAssertFalse(ContentFilter(keywords: [""], subreddits: []).containsKeyword("anything"))
+    }
+    
+    func testSubredditMatching() {
+        let filter = ContentFilter(keywords: [], subreddits: ["Pics", "funny"])
+        XCTAssertTrue(filter.containsSubreddit("pics"))
+        XCTAssertTrue(filter.containsSubreddit("Funny"))
+        XCTAssertFalse(filter.containsSubreddit("picsofcats"))
+        XCTAssertFalse(filter.containsKeyword("pics"))
+    }
+    
+    func testFilteringUpdatedCollectionObjects() {
+        let context = TestController.sharedController.managedObjectContext
+        let collection = SubredditCollection(entity: NSEntityDescription.entity(forEntityName: SubredditCollection.entityName(), in: context)!, insertInto: context)
+        let subreddits = ["pics", "funny", "gifs"].map { (identifier) -> Subreddit in
+            let subreddit = Subreddit(entity: NSEntityDescription.entity(forEntityName: Subreddit.entityName(), in: context)!, insertInto: context)
+            subreddit.identifier = identifier
+            return subreddit
+        }
+        collection.objects = NSOrderedSet(array: subreddits)
+        try! context.obtainPermanentIDs(for: [collection] + subreddits)
+        context.processPendingChanges()
+        
+        let query = SubredditsCollectionQuery()
+        query.hideNSFWSubreddits = true
+        let controller = CollectionController(authentication: TestController.sharedController.authenticationController, context: context)
+        controller.query = query
+        controller.collectionID = collection.objectID
+        let otherController = CollectionController(authentication: TestController.sharedController.authenticationController, context: context)
+        otherController.query = query
+        
+        // Only the controller of the collection filters the updated object again
+        subreddits[1].isNSFW = true
+        context.processPendingChanges()
+        XCTAssertEqual(collection.objects?.array as? [Subreddit], [subreddits[0], subreddits[2]])
+        
+        // The collection is indexed again after its objects changed
+        subreddits[1].isNSFW = false
+        collection.objects = NSOrderedSet(array: subreddits)
+        context.processPendingChanges()
+        subreddits[1].isNSFW = true
+        context.processPendingChanges()
+        XCTAssertEqual(collection.objects?.array as? [Subreddit], [subreddits[0], subreddits[2]])
+        
+        // Without a controller the collection is not filtered anymore
+        controller.collectionID = nil
+        subreddits[0].isNSFW = true
+        context.processPendingChanges()
+        XCTAssertEqual(collection.objects?.count, 2)
+        
+        context.rollback()
+    }
+    
+    func testKeywordMatchingPerformance() {
+        let keywords = (0..<500).map { "keyword\($0)" }
+        let filter = ContentFilter(keywords: keywords, subreddits: [])
+        let titles = Array(repeating: self.titles, count: 200).joined()
+        self.measure {
+            for title in titles {
+                _ = filter.containsKeyword(title)
+            }
+        }
+    }
+    
+}
@@ -0,0 +1,134 @@
+//
+//  Journaling.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import XCTest
+@testable import Snoo
+
+class Journaling: XCTestCase {
+    
+    var fileURL: URL!
+    
+    override func setUp() {
+        super.setUp()
+        self.fileURL = FileManager.default.temporaryDirectory.appendingPathComponent("ActionJournal-\(UUID().uuidString).json")
+    }
+    
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: self.fileURL)
+        super.tearDown()
+    }
+    
+    func testCoalescing() {
+        let journal = ActionJournal(fileURL: nil)
+        
+        // Up, down and up again is a single upvote
+        journal.record(.vote, objectName: "t3_1", userIdentifier: "user", value: VoteStatus.up.rawValue, originalValue: VoteStatus.neutral.rawValue)
+        journal.record(.vote, objectName: "t3_1", userIdentifier: "user", value: VoteStatus.down.rawValue, originalValue: VoteStatus.up.rawValue)
+        journal.record(.vote, objectName: "t3_1", userIdentifier: "user", value: VoteStatus.up.rawValue, originalValue: VoteStatus.down.rawValue)
+        XCTAssertEqual(journal.pendingActions.count, 1)
+        XCTAssertEqual(journal.pendingActions.first?.value, VoteStatus.up.rawValue)
+        
+        // Saving and unsaving again doesn't have to be sent at all
+        journal.record(.save, objectName: "t3_1", userIdentifier: "user", value: 1, originalValue: 0)
+        journal.record(.save, objectName: "t3_1", userIdentifier: "user", value: 0, originalValue: 1)
+        XCTAssertFalse(journal.pendingActions.contains(where: { $0.kind == .save }))
+        
+        // Visiting twice is one visit, the actions of other users are kept apart
+        journal.record(.visit, objectName: "t3_1", userIdentifier: "user", value: 1, originalValue: 0)
+        journal.record(.visit, objectName: "t3_1", userIdentifier: "user", value: 1, originalValue: 0)
+        journal.record(.visit, objectName: "t3_1", userIdentifier: "other", value: 1, originalValue: 0)
+        XCTAssertEqual(journal.pendingActions(for: "user").count, 2)
+        XCTAssertEqual(journal.pendingActions(for: "other").count, 1)
+    }
+    
+    func testChangeWhileSending() {
+        let journal = ActionJournal(fileURL: nil)
+        journal.record(.vote, objectName: "t1_1", userIdentifier: "user", value: VoteStatus.up.rawValue, originalValue: VoteStatus.neutral.rawValue)
+        let sentActions = journal.pendingActions
+        
+        // The user removes the vote while the upvote is being sent, after which the removal has to be sent as well
+        journal.record(.vote, objectName: "t1_1", userIdentifier: "user", value: VoteStatus.neutral.rawValue, originalValue: VoteStatus.up.rawValue)
+        XCTAssertTrue(journal.pendingActions.isEmpty)
+        journal.complete(sentActions)
+        XCTAssertEqual(journal.pendingActions.count, 1)
+        XCTAssertEqual(journal.pendingActions.first?.value, VoteStatus.neutral.rawValue)
+        journal.complete(journal.pendingActions)
+        XCTAssertTrue(journal.pendingActions.isEmpty)
+        
+        journal.record(.vote, objectName: "t1_1", userIdentifier: "user", value: VoteStatus.down.rawValue, originalValue: VoteStatus.neutral.rawValue)
+        let downvote = journal.pendingActions
+        journal.record(.vote, objectName: "t1_1", userIdentifier: "user", value: VoteStatus.up.rawValue, originalValue: VoteStatus.down.rawValue)
+        journal.complete(downvote)
+        XCTAssertEqual(journal.pendingActions.count, 1)
+        XCTAssertEqual(journal.pendingActions.first?.value, VoteStatus.up.rawValue)
+        XCTAssertEqual(journal.pendingActions.first?.originalValue, VoteStatus.down.rawValue)
+    }
+    
+    func testPendingActionsSurviveParsing() {
+        let authenticationController = AuthenticationController(clientID: TestController.sharedController.redditClientId, redirectUri: TestController.sharedController.redditRedirectURI, clientName: TestController.sharedController.redditClientName, loadCurrentSession: false)
+        authenticationController.userSession = AuthenticationSession(userIdentifier: "user", refreshToken: "stub-refresh-token")
+        let controller = UserActivityController(journal: ActionJournal(fileURL: nil))
+        controller.authenticationController = authenticationController
+        
+        let context = DataController.shared.createBackgroundContext(name: "journaling")
+        context.performAndWait {
+            let json: NSDictionary = ["id": "journaling1", "score": 10, "likes": NSNull(), "saved": false, "hidden": false]
+            let post = try! Post.objectWithDictionary(json, cache: nil, context: context) as! Post
+            try! post.parseObject(json, cache: nil)
+            
+            controller.vote(post, direction: .up)
+            controller.save(post, saved: true)
+            controller.hide(post, hidden: true)
+            XCTAssertEqual(post.score?.intValue, 11)
+            
+            // Opening the post fetches it again, reddit doesn't know about the actions yet
+            try! post.parseObject(json, cache: nil)
+            controller.applyPendingActions([.vote, .save], to: post)
+            controller.applyPendingActions([.hide], to: post)
+            XCTAssertEqual(post.voteStatus?.intValue, VoteStatus.up.rawValue)
+            XCTAssertEqual(post.score?.intValue, 11)
+            XCTAssertTrue(post.isSaved.boolValue)
+            XCTAssertTrue(post.isHidden.boolValue)
+            
+            context.reset()
+        }
+    }
+    
+    func testExpiringInactiveUserActions() {
+        let journal = ActionJournal(fileURL: nil)
+        journal.record(.vote, objectName: "t3_1", userIdentifier: "active", value: VoteStatus.up.rawValue, originalValue: VoteStatus.neutral.rawValue)
+        journal.record(.vote, objectName: "t3_1", userIdentifier: "inactive", value: VoteStatus.up.rawValue, originalValue: VoteStatus.neutral.rawValue)
+        journal.record(.save, objectName: "t3_1", userIdentifier: "removed", value: 1, originalValue: 0)
+        
+        let removedActions = journal.removeActions(where: { $0.userIdentifier == "removed" })
+        XCTAssertEqual(removedActions.count, 1)
+        XCTAssertEqual(Set(journal.pendingActions.map { $0.userIdentifier }), ["active", "inactive"])
+        XCTAssertNotNil(journal.pendingAction(.vote, objectName: "t3_1", userIdentifier: "inactive")?.recordDate)
+        XCTAssertNil(journal.pendingAction(.save, objectName: "t3_1", userIdentifier: "active"))
+    }
+    
+    func testRetryAcrossLaunches() {
+        let journal = ActionJournal(fileURL: self.fileURL)
+        journal.maximumAttemptCount = 2
+        journal.record(.hide, objectName: "t3_1", userIdentifier: "user", value: 1, originalValue: 0)
+        journal.record(.hide, objectName: "t3_2", userIdentifier: "user", value: 1, originalValue: 0)
+        XCTAssertTrue(journal.retryLater(journal.pendingActions).isEmpty)
+        journal.waitUntilWritten()
+        
+        // A next launch reads the actions that haven't been sent
+        let relaunchedJournal = ActionJournal(fileURL: self.fileURL)
+        relaunchedJournal.maximumAttemptCount = 2
+        XCTAssertEqual(relaunchedJournal.pendingActions, journal.pendingActions)
+        XCTAssertEqual(relaunchedJournal.pendingActions.first?.attemptCount, 1)
+        
+        // Actions that keep failing are dropped
+        XCTAssertEqual(relaunchedJournal.retryLater(relaunchedJournal.pendingActions).count, 2)
+        XCTAssertTrue(relaunchedJournal.pendingActions.isEmpty)
+    }
+    
+}
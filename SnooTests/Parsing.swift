@@ -8,12 +8,115 @@
 
 import UIKit
 import XCTest
+@testable import Snoo
 
 class Parsing: XCTestCase {
     
+    /// Strings as they appear in listings, with single and double escaped entities.
+    let escapedStrings = [
+        "No entities in this title at all",
+        "Tom &amp; Jerry &lt;3",
+        "&quot;Quoted&quot; &#39;single&#39; &#x27;hex&#x27;",
+        "Double escaped &amp;lt;b&amp;gt; and &amp;amp; and &amp;#39;",
+        "https://i.redd.it/image.jpg?width=640&amp;crop=smart&amp;s=abc123",
+        "Unicode &euro; &hearts; &#128512; &eacute;t&eacute;",
+        "Broken &amp entity, &unknown; and a lonely &",
+        "&lt;&gt;&amp;&quot;"
+    ]
+    
     override func setUp() {
         super.setUp()
         
     }
+    
+    func testHTMLEntityDecoding() {
+        for string in self.escapedStrings {
+            XCTAssertEqual(string.stringByUnescapeHTMLEntities(), string.referenceStringByUnescapeHTMLEntities(), "Decoding differs for '\(string)'")
+        }
+        XCTAssertEqual("Tom &amp;amp; Jerry".stringByUnescapeHTMLEntities(), "Tom & Jerry")
+        XCTAssertEqual("&#128512;".stringByUnescapeHTMLEntities(), "😀")
+        XCTAssertEqual("&#xD800;".stringByUnescapeHTMLEntities(), "&#xD800;")
+        
+        // The previous implementation stopped decoding after an ampersand that was not part of an entity
+        XCTAssertEqual("AT&T &amp; more".stringByUnescapeHTMLEntities(), "AT&T & more")
+    }
+    
+    var subredditsResponse: Data {
+        let url = Bundle(for: Parsing.self).url(forResource: "SubredditsResponse", withExtension: "json")!
+        return try! Data(contentsOf: url)
+    }
+    
+    func testListingDecoding() {
+        let response = self.subredditsResponse
+        let json = try! JSONSerialization.jsonObject(with: response, options: []) as! NSDictionary
+        let data = json["data"] as! NSDictionary
+        let children = data["children"] as! [NSDictionary]
+        
+        let decoder = ListingDecoder(data: response)
+        guard let listing = decoder.decodeListing() else {
+            XCTFail("Could not decode listing")
+            return
+        }
+        XCTAssertEqual(listing.after, data["after"] as? String)
+        XCTAssertEqual(listing.before, data["before"] as? String)
+        XCTAssertEqual(listing.children.count, children.count)
+        for (child, expectedChild) in zip(listing.children, children) {
+            XCTAssertEqual(child.kind, expectedChild["kind"] as? String)
+            XCTAssertEqual(child.name, (expectedChild["data"] as? NSDictionary)?["name"] as? String)
+            XCTAssertEqual(try decoder.dictionary(for: child), expectedChild)
+        }
+        
+        // Responses that are an array, like a thread, are returned as a listing of listings
+        let thread = "[{\"kind\": \"Listing\", \"data\": {\"children\": []}}, {\"kind\": \"Listing\", \"data\": {\"after\": null, \"children\": [{\"kind\": \"t1\", \"data\": {\"body\": \"\\\"{[\", \"name\": \"t1_a\\u0062c\"}}]}}]"
+        let threadDecoder = ListingDecoder(data: thread.data(using: .utf8)!)
+        guard let threadListing = threadDecoder.decodeListing(), let commentsChild = threadListing.children.last else {
+            XCTFail("Could not decode thread")
+            return
+        }
+        XCTAssertEqual(threadListing.children.map { $0.kind }, ["Listing", "Listing"])
+        let commentsListing = threadDecoder.decodeListing(of: commentsChild)
+        XCTAssertNil(commentsListing?.after)
+        XCTAssertEqual(commentsListing?.children.first?.name, "t1_abc")
+        
+        XCTAssertNil(ListingDecoder(data: "{\"kind\": \"t5\", \"data\": {\"name\": \"t5_abc\"}}".data(using: .utf8)!).decodeListing())
+        XCTAssertNil(ListingDecoder(data: "{\"data\": {\"children\": [{\"kind\": ".data(using: .utf8)!).decodeListing())
+    }
+    
+    func testListingDecodingPerformance() {
+        let response = self.subredditsResponse
+        self.measure {
+            let decoder = ListingDecoder(data: response)
+            for child in decoder.decodeListing()?.children ?? [] {
+                autoreleasepool {
+                    _ = try? decoder.dictionary(for: child)
+                }
+            }
+        }
+    }
+    
+    func testListingSerializationPerformance() {
+        let response = self.subredditsResponse
+        self.measure {
+            _ = try? JSONSerialization.jsonObject(with: response, options: [])
+        }
+    }
+    
+    func testHTMLEntityDecodingPerformance() {
+        let strings = Array(repeating: self.escapedStrings, count: 2000).flatMap { $0 }
+        self.measure {
+            for string in strings {
+                _ = string.stringByUnescapeHTMLEntities()
+            }
+        }
+    }
+    
+    func testReferenceHTMLEntityDecodingPerformance() {
+        let strings = Array(repeating: self.escapedStrings, count: 2000).flatMap { $0 }
+        self.measure {
+            for string in strings {
+                _ = string.referenceStringByUnescapeHTMLEntities()
+            }
+        }
+    }
 
 }
@@ -0,0 +1,137 @@
+//
+//  Scheduling.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import XCTest
+@testable import Snoo
+
+/// Stands in for the reddit API. Every request is answered after a short delay, the start time of every request is recorded.
+private final class StubURLProtocol: URLProtocol {
+    
+    static let responseDelay: TimeInterval = 0.02
+    
+    static let lock = NSLock()
+    static var startDates = [URL: Date]()
+    static var requestCounts = [URL: Int]()
+    
+    static func reset() {
+        self.lock.lock()
+        self.startDates.removeAll()
+        self.requestCounts.removeAll()
+        self.lock.unlock()
+    }
+    
+    override class func canInit(with request: URLRequest) -> Bool {
+        return true
+    }
+    
+    override class func canonicalRequest(for request: URLRequest) -> URLRequest {
+        return request
+    }
+    
+    override func startLoading() {
+        let url = self.request.url!
+        StubURLProtocol.lock.lock()
+        StubURLProtocol.startDates[url] = Date()
+        StubURLProtocol.requestCounts[url, default: 0] += 1
+        StubURLProtocol.lock.unlock()
+        
+        DispatchQueue.global().asyncAfter(deadline: .now() + StubURLProtocol.responseDelay) {
+            let response = HTTPURLResponse(url: url, statusCode: 200, httpVersion: "HTTP/1.1", headerFields: ["Content-Type": "application/json"])!
+            self.client?.urlProtocol(self, didReceive: response, cacheStoragePolicy: .notAllowed)
+            self.client?.urlProtocol(self, didLoad: "{\"path\": \"\(url.path)\"}".data(using: .utf8)!)
+            self.client?.urlProtocolDidFinishLoading(self)
+        }
+    }
+    
+    override func stopLoading() {
+        
+    }
+    
+}
+
+class Scheduling: XCTestCase {
+    
+    let urlSession: URLSession = {
+        let configuration = URLSessionConfiguration.ephemeral
+        configuration.protocolClasses = [StubURLProtocol.self]
+        return URLSession(configuration: configuration)
+    }()
+    
+    override func setUp() {
+        super.setUp()
+        StubURLProtocol.reset()
+    }
+    
+    func request(_ path: String, priority: RequestPriority = .userAction) -> DataRequest {
+        let request = DataRequest()
+        request.urlSession = self.urlSession
+        request.urlRequest = URLRequest(url: URL(string: "https://reddit.test\(path)")!)
+        request.priority = priority
+        return request
+    }
+    
+    func testCoalescing() {
+        let scheduler = RequestScheduler()
+        let first = self.request("/r/pics/hot", priority: .prefetch)
+        let second = self.request("/r/pics/hot", priority: .visibleContent)
+        let post = self.request("/r/pics/hot")
+        post.urlRequest?.httpMethod = "POST"
+        
+        scheduler.coalesce([first, second, post])
+        XCTAssertTrue(second.coalescedRequest === first)
+        XCTAssertNil(post.coalescedRequest)
+        // The first request is raised to the priority of the request that waits for it
+        XCTAssertEqual(first.priority, .visibleContent)
+        
+        scheduler.queue.addOperations([first, second, post], waitUntilFinished: true)
+        XCTAssertEqual(StubURLProtocol.requestCounts[URL(string: "https://reddit.test/r/pics/hot")!], 2)
+        XCTAssertEqual(second.result, first.result)
+        XCTAssertNotNil(second.HTTPResponse)
+        
+        // A cancelled request doesn't share its response, the identical request performs itself
+        StubURLProtocol.reset()
+        let cancelled = self.request("/r/funny/hot")
+        let identical = self.request("/r/funny/hot")
+        scheduler.coalesce([cancelled, identical])
+        cancelled.cancel()
+        scheduler.queue.addOperations([cancelled, identical], waitUntilFinished: true)
+        XCTAssertEqual(StubURLProtocol.requestCounts[URL(string: "https://reddit.test/r/funny/hot")!], 1)
+        XCTAssertNotNil(identical.result)
+    }
+    
+    /// Schedules the classes from least to most urgent, which is the worst case for a first-in-first-out queue, and reports the average queueing delay per class.
+    func testQueueingDelayPerClass() {
+        let scheduler = RequestScheduler()
+        let priorities: [RequestPriority] = [.background, .prefetch, .userAction, .visibleContent]
+        var requests = [(priority: RequestPriority, request: DataRequest)]()
+        for priority in priorities {
+            for index in 0..<10 {
+                requests.append((priority, self.request("/\(priority.rawValue)/\(index)", priority: priority)))
+            }
+        }
+        
+        scheduler.queue.isSuspended = true
+        scheduler.coalesce(requests.map { $0.request })
+        scheduler.queue.addOperations(requests.map { $0.request }, waitUntilFinished: false)
+        let scheduleDate = Date()
+        scheduler.queue.isSuspended = false
+        scheduler.queue.waitUntilAllOperationsAreFinished()
+        
+        var averageDelays = [RequestPriority: TimeInterval]()
+        for priority in priorities {
+            let delays = requests.filter({ $0.priority == priority }).compactMap { StubURLProtocol.startDates[$0.request.urlRequest!.url!]?.timeIntervalSince(scheduleDate) }
+            XCTAssertEqual(delays.count, 10)
+            averageDelays[priority] = delays.reduce(0, +) / Double(delays.count)
+            print("Average queueing delay for \(priority): \(Int(averageDelays[priority]! * 1000))ms")
+        }
+        XCTAssertLessThan(averageDelays[.visibleContent]!, averageDelays[.userAction]!)
+        XCTAssertLessThan(averageDelays[.userAction]!, averageDelays[.prefetch]!)
+        XCTAssertLessThan(averageDelays[.prefetch]!, averageDelays[.background]!)
+    }
+    
+}
@@ -79,6 +79,143 @@ class Subreddits: XCTestCase {
         
     }
     
+    func testParseSubredditsResponseBody() {
+        guard let URL = Bundle(for: Subreddits.self).url(forResource: "SubredditsResponse", withExtension: "json") else {
+            XCTAssert(false, "Could not find reponse file")
+            return
+        }
+        let responseData = try! Data(contentsOf: URL)
+        
+        self.measure {
+            let query = SubredditsCollectionQuery()
+            let parsingOperation = CollectionParsingOperation(query: query)
+            parsingOperation.responseBody = responseData
+            let queue = OperationQueue()
+            queue.addOperations([parsingOperation], waitUntilFinished: true)
+            
+            XCTAssert(parsingOperation.error == nil, "Error during parsing \(String(describing: parsingOperation.error))")
+            XCTAssertEqual(parsingOperation.objectCollection?.objects?.count, 71)
+        }
+    }
+    
+    func testParseSubredditsFetchRequestCount() {
+        guard let URL = Bundle(for: Subreddits.self).url(forResource: "SubredditsResponse", withExtension: "json") else {
+            XCTAssert(false, "Could not find reponse file")
+            return
+        }
+        let responseData = try! Data(contentsOf: URL)
+        
+        // Parses the same page twice, like a collection controller would with the identity map
+        let identityMap = SyncObjectIdentityMap()
+        var fetchRequestCounts = [Int]()
+        for _ in 0..<2 {
+            let parsingOperation = CollectionParsingOperation(query: SubredditsCollectionQuery())
+            parsingOperation.responseBody = responseData
+            parsingOperation.identityMap = identityMap
+            let queue = OperationQueue()
+            queue.addOperations([parsingOperation], waitUntilFinished: true)
+            
+            XCTAssert(parsingOperation.error == nil, "Error during parsing \(String(describing: parsingOperation.error))")
+            fetchRequestCounts.append(parsingOperation.fetchRequestCount)
+        }
+        
+        // All subreddits are prefetched with a single fetch request, the second parse doesn't need the store at all
+        XCTAssertEqual(fetchRequestCounts, [1, 0])
+    }
+    
+    func testParseWithSeededIdentityMap() {
+        DataController.shared.parsingConcurrency = .concurrent
+        let responseData = self.subredditsResponseData()
+        
+        // The first parse saves the subreddits, like the first page of a collection controller
+        let firstOperation = CollectionParsingOperation(query: SubredditsCollectionQuery())
+        firstOperation.objectContext = DataController.shared.createParsingContext()
+        firstOperation.responseBody = responseData
+        let firstSave = self.expectation(description: "first save")
+        DataController.shared.executeAndSaveOperations([firstOperation], context: firstOperation.objectContext) { (error) in
+            XCTAssertNil(error)
+            firstSave.fulfill()
+        }
+        self.wait(for: [firstSave], timeout: 60)
+        
+        var savedObjectIDs = [NSString: NSManagedObjectID]()
+        firstOperation.objectContext.performAndWait {
+            savedObjectIDs = firstOperation.identityMap.savedObjectIDs(in: firstOperation.objectContext)
+        }
+        XCTAssertFalse(savedObjectIDs.isEmpty)
+        XCTAssertFalse(savedObjectIDs.values.contains(where: { $0.isTemporaryID }))
+        
+        // A parse on another context gets its own identity map, seeded with the saved objects
+        let secondOperation = CollectionParsingOperation(query: SubredditsCollectionQuery())
+        secondOperation.objectContext = DataController.shared.createParsingContext()
+        secondOperation.responseBody = responseData
+        secondOperation.identityMap = SyncObjectIdentityMap(objectIDs: savedObjectIDs)
+        let queue = OperationQueue()
+        queue.addOperations([secondOperation], waitUntilFinished: true)
+        
+        XCTAssertNil(secondOperation.error)
+        XCTAssertEqual(secondOperation.fetchRequestCount, 0)
+    }
+    
+    func testParseSimultaneousListingsSerially() {
+        DataController.shared.parsingConcurrency = .serial
+        defer {
+            DataController.shared.parsingConcurrency = .concurrent
+        }
+        let responseData = self.subredditsResponseData()
+        self.measure {
+            self.parseSimultaneousListings(responseData, count: 6)
+        }
+    }
+    
+    func testParseSimultaneousListingsConcurrently() {
+        DataController.shared.parsingConcurrency = .concurrent
+        let responseData = self.subredditsResponseData()
+        self.measure {
+            self.parseSimultaneousListings(responseData, count: 6)
+        }
+    }
+    
+    func testParseSimultaneousListingsWithoutDuplicates() {
+        DataController.shared.parsingConcurrency = .concurrent
+        let context: NSManagedObjectContext = DataController.shared.privateContext
+        context.performAndWait {
+            _ = try? context.execute(NSBatchDeleteRequest(fetchRequest: NSFetchRequest<NSFetchRequestResult>(entityName: Subreddit.entityName())))
+            context.reset()
+        }
+        
+        // Every listing inserts the same subreddits at the same time
+        self.parseSimultaneousListings(self.subredditsResponseData(), count: 6)
+        
+        context.performAndWait {
+            let subreddits = (try? context.fetch(NSFetchRequest<Subreddit>(entityName: Subreddit.entityName()))) ?? []
+            let identifiers = subreddits.compactMap { $0.identifier }
+            XCTAssertGreaterThan(identifiers.count, 0)
+            XCTAssertEqual(identifiers.count, Set(identifiers).count, "A subreddit was inserted more than once")
+        }
+    }
+    
+    /// Parses the response as separate listings that all start at the same time, like the app loading several streams at once. Waits until all listings are saved.
+    fileprivate func parseSimultaneousListings(_ responseData: Data, count: Int) {
+        let dispatchGroup = DispatchGroup()
+        for _ in 0..<count {
+            let parsingOperation = CollectionParsingOperation(query: SubredditsCollectionQuery())
+            parsingOperation.objectContext = DataController.shared.createParsingContext()
+            parsingOperation.responseBody = responseData
+            dispatchGroup.enter()
+            DataController.shared.executeAndSaveOperations([parsingOperation], context: parsingOperation.objectContext) { (error) in
+                XCTAssertNil(error, "Error during parsing \(String(describing: error))")
+                dispatchGroup.leave()
+            }
+        }
+        XCTAssertEqual(dispatchGroup.wait(timeout: .now() + 60), .success)
+    }
+    
+    fileprivate func subredditsResponseData() -> Data {
+        let URL = Bundle(for: Subreddits.self).url(forResource: "SubredditsResponse", withExtension: "json")!
+        return try! Data(contentsOf: URL)
+    }
+    
     func addUserAccount() {
         do {
             let session = AuthenticationSession(userIdentifier: self.testController.userIdentifier, refreshToken: self.testController.userRefreshToken)
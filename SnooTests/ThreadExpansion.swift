@@ -0,0 +1,62 @@
+//
+//  ThreadExpansion.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import XCTest
+import CoreData
+@testable import Snoo
+
+class ThreadExpansion: XCTestCase {
+    
+    func testChildrenAreRequestedInChunks() {
+        let context = DataController.shared.createBackgroundContext(name: "thread-expansion-test")
+        var post: Post!
+        var placeholders = [MoreComment]()
+        var collection: ObjectCollection!
+        context.performAndWait {
+            post = Post(entity: NSEntityDescription.entity(forEntityName: Post.entityName(), in: context)!, insertInto: context)
+            post.identifier = "expansion-post"
+            // Two placeholders that share a child, and a "continue this thread" placeholder without children
+            for children in [(0..<150).map { "c\($0)" }, (149..<250).map { "c\($0)" }, []] {
+                let placeholder = MoreComment(entity: NSEntityDescription.entity(forEntityName: MoreComment.entityName(), in: context)!, insertInto: context)
+                placeholder.children = children.joined(separator: ",")
+                placeholders.append(placeholder)
+            }
+            collection = ContentCollection(entity: NSEntityDescription.entity(forEntityName: ContentCollection.entityName(), in: context)!, insertInto: context)
+            try! context.obtainPermanentIDs(for: placeholders + [collection])
+        }
+        
+        let operations = MoreComment.expandOperations(placeholders, post: post, commentsCollectionID: collection.objectID, context: context, priority: .userAction, authenticationController: TestController.sharedController.authenticationController)
+        let requests = operations.compactMap { $0 as? RedditRequest }
+        XCTAssertEqual(requests.count, 3)
+        
+        var requestedChildren = [String]()
+        for request in requests {
+            let body = String(data: request.urlRequest!.httpBody!, encoding: .utf8)!
+            let children = URLComponents(string: "?\(body)")!.queryItems!.first(where: { $0.name == "children" })!.value!.components(separatedBy: ",")
+            XCTAssertLessThanOrEqual(children.count, MoreComment.maximumChildrenPerRequest)
+            requestedChildren.append(contentsOf: children)
+        }
+        // Every child is requested once, in the order of the placeholders
+        XCTAssertEqual(requestedChildren, (0..<250).map { "c\($0)" })
+        
+        // Reddit rejects concurrent morechildren requests, every request waits for the previous one
+        XCTAssertTrue(requests[0].dependencies.isEmpty)
+        for (previousRequest, request) in zip(requests, requests.dropFirst()) {
+            XCTAssertTrue(request.dependencies.contains(previousRequest))
+        }
+        
+        // The comments are applied once, after all chunks have been parsed
+        let applyOperation = operations.last!
+        XCTAssertEqual(applyOperation.dependencies.filter({ $0 is ThingsParsingOperation }).count, 3)
+        
+        context.performAndWait {
+            context.reset()
+        }
+    }
+    
+}
@@ -0,0 +1,38 @@
+//
+//  Thumbnails.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import XCTest
+@testable import Snoo
+
+class Thumbnails: XCTestCase {
+    
+    func rung(_ width: Int) -> ThumbnailLadder.Rung {
+        return ThumbnailLadder.Rung(url: URL(string: "https://i.redd.it/\(width).jpg")!, pixelWidth: width, pixelHeight: width)
+    }
+    
+    func testRungSelection() {
+        let ladder = ThumbnailLadder(rungs: [self.rung(640), self.rung(108), self.rung(320), self.rung(216)])
+        XCTAssertEqual(ladder.rungs.map({ $0.pixelWidth }), [108, 216, 320, 640])
+        
+        // The narrowest thumbnail that is wide enough
+        XCTAssertEqual(ladder.rung(forPixelWidth: 200)?.pixelWidth, 216)
+        XCTAssertEqual(ladder.rung(forPixelWidth: 216)?.pixelWidth, 216)
+        XCTAssertEqual(ladder.rung(forPixelWidth: 0)?.pixelWidth, 108)
+        
+        // The widest thumbnail if none is wide enough
+        XCTAssertEqual(ladder.rung(forPixelWidth: 2000)?.pixelWidth, 640)
+        
+        XCTAssertNil(ThumbnailLadder(rungs: []).rung(forPixelWidth: 100))
+    }
+    
+    func testStorage() {
+        let ladder = ThumbnailLadder(rungs: [self.rung(108), self.rung(320)])
+        XCTAssertEqual(ladder.data.flatMap { ThumbnailLadder(data: $0) }, ladder)
+    }
+    
+}
@@ -0,0 +1,142 @@
+//
+//  TokenRefresh.swift
+//  Snoo
+//
+//  Created by Awkward on 17-10-26.
+//  Copyright © 2026 Awkward. All rights reserved.
+//
+
+import XCTest
+@testable import Snoo
+
+/// Stands in for the reddit token endpoint and the user endpoint. The requests to both are counted, the responses are delayed so refreshes overlap.
+private final class TokenEndpointStub: URLProtocol {
+    
+    static let responseDelay: TimeInterval = 0.1
+    
+    static let lock = NSLock()
+    static var tokenRequestCount = 0
+    static var userRequestCount = 0
+    
+    static func reset() {
+        self.lock.lock()
+        self.tokenRequestCount = 0
+        self.userRequestCount = 0
+        self.lock.unlock()
+    }
+    
+    override class func canInit(with request: URLRequest) -> Bool {
+        return true
+    }
+    
+    override class func canonicalRequest(for request: URLRequest) -> URLRequest {
+        return request
+    }
+    
+    override func startLoading() {
+        let url = self.request.url!
+        var body = "{}"
+        TokenEndpointStub.lock.lock()
+        if url.path == "/api/v1/access_token" {
+            TokenEndpointStub.tokenRequestCount += 1
+            body = "{\"access_token\": \"refreshed-token\", \"token_type\": \"bearer\", \"expires_in\": 3600, \"scope\": \"*\"}"
+        } else if url.path.hasPrefix("/api/v1/me") {
+            TokenEndpointStub.userRequestCount += 1
+            body = "{\"id\": \"o9j59\", \"name\": \"btestaccount\"}"
+        }
+        TokenEndpointStub.lock.unlock()
+        
+        DispatchQueue.global().asyncAfter(deadline: .now() + TokenEndpointStub.responseDelay) {
+            let response = HTTPURLResponse(url: url, statusCode: 200, httpVersion: "HTTP/1.1", headerFields: ["Content-Type": "application/json"])!
+            self.client?.urlProtocol(self, didReceive: response, cacheStoragePolicy: .notAllowed)
+            self.client?.urlProtocol(self, didLoad: body.data(using: .utf8)!)
+            self.client?.urlProtocolDidFinishLoading(self)
+        }
+    }
+    
+    override func stopLoading() {
+        
+    }
+    
+}
+
+class TokenRefresh: XCTestCase {
+    
+    var authenticationController: AuthenticationController!
+    
+    override func setUp() {
+        super.setUp()
+        TokenEndpointStub.reset()
+        self.authenticationController = AuthenticationController(clientID: TestController.sharedController.redditClientId, redirectUri: TestController.sharedController.redditRedirectURI, clientName: TestController.sharedController.redditClientName, loadCurrentSession: false)
+        self.authenticationController.basicURLSessionConfiguration.protocolClasses = [TokenEndpointStub.self]
+    }
+    
+    override func tearDown() {
+        self.authenticationController.userSession = nil
+        // Releasing the controller cancels its scheduled refresh
+        self.authenticationController = nil
+        super.tearDown()
+    }
+    
+    func testConcurrentBatchesShareOneRefresh() {
+        // A session without an expiration date has expired
+        self.authenticationController.userSession = AuthenticationSession(userIdentifier: TestController.sharedController.userIdentifier, refreshToken: "stub-refresh-token")
+        
+        // Every batch of requests asks for its authentication operations at the same time
+        let batchCount = 20
+        var batches = [[Operation]]()
+        let lock = NSLock()
+        DispatchQueue.concurrentPerform(iterations: batchCount) { _ in
+            let operations = self.authenticationController.authenticationOperations()
+            lock.lock()
+            batches.append(operations)
+            lock.unlock()
+        }
+        XCTAssertEqual(batches.filter({ $0.contains(where: { $0 is AccessTokenRequest }) }).count, 1)
+        XCTAssertEqual(self.authenticationController.refreshCoordinator.refreshCount, 1)
+        
+        // The requests of every batch start after the session has been refreshed
+        var validSessionCount = 0
+        let queue = OperationQueue()
+        for operations in batches {
+            let request = BlockOperation {
+                lock.lock()
+                if self.authenticationController.userSession?.isValid == true {
+                    validSessionCount += 1
+                }
+                lock.unlock()
+            }
+            request.addDependency(operations.last!)
+            queue.addOperations(operations + [request], waitUntilFinished: false)
+        }
+        queue.waitUntilAllOperationsAreFinished()
+        
+        XCTAssertEqual(TokenEndpointStub.tokenRequestCount, 1)
+        XCTAssertEqual(TokenEndpointStub.userRequestCount, 1)
+        XCTAssertEqual(validSessionCount, batchCount)
+        XCTAssertEqual(self.authenticationController.userSession?.accessToken, "refreshed-token")
+        XCTAssertEqual(self.authenticationController.userSession?.refreshToken, "stub-refresh-token")
+        
+        // With a valid session, requests don't wait for anything
+        XCTAssertTrue(self.authenticationController.authenticationOperations().isEmpty)
+    }
+    
+    func testRefreshAheadOfExpiry() {
+        let session = AuthenticationSession(userIdentifier: TestController.sharedController.userIdentifier, refreshToken: "stub-refresh-token")
+        session.expirationDate = Date(timeIntervalSinceNow: 120)
+        self.authenticationController.userSession = session
+        
+        // Requests don't wait for a refresh, the session is still valid for them
+        XCTAssertTrue(self.authenticationController.authenticationOperations().isEmpty)
+        
+        // No requests are running, so the session expiring within the refresh interval is refreshed by itself
+        let refreshInterval = self.authenticationController.refreshCoordinator.proactiveRefreshInterval
+        let refreshed = XCTNSPredicateExpectation(predicate: NSPredicate(block: { (_, _) -> Bool in
+            return self.authenticationController.userSession?.isValid(for: refreshInterval) == true
+        }), object: nil)
+        self.wait(for: [refreshed], timeout: 5)
+        XCTAssertEqual(TokenEndpointStub.tokenRequestCount, 1)
+        XCTAssertEqual(self.authenticationController.refreshCoordinator.refreshCount, 1)
+    }
+    
+}